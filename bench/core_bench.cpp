@@ -0,0 +1,377 @@
+// Microbenchmarks of the request and render hot paths: HTTP parsing and
+// response building, every page generator in both languages, translation
+// lookups, AppManager::to_json and the BeaverSystem status snapshot.
+//
+// Each case is calibrated to a batch of about 50 µs and timed batch by batch
+// until the minimum time is spent; ns/op and ops/s come from the mean, the
+// percentiles from the per-batch averages, and allocations/op from one batch
+// run with allocation accounting on.
+//
+// Usage: core_bench [--filter=TEXT] [--min-time-ms=N] [--json=PATH]
+// Run from the repository root so locales/ and config/ are found.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/alloc_stats.h"
+#include "core/app_manager.h"
+#include "core/json_writer.h"
+#include "core/system_status.h"
+#include "core/translation_catalog.h"
+#include "ui/html_renderer.h"
+#include "ui/http/http_utils.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Results are folded in here so the compiler cannot drop the measured calls.
+volatile std::size_t g_sink = 0;
+
+struct BenchCase {
+    std::string name;
+    std::function<std::size_t()> run;
+};
+
+struct BenchResult {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double ops_per_second = 0.0;
+    double p50_ns = 0.0;
+    double p90_ns = 0.0;
+    double p99_ns = 0.0;
+    double min_ns = 0.0;
+    double max_ns = 0.0;
+    double allocations_per_op = 0.0;
+    double bytes_per_op = 0.0;
+};
+
+struct Options {
+    std::string filter;
+    std::chrono::milliseconds min_time{300};
+    std::string json_path;
+};
+
+double run_batch(const BenchCase& bench, std::uint64_t batch) {
+    std::size_t sink = 0;
+    const auto start = Clock::now();
+    for (std::uint64_t i = 0; i < batch; ++i) {
+        sink += bench.run();
+    }
+    const auto end = Clock::now();
+    g_sink = g_sink + sink;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    const auto rank = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size()));
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+BenchResult measure(const BenchCase& bench, std::chrono::milliseconds min_time) {
+    constexpr double kTargetBatchNs = 50'000.0;
+    constexpr std::size_t kMaxSamples = 200'000;
+
+    // Doubling also warms caches and lazily built state (metrics, catalogs).
+    std::uint64_t batch = 1;
+    while (batch < (1u << 20) && run_batch(bench, batch) < kTargetBatchNs) {
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    double total_ns = 0.0;
+    const double min_time_ns = std::chrono::duration<double, std::nano>(min_time).count();
+    while ((total_ns < min_time_ns || samples.size() < 10) && samples.size() < kMaxSamples) {
+        const double elapsed = run_batch(bench, batch);
+        total_ns += elapsed;
+        samples.push_back(elapsed / static_cast<double>(batch));
+    }
+
+    set_allocation_accounting(true);
+    const AllocationScope allocations;
+    run_batch(bench, batch);
+    const AllocationCounts counts = allocations.elapsed();
+    set_allocation_accounting(false);
+
+    BenchResult result;
+    result.name = bench.name;
+    result.iterations = batch * samples.size();
+    result.ns_per_op = total_ns / static_cast<double>(result.iterations);
+    result.ops_per_second = result.ns_per_op > 0.0 ? 1e9 / result.ns_per_op : 0.0;
+    std::sort(samples.begin(), samples.end());
+    result.p50_ns = percentile(samples, 0.50);
+    result.p90_ns = percentile(samples, 0.90);
+    result.p99_ns = percentile(samples, 0.99);
+    result.min_ns = samples.front();
+    result.max_ns = samples.back();
+    result.allocations_per_op =
+        static_cast<double>(counts.allocations) / static_cast<double>(batch);
+    result.bytes_per_op = static_cast<double>(counts.bytes) / static_cast<double>(batch);
+    return result;
+}
+
+void print_header() {
+    std::cout << std::left << std::setw(36) << "benchmark" << std::right << std::setw(12)
+              << "ns/op" << std::setw(13) << "ops/s" << std::setw(11) << "p50" << std::setw(11)
+              << "p90" << std::setw(11) << "p99" << std::setw(11) << "allocs/op"
+              << std::setw(10) << "B/op" << std::endl;
+}
+
+void print_result(const BenchResult& result) {
+    std::cout << std::left << std::setw(36) << result.name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << result.ns_per_op
+              << std::setprecision(0) << std::setw(13) << result.ops_per_second
+              << std::setprecision(1) << std::setw(11) << result.p50_ns << std::setw(11)
+              << result.p90_ns << std::setw(11) << result.p99_ns << std::setw(11)
+              << result.allocations_per_op << std::setprecision(0) << std::setw(10)
+              << result.bytes_per_op << std::endl;
+}
+
+bool write_json(const std::string& path, const std::vector<BenchResult>& results,
+                const Options& options) {
+    std::string out;
+    JsonWriter json(out);
+    json.begin_object();
+    json.key("minTimeMs").number(static_cast<long long>(options.min_time.count()));
+    json.key("benchmarks").begin_array();
+    for (const BenchResult& result : results) {
+        json.begin_object();
+        json.key("name").string(result.name);
+        json.key("iterations").number(static_cast<unsigned long long>(result.iterations));
+        json.key("nsPerOp").number(result.ns_per_op, 2);
+        json.key("opsPerSecond").number(result.ops_per_second, 0);
+        json.key("p50Ns").number(result.p50_ns, 2);
+        json.key("p90Ns").number(result.p90_ns, 2);
+        json.key("p99Ns").number(result.p99_ns, 2);
+        json.key("minNs").number(result.min_ns, 2);
+        json.key("maxNs").number(result.max_ns, 2);
+        json.key("allocationsPerOp").number(result.allocations_per_op, 2);
+        json.key("bytesPerOp").number(result.bytes_per_op, 1);
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+    json.finish();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << out;
+    return static_cast<bool>(file);
+}
+
+SystemStatusSnapshot make_status_fixture() {
+    SystemStatusSnapshot status;
+    status.generated_at_iso = "2026-10-18 09:41:07";
+    status.wifi.available = true;
+    status.wifi.connected = true;
+    status.wifi.interface_name = "wlan0";
+    status.wifi.status_text = "Connecté à \"Beaver-Bureau\"";
+    status.websocket.listening = true;
+    status.websocket.address = "ws://127.0.0.1:5001";
+    status.websocket.last_message = "{\"type\":\"status\",\"line\":\"ringing\"}";
+    status.websocket.uptime_seconds = 86412.37;
+    status.websocket.reachable = true;
+    status.websocket.connect_ms = 0.412;
+    status.websocket.round_trip_ms = 0.233;
+    status.websocket.connect_latency = {64, 0.35, 0.61, 1.42};
+    status.websocket.round_trip_latency = {64, 0.21, 0.38, 0.97};
+    status.battery.present = true;
+    status.battery.percentage = 87;
+    status.battery.state = "Discharging";
+    status.debian.uptime_seconds = 1234567.89;
+    status.debian.uptime_human = "14d 06h 56m 07s";
+    status.debian.boot_time_iso = "2026-10-04 02:45:00";
+    status.debian.load_average[0] = 0.42;
+    status.debian.load_average[1] = 0.37;
+    status.debian.load_average[2] = 0.29;
+    for (std::uint16_t port = 5000; port < 5024; ++port) {
+        status.network.listening_ports.push_back(port);
+        ListeningSocket socket;
+        socket.port = port;
+        socket.pid = 1000 + port;
+        socket.command = port % 2 == 0 ? "beaver_kiosk" : "python3\tserver.py";
+        status.network.listening_sockets.push_back(socket);
+    }
+    for (int i = 0; i < 3; ++i) {
+        ActiveAlert alert;
+        alert.name = "load_high_" + std::to_string(i);
+        alert.metric = "load.1m";
+        alert.comparator = AlertComparator::kGreater;
+        alert.threshold = 2.0;
+        alert.value = 2.5 + i;
+        alert.since = std::chrono::system_clock::now();
+        status.alerts.push_back(alert);
+    }
+    return status;
+}
+
+const char* language_suffix(Language language) {
+    return language == Language::French ? "/fr" : "/en";
+}
+
+std::vector<BenchCase> make_cases(const AppManager& manager,
+                                  const TranslationCatalog& translations,
+                                  const SystemStatusSnapshot& status) {
+    static const std::string kGetRequest =
+        "GET /apps/beaversystem?lang=fr&mode=kiosk HTTP/1.1\r\n"
+        "Host: 127.0.0.1:5000\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/605.1.15\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Language: fr-CA,fr;q=0.9,en;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "If-None-Match: \"5f2a9c41\"\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+    static const std::string kPostRequest =
+        "POST /api/beaverphone/dial HTTP/1.1\r\n"
+        "Host: 127.0.0.1:5000\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 35\r\n"
+        "\r\n"
+        "{\"number\":\"+1 819 555 0147\",\"ext\":\"\"}";
+    static const std::string kEncoded =
+        "Caf%C3%A9+cr%C3%A8me+%26+g%C3%A2teau%3A+r%C3%A9union+%C3%A0+10h%2C+salle+B";
+    static const std::string kQuery = "lang=fr&mode=kiosk&q=caf%C3%A9+cr%C3%A8me&page=2&sort=";
+
+    std::vector<BenchCase> cases;
+    cases.push_back({"http.parse_request/get",
+                     [] { return parse_http_request(kGetRequest).headers.size(); }});
+    cases.push_back({"http.parse_request/post",
+                     [] { return parse_http_request(kPostRequest).body.size(); }});
+
+    HttpResponse response;
+    response.headers["Content-Type"] = "text/html; charset=utf-8";
+    response.headers["Cache-Control"] = "no-cache";
+    response.headers["ETag"] = "\"5f2a9c41\"";
+    response.body = manager.page_html(AppPage::kMenu, Language::French,
+                                      MenuRouteMode::kHttpServer);
+    cases.push_back(
+        {"http.build_response", [response] { return build_http_response(response).size(); }});
+    cases.push_back({"http.url_decode", [] { return url_decode(kEncoded).size(); }});
+    cases.push_back(
+        {"http.parse_query", [] { return parse_query_parameters(kQuery).size(); }});
+
+    const AppTile& tile = manager.get_available_apps().front();
+    for (const Language language : {Language::English, Language::French}) {
+        const std::string suffix = language_suffix(language);
+        cases.push_back({"render.app_tile" + suffix, [&tile, &translations, language] {
+                             return generate_app_tile_html(tile, translations, language,
+                                                           MenuRouteMode::kHttpServer, "/")
+                                 .size();
+                         }});
+        cases.push_back({"render.menu_page" + suffix, [&manager, &translations, language] {
+                             return generate_menu_page_html(manager.get_available_apps(),
+                                                            translations, language,
+                                                            MenuRouteMode::kHttpServer, "/")
+                                 .size();
+                         }});
+        cases.push_back({"render.beaverphone_dialpad" + suffix, [&translations, language] {
+                             return generate_beaverphone_dialpad_html(translations, language, "/")
+                                 .size();
+                         }});
+        cases.push_back({"render.beaveralarm_console" + suffix, [&translations, language] {
+                             return generate_beaveralarm_console_html(translations, language, "/")
+                                 .size();
+                         }});
+        cases.push_back({"render.beaversystem_dashboard" + suffix,
+                         [&translations, &status, language] {
+                             return generate_beaversystem_dashboard_html(
+                                        translations, language, "/",
+                                        BeaverSystemMenuLinkMode::kAbsoluteRoot, status)
+                                 .size();
+                         }});
+        cases.push_back({"render.beavertask_board" + suffix, [&translations, language] {
+                             return generate_beavertask_board_html(translations, language, "/")
+                                 .size();
+                         }});
+    }
+
+    static const std::string kKnownKey = "Language selection";
+    static const std::string kMissingKey = "No such label";
+    cases.push_back({"i18n.translate/hit", [&translations] {
+                         return translations.translate(kKnownKey, Language::French).size();
+                     }});
+    cases.push_back({"i18n.translate/missing", [&translations] {
+                         return translations.translate(kMissingKey, Language::French).size();
+                     }});
+
+    for (const Language language : {Language::English, Language::French}) {
+        cases.push_back({std::string("app.to_json") + language_suffix(language),
+                         [&manager, language] { return manager.to_json(language).size(); }});
+    }
+
+    cases.push_back(
+        {"status.to_json/pretty", [&status] { return system_status_to_json(status).size(); }});
+    cases.push_back({"status.to_json/compact", [&status] {
+                         return system_status_to_json(status, JsonStyle::kCompact).size();
+                     }});
+    // collect_system_status reads fixed /proc and /sys paths, so this one runs
+    // against the host; alert rules come from config/alerts.conf.
+    cases.push_back({"status.collect", [] {
+                         return collect_system_status().network.listening_sockets.size();
+                     }});
+    return cases;
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument(argv[i]);
+        if (argument.rfind("--filter=", 0) == 0) {
+            options.filter = std::string(argument.substr(std::strlen("--filter=")));
+        } else if (argument.rfind("--min-time-ms=", 0) == 0) {
+            const int value = std::atoi(argv[i] + std::strlen("--min-time-ms="));
+            options.min_time = std::chrono::milliseconds(std::max(1, value));
+        } else if (argument.rfind("--json=", 0) == 0) {
+            options.json_path = std::string(argument.substr(std::strlen("--json=")));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter=TEXT] [--min-time-ms=N] [--json=PATH]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+    if (std::getenv("BEAVER_ALERTS_FILE") == nullptr) {
+        setenv("BEAVER_ALERTS_FILE", "config/alerts.conf", 1);
+    }
+
+    const AppManager manager;
+    const TranslationCatalog translations("locales");
+    const SystemStatusSnapshot status = make_status_fixture();
+
+    std::vector<BenchResult> results;
+    print_header();
+    for (const BenchCase& bench : make_cases(manager, translations, status)) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(measure(bench, options.min_time));
+        print_result(results.back());
+    }
+
+    if (!options.json_path.empty()) {
+        if (!write_json(options.json_path, results, options)) {
+            std::cerr << "Could not write " << options.json_path << std::endl;
+            return 1;
+        }
+        std::cout << "Results written to " << options.json_path << std::endl;
+    }
+    return 0;
+}
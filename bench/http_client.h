@@ -0,0 +1,179 @@
+#pragma once
+
+// Minimal blocking HTTP/1.1 client shared by the load and replay tools: one
+// socket, one request at a time, responses framed by Content-Length.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+class HttpClientConnection {
+public:
+    explicit HttpClientConnection(const sockaddr_in& address) : address_(address) {}
+    ~HttpClientConnection() { close_socket(); }
+
+    HttpClientConnection(const HttpClientConnection&) = delete;
+    HttpClientConnection& operator=(const HttpClientConnection&) = delete;
+
+    // Sends `request` and reads one response. A reused keep-alive connection
+    // the server has already closed is reopened and the request sent again.
+    bool exchange(const std::string& request, bool keep_alive, int& status, std::size_t& bytes) {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            const bool reused = fd_ >= 0;
+            if (!reused && !open_socket()) {
+                return false;
+            }
+            bool received_any = false;
+            if (send_all(request) && read_response(status, bytes, received_any)) {
+                if (!keep_alive || server_closes_) {
+                    close_socket();
+                }
+                return true;
+            }
+            close_socket();
+            if (!reused || received_any) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Sockets opened so far, including reconnects.
+    std::uint64_t connects() const { return connects_; }
+
+private:
+    bool open_socket() {
+        fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            return false;
+        }
+        const int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        timeval timeout{5, 0};
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd_, reinterpret_cast<const sockaddr*>(&address_), sizeof(address_)) != 0) {
+            close_socket();
+            return false;
+        }
+        ++connects_;
+        return true;
+    }
+
+    void close_socket() {
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+        buffer_.clear();
+    }
+
+    bool send_all(const std::string& data) {
+        std::size_t offset = 0;
+        while (offset < data.size()) {
+            const ssize_t sent =
+                send(fd_, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            offset += static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+
+    // Appends what the socket has to buffer_; false on EOF or error.
+    bool fill() {
+        char chunk[16384];
+        for (;;) {
+            const ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                return false;
+            }
+            buffer_.append(chunk, static_cast<std::size_t>(received));
+            return true;
+        }
+    }
+
+    bool read_response(int& status, std::size_t& bytes, bool& received_any) {
+        std::size_t header_end = std::string::npos;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return false;
+            }
+            received_any = true;
+        }
+        header_end += 4;
+
+        const std::string_view head(buffer_.data(), header_end);
+        if (head.size() < 12 || head.substr(0, 5) != "HTTP/") {
+            return false;
+        }
+        status = std::atoi(buffer_.c_str() + head.find(' ') + 1);
+
+        std::size_t content_length = std::string::npos;
+        server_closes_ = false;
+        std::size_t line_start = head.find("\r\n") + 2;
+        while (line_start < header_end - 2) {
+            const std::size_t line_end = head.find("\r\n", line_start);
+            const std::string_view line = head.substr(line_start, line_end - line_start);
+            const std::size_t colon = line.find(':');
+            if (colon != std::string_view::npos) {
+                std::string name(line.substr(0, colon));
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+                    return static_cast<char>(std::tolower(c));
+                });
+                std::string_view value = line.substr(colon + 1);
+                while (!value.empty() && value.front() == ' ') {
+                    value.remove_prefix(1);
+                }
+                if (name == "content-length") {
+                    content_length = std::strtoull(std::string(value).c_str(), nullptr, 10);
+                } else if (name == "connection" && value.find("close") != std::string_view::npos) {
+                    server_closes_ = true;
+                }
+            }
+            line_start = line_end + 2;
+        }
+
+        if (content_length == std::string::npos) {
+            // No length: the body runs to the end of the connection.
+            while (fill()) {
+            }
+            server_closes_ = true;
+            bytes = buffer_.size();
+            buffer_.clear();
+            return true;
+        }
+        while (buffer_.size() < header_end + content_length) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        bytes = header_end + content_length;
+        buffer_.erase(0, bytes);
+        return true;
+    }
+
+    sockaddr_in address_;
+    int fd_ = -1;
+    std::uint64_t connects_ = 0;
+    bool server_closes_ = false;
+    std::string buffer_;
+};
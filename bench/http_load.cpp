@@ -0,0 +1,429 @@
+// Loopback load generator for HttpServerApp. Each connection runs on its own
+// thread and sends GET requests picked from a weighted route mix, either as
+// fast as the server answers (closed loop) or on a fixed schedule (open loop).
+//
+// In open-loop mode every request has an intended send time; latency is
+// measured from that time rather than from the moment the request actually
+// went out, so a server stall is charged to every request queued behind it
+// instead of silently lowering the request rate (coordinated omission). The
+// uncorrected latencies are reported next to the corrected ones.
+//
+// Usage: http_load [--host=127.0.0.1] [--port=5000] [--connections=8]
+//                  [--mode=keep-alive|close] [--rate=REQ_PER_SEC (0 = max)]
+//                  [--duration=SECONDS] [--warmup=SECONDS]
+//                  [--mix=PATH:WEIGHT,...] [--json=PATH]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/hdr_histogram.h"
+#include "core/json_writer.h"
+#include "http_client.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RouteWeight {
+    std::string path;
+    unsigned weight = 1;
+};
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 5000;
+    int connections = 8;
+    bool keep_alive = true;
+    double rate = 0.0;  // Requests per second over all connections; 0 runs closed-loop.
+    double duration_seconds = 10.0;
+    double warmup_seconds = 1.0;
+    std::vector<RouteWeight> mix;
+    std::string json_path;
+};
+
+const std::vector<RouteWeight>& default_mix() {
+    static const std::vector<RouteWeight> mix = {
+        {"/", 25},
+        {"/apps/beaverphone", 8},
+        {"/apps/beaversystem", 8},
+        {"/apps/beaveralarm", 8},
+        {"/apps/beavertask", 8},
+        {"/api/menu", 15},
+        {"/api/system/status", 15},
+        {"/css/styles.css", 8},
+        {"/icons/phone.svg", 5},
+    };
+    return mix;
+}
+
+// Latencies are recorded in microseconds, up to a minute.
+HdrHistogram make_histogram() {
+    return HdrHistogram(60'000'000, 3);
+}
+
+struct RouteStats {
+    std::uint64_t requests = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t bytes = 0;
+    HdrHistogram latency = make_histogram();
+};
+
+// What one connection thread measured; merged once every thread has finished.
+struct WorkerStats {
+    std::uint64_t requests = 0;
+    std::uint64_t io_errors = 0;
+    std::uint64_t status_2xx = 0;
+    std::uint64_t status_3xx = 0;
+    std::uint64_t status_4xx = 0;
+    std::uint64_t status_5xx = 0;
+    std::uint64_t connects = 0;
+    std::uint64_t bytes = 0;
+    HdrHistogram corrected = make_histogram();
+    HdrHistogram uncorrected = make_histogram();
+    std::vector<RouteStats> routes;
+};
+
+std::uint64_t microseconds_between(Clock::time_point from, Clock::time_point to) {
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(
+        0, std::chrono::duration_cast<std::chrono::microseconds>(to - from).count()));
+}
+
+void run_worker(int index, const Options& options, const sockaddr_in& address,
+                Clock::time_point start, Clock::time_point measure_from, Clock::time_point end,
+                WorkerStats& stats) {
+    std::vector<std::string> requests;
+    std::vector<unsigned> cumulative;
+    unsigned total_weight = 0;
+    for (const RouteWeight& route : options.mix) {
+        requests.push_back("GET " + route.path + " HTTP/1.1\r\nHost: " + options.host + ":" +
+                           std::to_string(options.port) + "\r\nUser-Agent: beaver-http-load\r\n" +
+                           "Connection: " + (options.keep_alive ? "keep-alive" : "close") +
+                           "\r\n\r\n");
+        total_weight += route.weight;
+        cumulative.push_back(total_weight);
+        stats.routes.emplace_back();
+    }
+
+    std::mt19937 random(static_cast<unsigned>(index) * 7919u + 17u);
+    std::uniform_int_distribution<unsigned> pick(0, total_weight - 1);
+
+    const bool open_loop = options.rate > 0.0;
+    const auto interval = open_loop ? std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(options.connections /
+                                                                        options.rate))
+                                    : Clock::duration::zero();
+    // Stagger the connections so their schedules interleave evenly.
+    Clock::time_point intended = start + interval * index / options.connections;
+
+    HttpClientConnection connection(address);
+    for (;;) {
+        if (open_loop) {
+            if (intended >= end) {
+                break;
+            }
+            std::this_thread::sleep_until(intended);
+        } else {
+            intended = Clock::now();
+            if (intended >= end) {
+                break;
+            }
+        }
+
+        const unsigned ticket = pick(random);
+        const std::size_t route = static_cast<std::size_t>(
+            std::upper_bound(cumulative.begin(), cumulative.end(), ticket) - cumulative.begin());
+        const auto sent_at = Clock::now();
+        int status = 0;
+        std::size_t bytes = 0;
+        const bool ok = connection.exchange(requests[route], options.keep_alive, status, bytes);
+        const auto done = Clock::now();
+
+        if (sent_at >= measure_from) {
+            RouteStats& route_stats = stats.routes[route];
+            ++stats.requests;
+            ++route_stats.requests;
+            const std::uint64_t latency = microseconds_between(intended, done);
+            stats.corrected.record(latency);
+            stats.uncorrected.record(microseconds_between(sent_at, done));
+            route_stats.latency.record(latency);
+            if (!ok) {
+                ++stats.io_errors;
+                ++route_stats.errors;
+            } else {
+                stats.bytes += bytes;
+                route_stats.bytes += bytes;
+                if (status >= 500) {
+                    ++stats.status_5xx;
+                } else if (status >= 400) {
+                    ++stats.status_4xx;
+                } else if (status >= 300) {
+                    ++stats.status_3xx;
+                } else {
+                    ++stats.status_2xx;
+                }
+                if (status >= 400) {
+                    ++route_stats.errors;
+                }
+            }
+        }
+        if (!ok) {
+            // Do not spin on a refused port.
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        intended += interval;
+    }
+    stats.connects = connection.connects();
+}
+
+bool parse_mix(std::string_view text, std::vector<RouteWeight>& mix) {
+    mix.clear();
+    while (!text.empty()) {
+        const std::size_t comma = text.find(',');
+        const std::string_view entry = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+        const std::size_t colon = entry.rfind(':');
+        RouteWeight route;
+        route.path = std::string(entry.substr(0, colon));
+        if (colon != std::string_view::npos) {
+            route.weight =
+                static_cast<unsigned>(std::atoi(std::string(entry.substr(colon + 1)).c_str()));
+        }
+        if (route.path.empty() || route.path.front() != '/' || route.weight == 0) {
+            return false;
+        }
+        mix.push_back(std::move(route));
+    }
+    return !mix.empty();
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--host=ADDR] [--port=N] [--connections=N] [--mode=keep-alive|close]"
+                 " [--rate=REQ_PER_SEC] [--duration=S] [--warmup=S]"
+                 " [--mix=PATH:WEIGHT,...] [--json=PATH]"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    options.mix = default_mix();
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument(argv[i]);
+        const std::size_t equals = argument.find('=');
+        const std::string_view name = argument.substr(0, equals);
+        const std::string value =
+            equals == std::string_view::npos ? "" : std::string(argument.substr(equals + 1));
+        if (name == "--host") {
+            options.host = value;
+        } else if (name == "--port") {
+            options.port = std::atoi(value.c_str());
+        } else if (name == "--connections") {
+            options.connections = std::max(1, std::atoi(value.c_str()));
+        } else if (name == "--mode" && (value == "keep-alive" || value == "close")) {
+            options.keep_alive = value == "keep-alive";
+        } else if (name == "--rate") {
+            options.rate = std::max(0.0, std::atof(value.c_str()));
+        } else if (name == "--duration") {
+            options.duration_seconds = std::max(0.1, std::atof(value.c_str()));
+        } else if (name == "--warmup") {
+            options.warmup_seconds = std::max(0.0, std::atof(value.c_str()));
+        } else if (name == "--mix") {
+            if (!parse_mix(value, options.mix)) {
+                print_usage(argv[0]);
+                return false;
+            }
+        } else if (name == "--json" && !value.empty()) {
+            options.json_path = value;
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    return options.port > 0 && options.port <= 65535;
+}
+
+constexpr double kReportedPercentiles[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+
+void print_latency(const char* label, const HdrHistogram& histogram) {
+    std::cout << std::left << std::setw(14) << label << std::right;
+    for (double percentile : kReportedPercentiles) {
+        std::cout << std::setw(10) << histogram.value_at_percentile(percentile);
+    }
+    std::cout << std::setw(10) << histogram.max() << std::endl;
+}
+
+void write_latency_json(JsonWriter& json, const HdrHistogram& histogram) {
+    json.begin_object();
+    json.key("count").number(static_cast<unsigned long long>(histogram.count()));
+    json.key("meanUs").number(histogram.mean(), 1);
+    json.key("minUs").number(static_cast<unsigned long long>(histogram.min()));
+    json.key("p50Us").number(static_cast<unsigned long long>(histogram.value_at_percentile(50)));
+    json.key("p90Us").number(static_cast<unsigned long long>(histogram.value_at_percentile(90)));
+    json.key("p99Us").number(static_cast<unsigned long long>(histogram.value_at_percentile(99)));
+    json.key("p999Us")
+        .number(static_cast<unsigned long long>(histogram.value_at_percentile(99.9)));
+    json.key("p9999Us")
+        .number(static_cast<unsigned long long>(histogram.value_at_percentile(99.99)));
+    json.key("maxUs").number(static_cast<unsigned long long>(histogram.max()));
+    json.end_object();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Not an IPv4 address: " << options.host << std::endl;
+        return 2;
+    }
+
+    std::cout << "Target " << options.host << ':' << options.port << ", "
+              << options.connections << (options.keep_alive ? " keep-alive" : " close-per-request")
+              << " connections, ";
+    if (options.rate > 0.0) {
+        std::cout << options.rate << " req/s (open loop)";
+    } else {
+        std::cout << "max rate (closed loop)";
+    }
+    std::cout << ", " << options.duration_seconds << " s after " << options.warmup_seconds
+              << " s warm-up" << std::endl;
+
+    const auto start = Clock::now();
+    const auto measure_from = start + std::chrono::duration_cast<Clock::duration>(
+                                          std::chrono::duration<double>(options.warmup_seconds));
+    const auto end = measure_from + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(options.duration_seconds));
+
+    std::vector<WorkerStats> workers(static_cast<std::size_t>(options.connections));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back(run_worker, i, std::cref(options), std::cref(address), start,
+                             measure_from, end, std::ref(workers[static_cast<std::size_t>(i)]));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double elapsed =
+        std::chrono::duration<double>(std::max(Clock::now(), end) - measure_from).count();
+
+    WorkerStats total;
+    total.routes.resize(options.mix.size());
+    for (const WorkerStats& worker : workers) {
+        total.requests += worker.requests;
+        total.io_errors += worker.io_errors;
+        total.status_2xx += worker.status_2xx;
+        total.status_3xx += worker.status_3xx;
+        total.status_4xx += worker.status_4xx;
+        total.status_5xx += worker.status_5xx;
+        total.connects += worker.connects;
+        total.bytes += worker.bytes;
+        total.corrected.merge(worker.corrected);
+        total.uncorrected.merge(worker.uncorrected);
+        for (std::size_t i = 0; i < worker.routes.size(); ++i) {
+            total.routes[i].requests += worker.routes[i].requests;
+            total.routes[i].errors += worker.routes[i].errors;
+            total.routes[i].bytes += worker.routes[i].bytes;
+            total.routes[i].latency.merge(worker.routes[i].latency);
+        }
+    }
+
+    const std::uint64_t errors = total.io_errors + total.status_4xx + total.status_5xx;
+    const double error_rate =
+        total.requests == 0 ? 0.0 : 100.0 * static_cast<double>(errors) / total.requests;
+    std::cout << std::fixed << std::setprecision(1) << "requests " << total.requests << ", "
+              << total.requests / elapsed << " req/s, "
+              << total.bytes / elapsed / (1024.0 * 1024.0) << " MiB/s, connections opened "
+              << total.connects << std::endl;
+    std::cout << std::setprecision(2) << "errors " << errors << " (" << error_rate
+              << "%): io " << total.io_errors << ", 4xx " << total.status_4xx << ", 5xx "
+              << total.status_5xx << "; 2xx " << total.status_2xx << ", 3xx "
+              << total.status_3xx << std::endl;
+
+    std::cout << std::endl << std::left << std::setw(14) << "latency (us)" << std::right;
+    for (const char* label : {"p50", "p90", "p99", "p99.9", "p99.99", "max"}) {
+        std::cout << std::setw(10) << label;
+    }
+    std::cout << std::endl;
+    if (options.rate > 0.0) {
+        print_latency("corrected", total.corrected);
+    }
+    print_latency(options.rate > 0.0 ? "uncorrected" : "all", total.uncorrected);
+
+    std::cout << std::endl
+              << std::left << std::setw(24) << "route" << std::right << std::setw(10) << "req/s"
+              << std::setw(9) << "errors" << std::setw(10) << "p50 us" << std::setw(10)
+              << "p99 us" << std::endl;
+    for (std::size_t i = 0; i < options.mix.size(); ++i) {
+        const RouteStats& route = total.routes[i];
+        std::cout << std::left << std::setw(24) << options.mix[i].path << std::right
+                  << std::setprecision(1) << std::setw(10) << route.requests / elapsed
+                  << std::setw(9) << route.errors << std::setw(10)
+                  << route.latency.value_at_percentile(50) << std::setw(10)
+                  << route.latency.value_at_percentile(99) << std::endl;
+    }
+
+    if (!options.json_path.empty()) {
+        std::string out;
+        JsonWriter json(out);
+        json.begin_object();
+        json.key("target").string(options.host + ":" + std::to_string(options.port));
+        json.key("connections").number(options.connections);
+        json.key("keepAlive").boolean(options.keep_alive);
+        json.key("rate").number(options.rate, 1);
+        json.key("durationSeconds").number(elapsed, 3);
+        json.key("requests").number(static_cast<unsigned long long>(total.requests));
+        json.key("requestsPerSecond").number(total.requests / elapsed, 1);
+        json.key("errors").number(static_cast<unsigned long long>(errors));
+        json.key("ioErrors").number(static_cast<unsigned long long>(total.io_errors));
+        json.key("status4xx").number(static_cast<unsigned long long>(total.status_4xx));
+        json.key("status5xx").number(static_cast<unsigned long long>(total.status_5xx));
+        json.key("connectionsOpened").number(static_cast<unsigned long long>(total.connects));
+        json.key("latency");
+        write_latency_json(json, options.rate > 0.0 ? total.corrected : total.uncorrected);
+        json.key("uncorrectedLatency");
+        write_latency_json(json, total.uncorrected);
+        json.key("routes").begin_array();
+        for (std::size_t i = 0; i < options.mix.size(); ++i) {
+            const RouteStats& route = total.routes[i];
+            json.begin_object();
+            json.key("path").string(options.mix[i].path);
+            json.key("weight").number(options.mix[i].weight);
+            json.key("requests").number(static_cast<unsigned long long>(route.requests));
+            json.key("errors").number(static_cast<unsigned long long>(route.errors));
+            json.key("bytes").number(static_cast<unsigned long long>(route.bytes));
+            json.key("latency");
+            write_latency_json(json, route.latency);
+            json.end_object();
+        }
+        json.end_array();
+        json.end_object();
+        json.finish();
+        std::ofstream file(options.json_path, std::ios::binary | std::ios::trunc);
+        file << out;
+        if (!file) {
+            std::cerr << "Could not write " << options.json_path << std::endl;
+            return 1;
+        }
+        std::cout << std::endl << "Results written to " << options.json_path << std::endl;
+    }
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+// Replays a BEAVER_CAPTURE traffic capture against a running server and
+// compares each response with the one recorded in production: status codes
+// must match, and latencies are reported side by side.
+//
+// Requests keep their recorded spacing, divided by --speed (2 replays twice
+// as fast; 0 sends them back to back). They are dealt round-robin to the
+// connections. Replay latency is measured from each request's scheduled
+// time, so a stalled server is not hidden by the replay falling behind.
+// Recorded latencies were measured inside the server (request read to
+// response sent); replayed ones also include connection setup.
+//
+// Usage: http_replay CAPTURE [--host=127.0.0.1] [--port=5000] [--speed=1]
+//                    [--connections=8] [--json=PATH]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/hdr_histogram.h"
+#include "core/json_writer.h"
+#include "http_client.h"
+#include "ui/http/traffic_capture.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string capture_path;
+    std::string host = "127.0.0.1";
+    int port = 5000;
+    double speed = 1.0;
+    int connections = 8;
+    std::string json_path;
+};
+
+struct ReplayResult {
+    bool ok = false;
+    int status = 0;
+    std::uint64_t latency_us = 0;
+};
+
+// "GET /apps/beaverphone?lang=en" from the request line, for reports.
+std::string request_target(const std::string& raw_request) {
+    const std::string_view line(raw_request.data(),
+                                std::min(raw_request.find("\r\n"), raw_request.size()));
+    const std::size_t version = line.rfind(" HTTP/");
+    return std::string(line.substr(0, version));
+}
+
+std::uint64_t microseconds_between(Clock::time_point from, Clock::time_point to) {
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(
+        0, std::chrono::duration_cast<std::chrono::microseconds>(to - from).count()));
+}
+
+void replay_worker(std::size_t index, const Options& options, const sockaddr_in& address,
+                   const std::vector<CapturedRequest>& requests, Clock::time_point start,
+                   std::vector<ReplayResult>& results) {
+    HttpClientConnection connection(address);
+    const auto connections = static_cast<std::size_t>(options.connections);
+    for (std::size_t i = index; i < requests.size(); i += connections) {
+        Clock::time_point scheduled = Clock::now();
+        if (options.speed > 0.0) {
+            scheduled = start + std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double, std::micro>(
+                                        static_cast<double>(requests[i].offset_us) /
+                                        options.speed));
+            std::this_thread::sleep_until(scheduled);
+        }
+        ReplayResult& result = results[i];
+        std::size_t bytes = 0;
+        result.ok = connection.exchange(requests[i].request, false, result.status, bytes);
+        result.latency_us = microseconds_between(scheduled, Clock::now());
+    }
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " CAPTURE [--host=ADDR] [--port=N] [--speed=N] [--connections=N]"
+                 " [--json=PATH]"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument(argv[i]);
+        const std::size_t equals = argument.find('=');
+        const std::string_view name = argument.substr(0, equals);
+        const std::string value =
+            equals == std::string_view::npos ? "" : std::string(argument.substr(equals + 1));
+        if (name.rfind("--", 0) != 0 && options.capture_path.empty()) {
+            options.capture_path = std::string(argument);
+        } else if (name == "--host") {
+            options.host = value;
+        } else if (name == "--port") {
+            options.port = std::atoi(value.c_str());
+        } else if (name == "--speed") {
+            options.speed = std::max(0.0, std::atof(value.c_str()));
+        } else if (name == "--connections") {
+            options.connections = std::max(1, std::atoi(value.c_str()));
+        } else if (name == "--json" && !value.empty()) {
+            options.json_path = value;
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    if (options.capture_path.empty() || options.port <= 0 || options.port > 65535) {
+        print_usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+void print_latency(const char* label, const HdrHistogram& histogram) {
+    std::cout << std::left << std::setw(12) << label << std::right;
+    for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+        std::cout << std::setw(10) << histogram.value_at_percentile(percentile);
+    }
+    std::cout << std::setw(10) << histogram.max() << std::endl;
+}
+
+void write_latency_json(JsonWriter& json, const HdrHistogram& histogram) {
+    json.begin_object();
+    json.key("p50Us").number(static_cast<unsigned long long>(histogram.value_at_percentile(50)));
+    json.key("p90Us").number(static_cast<unsigned long long>(histogram.value_at_percentile(90)));
+    json.key("p99Us").number(static_cast<unsigned long long>(histogram.value_at_percentile(99)));
+    json.key("maxUs").number(static_cast<unsigned long long>(histogram.max()));
+    json.end_object();
+}
+
+struct TargetSummary {
+    std::uint64_t requests = 0;
+    std::uint64_t mismatches = 0;
+    HdrHistogram recorded{60'000'000, 3};
+    HdrHistogram replayed{60'000'000, 3};
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+
+    CaptureReader reader;
+    if (!reader.open(options.capture_path)) {
+        std::cerr << "Not a capture file: " << options.capture_path << std::endl;
+        return 2;
+    }
+    std::vector<CapturedRequest> requests;
+    CapturedRequest request;
+    while (reader.next(request)) {
+        requests.push_back(std::move(request));
+    }
+    if (requests.empty()) {
+        std::cerr << "No requests in " << options.capture_path << std::endl;
+        return 2;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Not an IPv4 address: " << options.host << std::endl;
+        return 2;
+    }
+
+    const double captured_seconds = static_cast<double>(requests.back().offset_us) / 1e6;
+    std::cout << "Replaying " << requests.size() << " requests captured over " << std::fixed
+              << std::setprecision(1) << captured_seconds << " s against " << options.host << ':'
+              << options.port << ", ";
+    if (options.speed > 0.0) {
+        std::cout << options.speed << "x speed";
+    } else {
+        std::cout << "back to back";
+    }
+    std::cout << ", " << options.connections << " connections" << std::endl;
+
+    std::vector<ReplayResult> results(requests.size());
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back(replay_worker, static_cast<std::size_t>(i), std::cref(options),
+                             std::cref(address), std::cref(requests), start, std::ref(results));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    HdrHistogram recorded(60'000'000, 3);
+    HdrHistogram replayed(60'000'000, 3);
+    std::uint64_t io_errors = 0;
+    std::uint64_t mismatches = 0;
+    std::map<std::string, TargetSummary> targets;
+    std::vector<std::size_t> first_mismatches;
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        const ReplayResult& result = results[i];
+        TargetSummary& target = targets[request_target(requests[i].request)];
+        ++target.requests;
+        recorded.record(requests[i].latency_us);
+        target.recorded.record(requests[i].latency_us);
+        if (!result.ok) {
+            ++io_errors;
+            ++target.mismatches;
+            continue;
+        }
+        replayed.record(result.latency_us);
+        target.replayed.record(result.latency_us);
+        if (result.status != requests[i].status) {
+            ++mismatches;
+            ++target.mismatches;
+            if (first_mismatches.size() < 10) {
+                first_mismatches.push_back(i);
+            }
+        }
+    }
+
+    std::cout << "replayed in " << std::setprecision(1) << elapsed << " s ("
+              << static_cast<double>(requests.size()) / elapsed << " req/s); status mismatches "
+              << mismatches << ", io errors " << io_errors << std::endl;
+    for (std::size_t i : first_mismatches) {
+        std::cout << "  " << request_target(requests[i].request) << ": recorded "
+                  << requests[i].status << ", replayed " << results[i].status << std::endl;
+    }
+
+    std::cout << std::endl << std::left << std::setw(12) << "latency (us)" << std::right;
+    for (const char* label : {"p50", "p90", "p99", "p99.9", "max"}) {
+        std::cout << std::setw(10) << label;
+    }
+    std::cout << std::endl;
+    print_latency("recorded", recorded);
+    print_latency("replayed", replayed);
+
+    std::cout << std::endl
+              << std::left << std::setw(40) << "request" << std::right << std::setw(9) << "count"
+              << std::setw(12) << "mismatches" << std::setw(14) << "rec p50 us" << std::setw(14)
+              << "rep p50 us" << std::endl;
+    for (const auto& [target, summary] : targets) {
+        std::cout << std::left << std::setw(40) << target.substr(0, 39) << std::right
+                  << std::setw(9) << summary.requests << std::setw(12) << summary.mismatches
+                  << std::setw(14) << summary.recorded.value_at_percentile(50) << std::setw(14)
+                  << summary.replayed.value_at_percentile(50) << std::endl;
+    }
+
+    if (!options.json_path.empty()) {
+        std::string out;
+        JsonWriter json(out);
+        json.begin_object();
+        json.key("capture").string(options.capture_path);
+        json.key("speed").number(options.speed, 2);
+        json.key("requests").number(static_cast<unsigned long long>(requests.size()));
+        json.key("durationSeconds").number(elapsed, 3);
+        json.key("statusMismatches").number(static_cast<unsigned long long>(mismatches));
+        json.key("ioErrors").number(static_cast<unsigned long long>(io_errors));
+        json.key("recordedLatency");
+        write_latency_json(json, recorded);
+        json.key("replayedLatency");
+        write_latency_json(json, replayed);
+        json.key("targets").begin_array();
+        for (const auto& [target, summary] : targets) {
+            json.begin_object();
+            json.key("request").string(target);
+            json.key("count").number(static_cast<unsigned long long>(summary.requests));
+            json.key("mismatches").number(static_cast<unsigned long long>(summary.mismatches));
+            json.key("recordedLatency");
+            write_latency_json(json, summary.recorded);
+            json.key("replayedLatency");
+            write_latency_json(json, summary.replayed);
+            json.end_object();
+        }
+        json.end_array();
+        json.end_object();
+        json.finish();
+        std::ofstream file(options.json_path, std::ios::binary | std::ios::trunc);
+        file << out;
+        if (!file) {
+            std::cerr << "Could not write " << options.json_path << std::endl;
+            return 1;
+        }
+        std::cout << std::endl << "Results written to " << options.json_path << std::endl;
+    }
+    return mismatches == 0 && io_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+// Measures the cost of serializing one BeaverSystem status snapshot (and one
+// process table) with JsonWriter, next to the ostringstream-based serializer it
+// replaced.
+//
+// Usage: json_writer_bench [ITERATIONS]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/alloc_stats.h"
+#include "core/json_writer.h"
+#include "core/process_scanner.h"
+#include "core/system_status.h"
+
+namespace {
+
+SystemStatusSnapshot make_fixture() {
+    SystemStatusSnapshot status;
+    status.generated_at_iso = "2026-10-18 09:41:07";
+    status.wifi.available = true;
+    status.wifi.connected = true;
+    status.wifi.interface_name = "wlan0";
+    status.wifi.status_text = "Connecté à \"Beaver-Bureau\"";
+    status.websocket.listening = true;
+    status.websocket.address = "ws://127.0.0.1:5001";
+    status.websocket.last_message = "{\"type\":\"status\",\"line\":\"ringing\"}";
+    status.websocket.uptime_seconds = 86412.37;
+    status.websocket.reachable = true;
+    status.websocket.connect_ms = 0.412;
+    status.websocket.round_trip_ms = 0.233;
+    status.websocket.connect_latency = {64, 0.35, 0.61, 1.42};
+    status.websocket.round_trip_latency = {64, 0.21, 0.38, 0.97};
+    status.websocket.probes = 43210;
+    status.websocket.probe_failures = 12;
+    status.battery.present = true;
+    status.battery.percentage = 87;
+    status.battery.state = "Discharging";
+    status.debian.uptime_seconds = 1234567.89;
+    status.debian.uptime_human = "14d 06h 56m 07s";
+    status.debian.boot_time_iso = "2026-10-04 02:45:00";
+    status.debian.load_average[0] = 0.42;
+    status.debian.load_average[1] = 0.37;
+    status.debian.load_average[2] = 0.29;
+    for (std::uint16_t port = 5000; port < 5024; ++port) {
+        status.network.listening_ports.push_back(port);
+        ListeningSocket socket;
+        socket.port = port;
+        socket.pid = 1000 + port;
+        socket.command = port % 2 == 0 ? "beaver_kiosk" : "python3\tserver.py";
+        status.network.listening_sockets.push_back(socket);
+    }
+    for (int i = 0; i < 3; ++i) {
+        ActiveAlert alert;
+        alert.name = "load_high_" + std::to_string(i);
+        alert.metric = "load.1m";
+        alert.comparator = AlertComparator::kGreater;
+        alert.threshold = 2.0;
+        alert.value = 2.5 + i;
+        alert.since = std::chrono::system_clock::now();
+        status.alerts.push_back(alert);
+    }
+    return status;
+}
+
+ProcessTable make_process_fixture() {
+    ProcessTable table;
+    table.total_processes = 312;
+    table.interval_seconds = 2.0;
+    for (int i = 0; i < 10; ++i) {
+        ProcessSample sample;
+        sample.pid = 4000 + i;
+        sample.command = "worker-" + std::to_string(i);
+        sample.state = i % 3 == 0 ? 'R' : 'S';
+        sample.cpu_percent = 12.5 / (i + 1);
+        sample.rss_bytes = 1024ull * 1024 * (200 - i);
+        table.top_cpu.push_back(sample);
+        table.top_memory.push_back(sample);
+    }
+    return table;
+}
+
+// The pre-JsonWriter serializer, kept here as the baseline.
+std::string legacy_escape(const std::string& input) {
+    std::string escaped;
+    escaped.reserve(input.size() + 16);
+    for (char ch : input) {
+        switch (ch) {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\"':
+                escaped += "\\\"";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    std::ostringstream oss;
+                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                        << static_cast<int>(static_cast<unsigned char>(ch));
+                    escaped += oss.str();
+                } else {
+                    escaped += ch;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string legacy_double(double value, int precision) {
+    if (!std::isfinite(value) || value < 0.0) {
+        return "null";
+    }
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(precision) << value;
+    return stream.str();
+}
+
+std::string legacy_timestamp(std::chrono::system_clock::time_point time_point) {
+    const std::time_t time = std::chrono::system_clock::to_time_t(time_point);
+    std::tm tm{};
+    localtime_r(&time, &tm);
+    std::ostringstream formatted;
+    formatted << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+    return formatted.str();
+}
+
+std::string legacy_status_to_json(const SystemStatusSnapshot& status) {
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"generatedAt\": \"" << legacy_escape(status.generated_at_iso) << "\",\n";
+    json << "  \"wifi\": {\n";
+    json << "    \"available\": " << (status.wifi.available ? "true" : "false") << ",\n";
+    json << "    \"connected\": " << (status.wifi.connected ? "true" : "false") << ",\n";
+    json << "    \"interface\": \"" << legacy_escape(status.wifi.interface_name) << "\",\n";
+    json << "    \"status\": \"" << legacy_escape(status.wifi.status_text) << "\"\n";
+    json << "  },\n";
+    json << "  \"websocket\": {\n";
+    json << "    \"listening\": " << (status.websocket.listening ? "true" : "false") << ",\n";
+    json << "    \"address\": \"" << legacy_escape(status.websocket.address) << "\",\n";
+    json << "    \"lastMessage\": \"" << legacy_escape(status.websocket.last_message) << "\",\n";
+    json << "    \"uptimeSeconds\": " << legacy_double(status.websocket.uptime_seconds, 2)
+         << ",\n";
+    json << "    \"reachable\": " << (status.websocket.reachable ? "true" : "false") << ",\n";
+    json << "    \"probeError\": \"" << legacy_escape(status.websocket.probe_error) << "\",\n";
+    json << "    \"connectMs\": " << legacy_double(status.websocket.connect_ms, 3) << ",\n";
+    json << "    \"roundTripMs\": " << legacy_double(status.websocket.round_trip_ms, 3)
+         << ",\n";
+    const auto append_latency = [&json](const char* name, const LatencySummary& summary) {
+        json << "    \"" << name << "\": {\"samples\": " << summary.samples
+             << ", \"p50Ms\": " << legacy_double(summary.p50_ms, 3)
+             << ", \"p90Ms\": " << legacy_double(summary.p90_ms, 3)
+             << ", \"p99Ms\": " << legacy_double(summary.p99_ms, 3) << "},\n";
+    };
+    append_latency("connectLatency", status.websocket.connect_latency);
+    append_latency("roundTripLatency", status.websocket.round_trip_latency);
+    json << "    \"probes\": " << status.websocket.probes << ",\n";
+    json << "    \"probeFailures\": " << status.websocket.probe_failures << "\n";
+    json << "  },\n";
+    json << "  \"battery\": {\n";
+    json << "    \"present\": " << (status.battery.present ? "true" : "false") << ",\n";
+    json << "    \"percentage\": " << status.battery.percentage << ",\n";
+    json << "    \"state\": \"" << legacy_escape(status.battery.state) << "\"\n";
+    json << "  },\n";
+    json << "  \"debian\": {\n";
+    json << "    \"uptimeSeconds\": " << legacy_double(status.debian.uptime_seconds, 2) << ",\n";
+    json << "    \"uptimeHuman\": \"" << legacy_escape(status.debian.uptime_human) << "\",\n";
+    json << "    \"bootTime\": \"" << legacy_escape(status.debian.boot_time_iso) << "\",\n";
+    json << "    \"loadAverage\": [" << legacy_double(status.debian.load_average[0], 2) << ", "
+         << legacy_double(status.debian.load_average[1], 2) << ", "
+         << legacy_double(status.debian.load_average[2], 2) << "]\n";
+    json << "  },\n";
+    json << "  \"network\": {\n";
+    json << "    \"listeningPorts\": [";
+    for (std::size_t i = 0; i < status.network.listening_ports.size(); ++i) {
+        json << (i > 0 ? ", " : "") << status.network.listening_ports[i];
+    }
+    json << "],\n";
+    json << "    \"listeningSockets\": [";
+    for (std::size_t i = 0; i < status.network.listening_sockets.size(); ++i) {
+        const auto& socket = status.network.listening_sockets[i];
+        json << (i == 0 ? "\n" : ",\n");
+        json << "      {\"port\": " << socket.port << ", \"pid\": " << socket.pid
+             << ", \"command\": \"" << legacy_escape(socket.command) << "\"}";
+    }
+    json << "\n    ]\n";
+    json << "  },\n";
+    json << "  \"alerts\": [";
+    for (std::size_t i = 0; i < status.alerts.size(); ++i) {
+        const auto& alert = status.alerts[i];
+        json << (i == 0 ? "\n    " : ",\n    ");
+        json << "{\"name\": \"" << legacy_escape(alert.name) << "\", \"metric\": \""
+             << legacy_escape(alert.metric) << "\", \"comparator\": \""
+             << alert_comparator_symbol(alert.comparator)
+             << "\", \"threshold\": " << legacy_double(alert.threshold, 2)
+             << ", \"value\": " << legacy_double(alert.value, 2) << ", \"since\": \""
+             << legacy_timestamp(alert.since) << "\"}";
+    }
+    json << "\n  ]\n";
+    json << "}\n";
+    return json.str();
+}
+
+template <typename Function>
+void run(const char* label, int iterations, Function&& function) {
+    std::size_t bytes = 0;
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        bytes = function();
+    }
+    std::vector<double> rounds;
+    constexpr int kRounds = 10;
+    const int per_round = std::max(1, iterations / kRounds);
+    for (int round = 0; round < kRounds; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < per_round; ++i) {
+            bytes = function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        rounds.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                         per_round);
+    }
+    std::sort(rounds.begin(), rounds.end());
+    const AllocationScope allocations;
+    bytes = function();
+    const AllocationCounts per_op = allocations.elapsed();
+    std::cout << std::left << std::setw(36) << label << std::right << std::fixed
+              << std::setprecision(0) << "p50 " << std::setw(8) << rounds[kRounds / 2]
+              << " ns/op  min " << std::setw(8) << rounds.front() << " ns/op  " << std::setw(6)
+              << bytes << " bytes  " << std::setw(4) << per_op.allocations << " allocs/op "
+              << std::setw(6) << per_op.bytes << " B/op" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::max(10, std::atoi(argv[1])) : 200000;
+    set_allocation_accounting(true);
+    const SystemStatusSnapshot status = make_fixture();
+    const ProcessTable table = make_process_fixture();
+
+    std::cout << "Status snapshot: " << status.network.listening_sockets.size() << " sockets, "
+              << status.alerts.size() << " alerts; " << iterations << " iterations"
+              << std::endl;
+
+    run("status, ostringstream (legacy)", iterations,
+        [&] { return legacy_status_to_json(status).size(); });
+    run("status, JsonWriter pretty", iterations,
+        [&] { return system_status_to_json(status).size(); });
+    run("status, JsonWriter compact", iterations,
+        [&] { return system_status_to_json(status, JsonStyle::kCompact).size(); });
+    std::string buffer;
+    run("status, JsonWriter compact, reused", iterations, [&] {
+        buffer.clear();
+        append_system_status_json(buffer, status, JsonStyle::kCompact);
+        return buffer.size();
+    });
+    run("process table, JsonWriter pretty", iterations,
+        [&] { return process_table_to_json(table).size(); });
+    return 0;
+}
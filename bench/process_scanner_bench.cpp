@@ -0,0 +1,124 @@
+// Benchmarks ProcessScanner against a synthetic /proc tree.
+//
+// Usage: process_scanner_bench [PROCESS_COUNT] [SCAN_COUNT]
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/alloc_stats.h"
+#include "core/process_scanner.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void write_process(const fs::path& root, int pid, unsigned long long ticks) {
+    const fs::path dir = root / std::to_string(pid);
+    fs::create_directories(dir);
+    std::ofstream stat(dir / "stat");
+    stat << pid << " (worker " << pid << ") S 1 " << pid << ' ' << pid
+         << " 0 -1 4194560 120 0 0 0 " << ticks << ' ' << ticks / 2
+         << " 0 0 20 0 1 0 " << 1000 + pid << " 12345678 " << (pid % 4096) + 64
+         << " 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0\n";
+    std::ofstream statm(dir / "statm");
+    statm << 3000 << ' ' << (pid % 4096) + 64 << " 200 10 0 400 0\n";
+}
+
+struct Timing {
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+Timing summarize(std::vector<double> samples) {
+    Timing timing;
+    if (samples.empty()) {
+        return timing;
+    }
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    timing.mean_ms = total / static_cast<double>(samples.size());
+    timing.p50_ms = samples[samples.size() / 2];
+    timing.max_ms = samples.back();
+    return timing;
+}
+
+void print_timing(const char* label, const Timing& timing) {
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed
+              << std::setprecision(3) << "mean " << std::setw(9) << timing.mean_ms << " ms  p50 "
+              << std::setw(9) << timing.p50_ms << " ms  max " << std::setw(9) << timing.max_ms
+              << " ms" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    set_allocation_accounting(true);
+    const int process_count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5000;
+    const int scan_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 50;
+
+    // Let the scanner keep a descriptor pair open for every synthetic process.
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    const fs::path root = fs::temp_directory_path() /
+                          ("beaver-proc-bench-" + std::to_string(static_cast<long>(getpid())));
+    fs::remove_all(root);
+    for (int pid = 1; pid <= process_count; ++pid) {
+        write_process(root, pid, static_cast<unsigned long long>(pid) * 7);
+    }
+
+    std::cout << "Synthetic proc root: " << root << " (" << process_count << " processes, "
+              << scan_count << " scans)" << std::endl;
+
+    std::vector<double> cold;
+    std::vector<double> warm;
+    std::size_t reported = 0;
+    AllocationCounts warm_allocations;
+    {
+        ProcessScanner scanner(root.string());
+        scanner.scan(10);
+        const AllocationScope allocations;
+        for (int i = 0; i < scan_count; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            const ProcessTable table = scanner.scan(10);
+            const auto end = std::chrono::steady_clock::now();
+            warm.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            reported = table.total_processes;
+        }
+        warm_allocations = allocations.elapsed();
+    }
+    for (int i = 0; i < scan_count; ++i) {
+        ProcessScanner scanner(root.string());
+        const auto start = std::chrono::steady_clock::now();
+        scanner.scan(10);
+        const auto end = std::chrono::steady_clock::now();
+        cold.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    print_timing("cold scan (open + read)", summarize(cold));
+    print_timing("warm scan (cached fds)", summarize(warm));
+    std::cout << "warm scan allocations: " << warm_allocations.allocations / scan_count
+              << " allocs/op, " << warm_allocations.bytes / scan_count << " bytes/op"
+              << std::endl;
+    std::cout << "processes reported per scan: " << reported << std::endl;
+
+    fs::remove_all(root);
+    return reported == static_cast<std::size_t>(process_count) ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+// Measures how long each server binary takes from exec to its first 200 on
+// "/", and its resident memory (VmRSS) then and once it has settled.
+//
+// Usage: startup_bench [--runs=N] [--port=N] [--settle-ms=N] BINARY...
+//
+// Each run spawns `BINARY --http --port=P` (P increases per run), polls
+// 127.0.0.1:P until a GET / answers 200, reads /proc/<pid>/status, and stops
+// the server with SIGTERM. Binaries that do not exist are reported and skipped.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::seconds kStartupTimeout{10};
+
+struct Options {
+    int runs = 10;
+    int port = 5400;
+    int settle_ms = 1000;
+    std::vector<std::string> binaries;
+};
+
+struct RunResult {
+    double first_200_ms = 0.0;
+    long rss_at_200_kb = 0;
+    long rss_settled_kb = 0;
+};
+
+void print_usage(const char* executable_name) {
+    std::cerr << "Usage: " << executable_name
+              << " [--runs=N] [--port=N] [--settle-ms=N] BINARY..." << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument(argv[i]);
+        if (argument.rfind("--", 0) != 0) {
+            options.binaries.emplace_back(argument);
+            continue;
+        }
+        const std::size_t equals = argument.find('=');
+        const std::string_view name = argument.substr(0, equals);
+        const int value =
+            equals == std::string_view::npos ? 0 : std::atoi(argv[i] + equals + 1);
+        if (name == "--runs" && value > 0) {
+            options.runs = value;
+        } else if (name == "--port" && value > 0 && value < 65000) {
+            options.port = value;
+        } else if (name == "--settle-ms" && value >= 0) {
+            options.settle_ms = value;
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    if (options.binaries.empty()) {
+        print_usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+// "VmRSS:     5120 kB" -> 5120.
+long read_rss_kb(pid_t pid) {
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+// One GET / on a fresh connection; true when it answers 200.
+bool get_root(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    bool ok = false;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        constexpr std::string_view kRequest =
+            "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+        char status_line[16] = {};
+        std::size_t received = 0;
+        if (send(fd, kRequest.data(), kRequest.size(), MSG_NOSIGNAL) ==
+            static_cast<ssize_t>(kRequest.size())) {
+            while (received < 12) {
+                const ssize_t n = recv(fd, status_line + received, 12 - received, 0);
+                if (n <= 0) {
+                    break;
+                }
+                received += static_cast<std::size_t>(n);
+            }
+        }
+        ok = received == 12 && std::string_view(status_line + 9, 3) == "200";
+    }
+    close(fd);
+    return ok;
+}
+
+std::optional<RunResult> run_once(const std::string& binary, int port, int settle_ms) {
+    const std::string port_argument = "--port=" + std::to_string(port);
+    char* argv[] = {const_cast<char*>(binary.c_str()), const_cast<char*>("--http"),
+                    const_cast<char*>(port_argument.c_str()), nullptr};
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    const auto start = Clock::now();
+    pid_t pid = 0;
+    const int spawn_error = posix_spawn(&pid, binary.c_str(), &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawn_error != 0) {
+        std::cerr << binary << ": cannot start (errno " << spawn_error << ")" << std::endl;
+        return std::nullopt;
+    }
+
+    std::optional<RunResult> result;
+    while (Clock::now() - start < kStartupTimeout) {
+        if (get_root(port)) {
+            RunResult run;
+            run.first_200_ms =
+                std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            run.rss_at_200_kb = read_rss_kb(pid);
+            std::this_thread::sleep_for(std::chrono::milliseconds(settle_ms));
+            run.rss_settled_kb = read_rss_kb(pid);
+            result = run;
+            break;
+        }
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            std::cerr << binary << ": exited before answering" << std::endl;
+            return std::nullopt;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    if (!result) {
+        std::cerr << binary << ": no 200 within " << kStartupTimeout.count() << " s" << std::endl;
+    }
+    kill(pid, SIGTERM);
+    while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+    }
+    return result;
+}
+
+template <typename Value>
+Value median(std::vector<Value> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+
+    std::cout << std::left << std::setw(24) << "binary" << std::right << std::setw(14)
+              << "first 200 p50" << std::setw(10) << "min" << std::setw(10) << "max"
+              << std::setw(14) << "RSS at 200" << std::setw(14) << "RSS settled" << std::endl;
+    int port = options.port;
+    int failures = 0;
+    for (const std::string& binary : options.binaries) {
+        if (access(binary.c_str(), X_OK) != 0) {
+            std::cout << std::left << std::setw(24) << binary << "  not built, skipped"
+                      << std::endl;
+            continue;
+        }
+        std::vector<double> times;
+        std::vector<long> rss_at_200;
+        std::vector<long> rss_settled;
+        for (int run = 0; run < options.runs; ++run) {
+            const auto result = run_once(binary, port++, options.settle_ms);
+            if (!result) {
+                ++failures;
+                break;
+            }
+            times.push_back(result->first_200_ms);
+            rss_at_200.push_back(result->rss_at_200_kb);
+            rss_settled.push_back(result->rss_settled_kb);
+        }
+        if (times.empty()) {
+            continue;
+        }
+        std::cout << std::left << std::setw(24) << binary << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(11) << median(times) << " ms"
+                  << std::setw(7) << *std::min_element(times.begin(), times.end()) << " ms"
+                  << std::setw(7) << *std::max_element(times.begin(), times.end()) << " ms"
+                  << std::setprecision(1) << std::setw(10) << median(rss_at_200) / 1024.0
+                  << " MiB" << std::setw(10) << median(rss_settled) / 1024.0 << " MiB"
+                  << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// Compares the HTML/JSON escaping kernels against the char-by-char versions
+// they replaced, on the English and French UI labels from locales/ plus longer
+// accented paragraphs of the kind found in task notes and contact cards.
+//
+// Usage: text_escape_bench [ITERATIONS]
+// Set BEAVER_ESCAPE_KERNEL=sse2 or scalar to pin a slower kernel.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/text_escape.h"
+
+namespace {
+
+std::string legacy_html_escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char ch : text) {
+        switch (ch) {
+            case '&':
+                escaped += "&amp;";
+                break;
+            case '<':
+                escaped += "&lt;";
+                break;
+            case '>':
+                escaped += "&gt;";
+                break;
+            case '\"':
+                escaped += "&quot;";
+                break;
+            case '\'':
+                escaped += "&#39;";
+                break;
+            default:
+                escaped.push_back(ch);
+                break;
+        }
+    }
+    return escaped;
+}
+
+std::string legacy_json_escape(const std::string& input) {
+    std::string escaped;
+    escaped.reserve(input.size() + 16);
+    for (char ch : input) {
+        switch (ch) {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\"':
+                escaped += "\\\"";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    std::ostringstream oss;
+                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                        << static_cast<int>(static_cast<unsigned char>(ch));
+                    escaped += oss.str();
+                } else {
+                    escaped += ch;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::vector<std::string> load_labels(const char* path) {
+    std::vector<std::string> labels;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        const auto separator = line.find('=');
+        if (separator != std::string::npos) {
+            labels.push_back(line.substr(separator + 1));
+        }
+    }
+    return labels;
+}
+
+const std::vector<std::string> kParagraphs = {
+    "Rappel : vérifier l'état des détecteurs de fumée au 2ᵉ étage avant vendredi. "
+    "Le technicien « Hydro-Québec » passera entre 9 h et 11 h — prévoir l'accès au "
+    "sous-sol & au local électrique. Noter toute anomalie dans le registre.",
+    "Reminder: check the smoke detectors on the 2nd floor before Friday. The "
+    "technician from \"North Shore Electric\" will come between 9 and 11 am - make "
+    "sure the basement & electrical room are unlocked. Log any issue in the register.",
+    "Élodie Côté-Lefèvre <elodie.cote@beaver.example> — Gestionnaire des opérations, "
+    "édifice Saint-Laurent, bureau 412. Disponible lun.–ven., 8 h 30 à 16 h 30.",
+    "Rendez-vous annulé par le client ; reprogrammer la visite d'entretien de la "
+    "thermopompe et confirmer par téléphone au 819-555-0142.\nMerci !",
+};
+
+template <typename Function>
+double measure(int iterations, Function&& function) {
+    constexpr int kRounds = 7;
+    std::vector<double> rounds;
+    function();
+    for (int round = 0; round < kRounds; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            function();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        rounds.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                         iterations);
+    }
+    std::sort(rounds.begin(), rounds.end());
+    return rounds[kRounds / 2];
+}
+
+void report(const char* label, std::size_t bytes, double legacy_ns, double kernel_ns) {
+    const auto throughput = [bytes](double ns) { return static_cast<double>(bytes) / ns; };
+    std::cout << std::left << std::setw(22) << label << std::right << std::fixed
+              << std::setprecision(0) << "legacy " << std::setw(8) << legacy_ns << " ns ("
+              << std::setprecision(2) << std::setw(5) << throughput(legacy_ns)
+              << " B/ns)  kernel " << std::setprecision(0) << std::setw(8) << kernel_ns
+              << " ns (" << std::setprecision(2) << std::setw(5) << throughput(kernel_ns)
+              << " B/ns)  x" << legacy_ns / kernel_ns << std::endl;
+}
+
+void compare(const char* name, const std::vector<std::string>& corpus, int iterations) {
+    std::size_t bytes = 0;
+    for (const auto& text : corpus) {
+        bytes += text.size();
+    }
+    std::size_t sink = 0;
+    std::string buffer;
+
+    const double legacy_html = measure(iterations, [&] {
+        for (const auto& text : corpus) {
+            sink += legacy_html_escape(text).size();
+        }
+    });
+    const double kernel_html = measure(iterations, [&] {
+        for (const auto& text : corpus) {
+            sink += html_escape(text).size();
+        }
+    });
+    const double kernel_html_reused = measure(iterations, [&] {
+        for (const auto& text : corpus) {
+            buffer.clear();
+            append_html_escaped(buffer, text);
+            sink += buffer.size();
+        }
+    });
+    const double legacy_json = measure(iterations, [&] {
+        for (const auto& text : corpus) {
+            sink += legacy_json_escape(text).size();
+        }
+    });
+    const double kernel_json = measure(iterations, [&] {
+        for (const auto& text : corpus) {
+            buffer.clear();
+            append_json_escaped(buffer, text);
+            sink += buffer.size();
+        }
+    });
+
+    std::cout << name << " (" << corpus.size() << " strings, " << bytes << " bytes)"
+              << std::endl;
+    report("  html_escape", bytes, legacy_html, kernel_html);
+    report("  html, reused buffer", bytes, legacy_html, kernel_html_reused);
+    report("  json, reused buffer", bytes, legacy_json, kernel_json);
+    if (sink == 0) {
+        std::cout << "empty corpus" << std::endl;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+    std::cout << "Kernel: " << text_escape_kernel_name() << ", " << iterations
+              << " iterations per round" << std::endl;
+
+    compare("English labels", load_labels("locales/en/strings.txt"), iterations);
+    compare("French labels", load_labels("locales/fr/strings.txt"), iterations);
+    compare("Paragraphs (FR/EN)", kParagraphs, iterations * 10);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class LogLevel : std::uint8_t {
+    kDebug,
+    kInfo,
+    kWarning,
+    kError,
+};
+
+const char* log_level_name(LogLevel level);
+bool parse_log_level(std::string_view text, LogLevel& level);
+
+struct AccessLogConfig {
+    std::string path = "logs/access.log";
+    LogLevel min_level = LogLevel::kInfo;
+    // Keep one in `sample_every` debug/info records; warnings and errors are
+    // always kept.
+    std::uint32_t sample_every = 1;
+    std::uint64_t max_file_bytes = 10 * 1024 * 1024;
+    // Rotated files kept next to the live one (access.log.1 ... access.log.N).
+    std::size_t max_files = 3;
+    std::chrono::milliseconds flush_interval{200};
+};
+
+// Reads BEAVER_ACCESS_LOG, BEAVER_LOG_LEVEL, BEAVER_LOG_SAMPLE,
+// BEAVER_ACCESS_LOG_MAX_BYTES and BEAVER_ACCESS_LOG_FILES on top of the defaults.
+AccessLogConfig access_log_config_from_environment();
+
+struct AccessLogStats {
+    std::uint64_t written = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t rotations = 0;
+};
+
+// Structured JSON-lines log for requests and page renders. Producers copy a
+// fixed-size record into a single-producer ring owned by their thread; no lock
+// or syscall is taken on that path, and a full ring drops the record and counts
+// it. A background thread drains every ring each flush interval, writes the
+// batch with one write(2), rotates the file by size and reports drops as
+// "dropped" lines. While the log is stopped, logging calls return immediately.
+class AccessLog {
+public:
+    AccessLog();
+    ~AccessLog();
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    void start(AccessLogConfig config);
+    // Drains what is queued, then closes the file.
+    void stop();
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    void log_request(std::string_view method, std::string_view path, int status,
+                     std::size_t bytes, std::chrono::microseconds latency);
+    void log_render(std::string_view page, std::string_view language, std::size_t bytes,
+                    std::chrono::microseconds elapsed);
+
+    AccessLogStats stats() const;
+
+    class Ring;
+
+private:
+    struct Record;
+
+    bool admit(LogLevel level, Ring*& ring);
+    Ring* thread_ring();
+    void run();
+    void drain(std::string& batch);
+    void write_batch(const std::string& batch);
+    void open_file();
+    void rotate();
+
+    AccessLogConfig config_;
+    std::atomic<bool> running_{false};
+    std::atomic<std::uint8_t> min_level_{static_cast<std::uint8_t>(LogLevel::kInfo)};
+    std::atomic<std::uint32_t> sample_every_{1};
+
+    mutable std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::uint16_t next_worker_ = 0;
+    // Drops counted by rings that were released after their thread exited.
+    std::uint64_t retired_dropped_ = 0;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+
+    // Writer-thread state.
+    int fd_ = -1;
+    std::uint64_t file_bytes_ = 0;
+    std::uint64_t reported_dropped_ = 0;
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> rotations_{0};
+};
+
+// Process-wide log used by the HTTP server and AppManager.
+AccessLog& access_log();
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class AlertComparator {
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+    kEqual,
+    kNotEqual,
+};
+
+struct AlertRule {
+    std::string name;
+    std::string metric;
+    AlertComparator comparator = AlertComparator::kGreater;
+    double threshold = 0.0;
+    std::chrono::seconds duration{0};
+    double hysteresis = 0.0;
+};
+
+struct MetricSample {
+    std::string_view metric;
+    double value = 0.0;
+};
+
+struct AlertTransition {
+    std::string name;
+    bool firing = false;
+    double value = 0.0;  // With metric_missing, the last value that was sampled.
+    bool metric_missing = false;
+};
+
+struct ActiveAlert {
+    std::string name;
+    std::string metric;
+    AlertComparator comparator = AlertComparator::kGreater;
+    double threshold = 0.0;
+    double value = 0.0;
+    std::chrono::system_clock::time_point since;
+};
+
+const char* alert_comparator_symbol(AlertComparator comparator);
+
+// Reads one rule per line:
+//   <name> <metric> <comparator> <threshold> [for <duration>] [hysteresis <value>]
+// where duration accepts an optional s/m/h suffix. Blank lines and '#' comments
+// are ignored; malformed lines are reported and skipped.
+std::vector<AlertRule> load_alert_rules(const std::string& path);
+
+// Evaluates rules against metric samples. Only the rules attached to metrics whose
+// value changed or that went missing since the previous call, plus pending rules
+// whose duration elapsed, are visited on each call. A rule fires once its condition has held for
+// `duration` and resolves when the value moves back past the threshold by at
+// least `hysteresis`. A metric absent from a sample set (the battery was
+// unplugged, Wi-Fi went away) resolves its firing rules and cancels pending ones.
+class AlertEngine {
+public:
+    explicit AlertEngine(std::vector<AlertRule> rules);
+
+    AlertEngine(const AlertEngine&) = delete;
+    AlertEngine& operator=(const AlertEngine&) = delete;
+
+    // Returns the firing/resolved transitions caused by this sample set.
+    std::vector<AlertTransition> evaluate(const std::vector<MetricSample>& samples,
+                                          std::chrono::steady_clock::time_point now,
+                                          std::chrono::system_clock::time_point wall_now);
+
+    std::vector<ActiveAlert> active_alerts() const;
+    std::size_t rule_count() const { return rules_.size(); }
+
+private:
+    using Deadlines = std::multimap<std::chrono::steady_clock::time_point, std::size_t>;
+
+    enum class RuleState { kInactive, kPending, kFiring };
+
+    struct RuleRuntime {
+        RuleState state = RuleState::kInactive;
+        double value = 0.0;
+        std::chrono::steady_clock::time_point pending_since;
+        std::chrono::system_clock::time_point firing_since;
+        Deadlines::iterator deadline;
+    };
+
+    void evaluate_rule(std::size_t index, double value, std::chrono::steady_clock::time_point now,
+                       std::chrono::system_clock::time_point wall_now,
+                       std::vector<AlertTransition>& transitions);
+    void fire(std::size_t index, std::chrono::system_clock::time_point wall_now,
+              std::vector<AlertTransition>& transitions);
+    void forget_metric(std::size_t id, std::vector<AlertTransition>& transitions);
+
+    std::vector<AlertRule> rules_;
+    std::vector<RuleRuntime> runtime_;
+    std::vector<std::string> metric_names_;
+    std::unordered_map<std::string_view, std::size_t> metric_ids_;
+    std::vector<std::vector<std::size_t>> rules_by_metric_;
+    std::vector<double> metric_values_;
+    std::vector<bool> metric_seen_;
+    std::vector<std::uint64_t> metric_pass_;  // Last evaluate() call that sampled it.
+    std::uint64_t pass_ = 0;
+    std::vector<std::size_t> sampled_before_;  // Metric ids sampled by the previous call.
+    std::vector<std::size_t> sampled_now_;
+    Deadlines deadlines_;
+    std::set<std::size_t> firing_;
+};
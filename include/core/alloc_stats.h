@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Optional accounting of global operator new/delete. alloc_stats.cpp replaces
+// the global operators; while accounting is enabled each call bumps counters
+// of the calling thread (plain thread_local integers, no atomics), and while
+// it is disabled the hooks cost one relaxed load and a branch. Enabled with
+// BEAVER_ALLOC_STATS=1, or by benchmarks.
+
+struct AllocationCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t frees = 0;
+
+    AllocationCounts operator-(const AllocationCounts& other) const {
+        return {allocations - other.allocations, bytes - other.bytes, frees - other.frees};
+    }
+};
+
+namespace alloc_stats_internal {
+inline std::atomic<bool> enabled{false};
+}  // namespace alloc_stats_internal
+
+inline bool allocation_accounting_enabled() {
+    return alloc_stats_internal::enabled.load(std::memory_order_relaxed);
+}
+
+void set_allocation_accounting(bool enabled);
+// Applies BEAVER_ALLOC_STATS=1.
+void allocation_accounting_from_environment();
+
+// Everything the calling thread allocated while accounting was enabled.
+AllocationCounts thread_allocation_counts();
+
+// Allocations made by the calling thread since construction.
+class AllocationScope {
+public:
+    AllocationScope() : start_(thread_allocation_counts()) {}
+
+    AllocationCounts elapsed() const { return thread_allocation_counts() - start_; }
+
+private:
+    AllocationCounts start_;
+};
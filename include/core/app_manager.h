@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <deque>
 #include <optional>
 #include <string>
 #include <vector>
@@ -55,6 +57,25 @@ enum class BeaverTaskMenuLinkMode {
     kRelativeIndex
 };
 
+// Pages rendered locally by AppManager, as opposed to remote apps.
+enum class AppPage {
+    kMenu,
+    kBeaverPhone,
+    kBeaverTask,
+    kBeaverAlarm,
+    kBeaverSystem,
+};
+
+struct AppPageRoute {
+    const char* path;
+    AppPage page;
+};
+
+// Every locally rendered page and the path it lives under. The HTTP server and
+// the GTK shell both build their routers from this list, so a new app page only
+// needs an entry here and a case in AppManager::page_html().
+const std::vector<AppPageRoute>& app_page_routes();
+
 struct NavigationRecord {
     std::string app_name;
     MenuRouteMode route_mode;
@@ -71,11 +92,19 @@ public:
 
     void set_app_routes(const std::string& app_name, const AppRoutes& routes);
 
+    // Keeps the most recent kMaxNavigationHistory records; older ones are
+    // dropped so a kiosk left running for weeks does not grow without bound.
     void record_navigation(const std::string& app_name, MenuRouteMode route_mode);
     void clear_navigation_history();
+    std::size_t navigation_history_size() const;
+    static constexpr std::size_t kMaxNavigationHistory = 64;
     std::optional<RouteMatch> match_route_for_uri(const std::string& uri,
                                                   MenuRouteMode route_mode) const;
 
+    // Renders `page` with the asset prefix and menu links the given front-end
+    // expects: "/" and absolute links over HTTP, relative ones in the kiosk.
+    std::string page_html(AppPage page, Language language, MenuRouteMode route_mode) const;
+
     std::string to_json() const;
     std::string to_json(Language language) const;
     std::string to_html() const;
@@ -119,5 +148,5 @@ private:
     std::vector<AppTile> apps_;
     Language default_language_;
     TranslationCatalog translation_catalog_;
-    std::vector<NavigationRecord> navigation_history_;
+    std::deque<NavigationRecord> navigation_history_;
 };
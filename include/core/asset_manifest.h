@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Fingerprinted URLs for public/, built once at startup from the resource
+// bundle: "css/styles.css" is published as "css/styles.684fec13.css". Pages
+// link the fingerprinted names, which never change content and can be cached
+// for a year, so repeat page loads make no asset requests at all. With
+// BEAVER_RESOURCE_DIR the files can change under a running server, so the
+// manifest stays empty and pages keep the plain, revalidated names.
+class AssetManifest {
+public:
+    AssetManifest();
+
+    // The fingerprinted name of `plain` ("css/styles.css"), or `plain` itself
+    // when it is not a bundled public/ file.
+    std::string_view fingerprinted(std::string_view plain) const;
+
+    // The resource path ("public/css/styles.css") a fingerprinted name was
+    // made from, or nullptr when `fingerprinted` is not one.
+    const std::string* resource_for(std::string_view fingerprinted) const;
+
+    std::size_t size() const { return by_plain_name_.size(); }
+
+private:
+    std::unordered_map<std::string_view, std::string> by_plain_name_;
+    std::unordered_map<std::string, std::string> resource_by_fingerprint_;
+};
+
+const AssetManifest& asset_manifest();
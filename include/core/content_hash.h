@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// FNV-1a 64 of `data` as 16 lowercase hex digits. Names a version of a file
+// (ETags, fingerprinted asset URLs), not a security boundary. The resource
+// generator and the runtime share it so embedded and on-disk files hash alike.
+std::string content_hash(std::string_view data);
+
+// "css/styles.css" -> "css/styles.3f9a1c2b.css": the first 8 digits of `hash`
+// before the extension, so the name changes whenever the content does.
+std::string fingerprinted_path(std::string_view path, std::string_view hash);
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// High-dynamic-range histogram of integer values (microseconds in practice),
+// after Gil Tene's HdrHistogram: values are grouped in power-of-two buckets,
+// each split into linear sub-buckets, so every recorded value keeps
+// `significant_digits` decimal digits of precision from 1 up to the highest
+// trackable value at a fixed memory cost. Not thread-safe; keep one per thread
+// and merge().
+class HdrHistogram {
+public:
+    explicit HdrHistogram(std::uint64_t highest_trackable_value = 60'000'000,
+                          int significant_digits = 3);
+
+    // Values above the trackable range are clamped to it.
+    void record(std::uint64_t value, std::uint64_t count = 1);
+    // Both histograms must have been built with the same parameters.
+    void merge(const HdrHistogram& other);
+    void reset();
+
+    std::uint64_t count() const { return total_count_; }
+    std::uint64_t min() const { return total_count_ == 0 ? 0 : min_; }
+    std::uint64_t max() const { return max_; }
+    double mean() const;
+    // Highest value equivalent to the one at `percentile` (0..100).
+    std::uint64_t value_at_percentile(double percentile) const;
+
+private:
+    std::size_t counts_index(std::uint64_t value) const;
+    std::uint64_t value_at_index(std::size_t index) const;
+
+    std::uint64_t highest_trackable_value_;
+    int sub_bucket_half_count_magnitude_ = 0;
+    std::uint64_t sub_bucket_count_ = 0;
+    std::uint64_t sub_bucket_mask_ = 0;
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_count_ = 0;
+    std::uint64_t min_ = UINT64_MAX;
+    std::uint64_t max_ = 0;
+};
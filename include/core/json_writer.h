@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+enum class JsonStyle {
+    kCompact,
+    kPretty,
+};
+
+// Appends the JSON string literal for `text` (quotes included) to `out`.
+void append_json_string(std::string& out, std::string_view text);
+
+// Returns `text` escaped for use inside a JSON string literal, without quotes.
+std::string json_escape(std::string_view text);
+
+// Streams a JSON document into a caller-owned buffer. Nothing is allocated
+// beyond the buffer's own growth, so callers that keep the string around (and
+// clear() it between documents) serialize without touching the heap once it
+// has reached its working size. Numbers go through std::to_chars.
+//
+// Pretty output puts every member and element on its own line with two-space
+// indentation; compact output has no whitespace at all. Nesting deeper than
+// kMaxDepth levels or closing more containers than were opened throws
+// std::logic_error in every build, since either would index past the
+// per-level state. Debug builds also assert that begin/end calls pair up by
+// kind and that object members are always keyed.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out, JsonStyle style = JsonStyle::kPretty);
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& string(std::string_view text);
+    JsonWriter& boolean(bool value);
+    JsonWriter& null();
+    JsonWriter& number(long long value);
+    JsonWriter& number(unsigned long long value);
+    JsonWriter& number(int value) { return number(static_cast<long long>(value)); }
+    JsonWriter& number(long value) { return number(static_cast<long long>(value)); }
+    JsonWriter& number(unsigned int value) {
+        return number(static_cast<unsigned long long>(value));
+    }
+    JsonWriter& number(unsigned long value) {
+        return number(static_cast<unsigned long long>(value));
+    }
+    // Fixed-point with `precision` decimals; non-finite values become null.
+    JsonWriter& number(double value, int precision);
+    // Like number(double, int), but negative values (the "unknown" marker used
+    // throughout SystemStatusSnapshot) are also written as null.
+    JsonWriter& optional_number(double value, int precision);
+    // Inserts an already-serialized JSON value verbatim.
+    JsonWriter& raw(std::string_view json);
+
+    // Terminates a pretty document with a newline. Debug builds check that
+    // every container has been closed.
+    void finish();
+
+    static constexpr std::size_t kMaxDepth = 32;
+
+private:
+    void before_value();
+    void open(char bracket, bool is_array);
+    void close(char bracket, bool is_array);
+    void newline();
+
+    std::string& out_;
+    bool pretty_ = true;
+    std::size_t depth_ = 0;
+    // Whether the innermost container already holds a member/element.
+    bool has_items_[kMaxDepth] = {};
+    bool after_key_ = false;
+#ifndef NDEBUG
+    bool is_array_[kMaxDepth] = {};
+#endif
+};
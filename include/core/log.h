@@ -0,0 +1,19 @@
+#pragma once
+
+// printf-style diagnostics on stderr in GLib's format ("** Message: ..."), so
+// the core builds without GLib. Debug lines are printed when G_MESSAGES_DEBUG
+// is set, as with g_debug().
+
+#if defined(__GNUC__)
+#define BEAVER_PRINTF_FORMAT __attribute__((format(printf, 1, 2)))
+#else
+#define BEAVER_PRINTF_FORMAT
+#endif
+
+void log_debug(const char* format, ...) BEAVER_PRINTF_FORMAT;
+void log_message(const char* format, ...) BEAVER_PRINTF_FORMAT;
+void log_warning(const char* format, ...) BEAVER_PRINTF_FORMAT;
+
+// Drops debug and message lines, e.g. while a benchmark rebuilds catalogs in a
+// loop. Warnings are always printed.
+void set_log_messages_muted(bool muted);
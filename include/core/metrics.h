@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Each metric keeps one cache-line-sized cell per shard, and a thread always
+// updates the shard it was assigned on first use. Updates are relaxed atomic
+// adds on a line other threads rarely touch; reads sum the shards.
+inline constexpr std::size_t kMetricShards = 8;
+
+std::size_t metric_shard();
+
+class Counter {
+public:
+    void inc(std::uint64_t amount = 1) {
+        cells_[metric_shard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    std::uint64_t value() const;
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Cell, kMetricShards> cells_;
+};
+
+class Gauge {
+public:
+    void set(std::int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(std::int64_t amount) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    void sub(std::int64_t amount) { value_.fetch_sub(amount, std::memory_order_relaxed); }
+    std::int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> value_{0};
+};
+
+// Duration histogram with fixed upper bounds (in seconds). An observation is
+// one relaxed add to its bucket and one to the running sum.
+class Histogram {
+public:
+    static constexpr std::size_t kMaxBuckets = 16;
+
+    explicit Histogram(const std::vector<double>& upper_bounds_seconds);
+
+    void observe(std::chrono::nanoseconds elapsed) {
+        const auto nanoseconds =
+            static_cast<std::uint64_t>(std::max<std::int64_t>(0, elapsed.count()));
+        std::size_t bucket = 0;
+        while (bucket < bucket_count_ && nanoseconds > bounds_ns_[bucket]) {
+            ++bucket;
+        }
+        Shard& shard = shards_[metric_shard()];
+        shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        shard.sum_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    struct Snapshot {
+        std::vector<double> upper_bounds;
+        std::vector<std::uint64_t> cumulative_counts;  // One more than upper_bounds (+Inf).
+        std::uint64_t count = 0;
+        double sum_seconds = 0.0;
+    };
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, kMaxBuckets + 1> buckets{};
+        std::atomic<std::uint64_t> sum_ns{0};
+    };
+
+    std::vector<double> bounds_seconds_;
+    std::array<std::uint64_t, kMaxBuckets> bounds_ns_{};
+    std::size_t bucket_count_ = 0;
+    std::array<Shard, kMetricShards> shards_;
+};
+
+// Observes the time between construction and destruction.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), started_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram_.observe(std::chrono::steady_clock::now() - started_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// 100 µs .. 2.5 s, suited to request handling and page renders.
+const std::vector<double>& default_latency_buckets();
+
+// Named metric families, each holding one series per label set. Registration
+// takes a lock and returns a reference that stays valid for the life of the
+// process, so call sites look a series up once and keep the reference.
+class MetricsRegistry {
+public:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Counter family names omit the "_total" suffix; it is added on export.
+    Counter& counter(const std::string& name, const std::string& help,
+                     const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help,
+                 const MetricLabels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const MetricLabels& labels = {},
+                         const std::vector<double>& upper_bounds = default_latency_buckets());
+
+    // OpenMetrics text exposition, terminated by "# EOF".
+    void write_openmetrics(std::string& out) const;
+
+private:
+    enum class Type { kCounter, kGauge, kHistogram };
+
+    struct Series {
+        std::string labels;  // Rendered as `name="value",...`.
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type = Type::kCounter;
+        std::vector<std::unique_ptr<Series>> series;
+        std::unordered_map<std::string, Series*> by_labels;
+    };
+
+    // Finds or creates the series; `upper_bounds` is only used for histograms.
+    Series& series(const std::string& name, const std::string& help, Type type,
+                   const MetricLabels& labels, const std::vector<double>* upper_bounds = nullptr);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+    std::unordered_map<std::string, Family*> by_name_;
+};
+
+// Process-wide registry exported at /metrics.
+MetricsRegistry& metrics();
+
+inline constexpr const char* kOpenMetricsContentType =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+// Hit/miss counters of one cache in beaver_cache_lookups_total{cache,result};
+// the hit ratio is hit / (hit + miss).
+class CacheMetrics {
+public:
+    explicit CacheMetrics(const std::string& cache);
+
+    void record(bool hit) { (hit ? hits_ : misses_).inc(); }
+
+private:
+    Counter& hits_;
+    Counter& misses_;
+};
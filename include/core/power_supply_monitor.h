@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "core/system_status.h"
+
+// Caches the battery state from <sysfs_root>. Battery devices are discovered once,
+// then kept up to date from kernel uevents (NETLINK_KOBJECT_UEVENT) which carry the
+// POWER_SUPPLY_* properties, so a status request normally costs a single
+// non-blocking recv(). sysfs is re-read only on add/remove events, socket overruns
+// and a slow periodic refresh that acts as a safety net for missed events.
+class PowerSupplyMonitor {
+public:
+    explicit PowerSupplyMonitor(std::string sysfs_root = "/sys/class/power_supply",
+                                std::chrono::seconds refresh_interval = std::chrono::seconds(60));
+    ~PowerSupplyMonitor();
+
+    PowerSupplyMonitor(const PowerSupplyMonitor&) = delete;
+    PowerSupplyMonitor& operator=(const PowerSupplyMonitor&) = delete;
+
+    BatteryStatus current();
+
+private:
+    void open_uevent_socket();
+    void drain_events();
+    void apply_event(std::string_view message);
+    void discover();
+    void refresh_from_sysfs();
+
+    std::string sysfs_root_;
+    std::chrono::seconds refresh_interval_;
+    int uevent_fd_ = -1;
+    bool needs_discovery_ = true;
+    std::string battery_name_;
+    BatteryStatus cached_;
+    std::optional<std::chrono::steady_clock::time_point> last_refresh_;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <dirent.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ProcessSample {
+    int pid = 0;
+    std::string command;
+    char state = '?';
+    double cpu_percent = 0.0;
+    std::uint64_t rss_bytes = 0;
+};
+
+struct ProcessTable {
+    std::size_t total_processes = 0;
+    double interval_seconds = 0.0;
+    std::vector<ProcessSample> top_cpu;
+    std::vector<ProcessSample> top_memory;
+};
+
+// Walks <proc_root>/[pid]/stat and statm, keeping per-PID state between scans so
+// CPU usage is reported as a delta over the previous scan. Descriptors of known
+// processes stay open (within a budget derived from RLIMIT_NOFILE) and are
+// re-read with pread() into fixed stack buffers.
+class ProcessScanner {
+public:
+    explicit ProcessScanner(std::string proc_root = "/proc");
+    ~ProcessScanner();
+
+    ProcessScanner(const ProcessScanner&) = delete;
+    ProcessScanner& operator=(const ProcessScanner&) = delete;
+
+    ProcessTable scan(std::size_t top_n);
+
+private:
+    struct TrackedProcess {
+        int stat_fd = -1;
+        int statm_fd = -1;
+        unsigned long long start_time = 0;
+        unsigned long long cpu_ticks = 0;
+        std::uint64_t generation = 0;
+        char state = '?';
+        std::string command;
+    };
+
+    struct Reading {
+        unsigned long long start_time = 0;
+        unsigned long long cpu_ticks = 0;
+        std::uint64_t resident_pages = 0;
+    };
+
+    bool open_proc_directory();
+    bool read_process(int pid, TrackedProcess& process, Reading& reading);
+    bool read_process_once(int pid, TrackedProcess& process, Reading& reading);
+    void release_descriptors(TrackedProcess& process);
+
+    std::string proc_root_;
+    DIR* proc_dir_ = nullptr;
+    std::unordered_map<int, TrackedProcess> processes_;
+    std::uint64_t generation_ = 0;
+    std::size_t open_descriptors_ = 0;
+    std::size_t descriptor_budget_ = 0;
+    bool has_previous_scan_ = false;
+    std::chrono::steady_clock::time_point last_scan_;
+    long clock_ticks_per_second_ = 100;
+    long page_size_ = 4096;
+};
+
+std::string process_table_to_json(const ProcessTable& table);
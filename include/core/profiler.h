@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+// Sampling CPU profiler for kiosks without perf or root. setitimer(ITIMER_PROF)
+// raises SIGPROF every 1/frequency seconds of process CPU time; the handler
+// unwinds the interrupted thread with backtrace() into a preallocated ring and
+// does nothing else. Addresses are only turned into names when the profile is
+// exported, as folded stacks ("main;run;handle 42") for flamegraph.pl,
+// speedscope or inferno. Functions the dynamic symbol table does not name
+// (static and anonymous-namespace ones) show up as "beaver_kiosk+0x1a2b"; feed
+// the offset to `addr2line -Cfe beaver_kiosk` to resolve them.
+
+// Arms the timer. False when a profile is already running.
+bool start_profiling(int frequency_hz = 100);
+
+// Disarms the timer and returns the samples taken since start_profiling() as
+// folded stacks, most frequent first. When the ring wrapped, the oldest
+// samples are missing.
+std::string stop_profiling();
+
+// BEAVER_PROFILE=1 profiles from startup and BEAVER_PROFILE_HZ sets the
+// frequency. The signal (SIGUSR1 by default) starts a profile, and the next one
+// writes it to logs/profile-<time>.folded.
+void install_profile_controls(int signal_number);
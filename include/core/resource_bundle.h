@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// public/ and locales/ are compiled into the binary by tools/embed_resources,
+// so the kiosk serves its stylesheet, icons and translations without touching
+// the disk and cannot drift from the build it shipped with. Each entry carries
+// a gzip -9 copy made at build time and its content_hash().
+struct Resource {
+    std::string_view path;  // Relative to the source tree: "public/css/styles.css".
+    std::string_view data;
+    std::string_view gzip;  // Empty when compressing did not make it smaller.
+    std::string_view hash;  // content_hash(data).
+};
+
+// Looks `path` up in the embedded index (a binary search; entries are static
+// and never freed). With BEAVER_RESOURCE_DIR set, the file is read from that
+// directory on every call instead, so edits show up without a rebuild; those
+// copies have no gzip variant. Null when the resource does not exist.
+std::shared_ptr<const Resource> find_resource(std::string_view path);
+
+// Every resource whose path starts with `prefix` ("public/"), sorted by path.
+std::vector<std::shared_ptr<const Resource>> list_resources(std::string_view prefix);
+
+// False under the BEAVER_RESOURCE_DIR override.
+bool resources_embedded();
+
+// "embedded" or the BEAVER_RESOURCE_DIR directory, for startup logs.
+const char* resource_source();
+
+// Written by the generator, sorted by path.
+extern const Resource kEmbeddedResources[];
+extern const std::size_t kEmbeddedResourceCount;
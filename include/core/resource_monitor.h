@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Process resource usage at one point of a long run.
+struct ResourceSample {
+    double elapsed_seconds = 0.0;
+    std::uint64_t requests = 0;  // Work done so far, filled in by the caller.
+    std::uint64_t rss_kb = 0;
+    std::uint64_t open_fds = 0;
+    std::uint64_t threads = 0;
+    std::uint64_t heap_in_use_bytes = 0;
+};
+
+// Reads VmRSS and Threads from /proc/self/status, counts /proc/self/fd and
+// asks the allocator how much heap is in use.
+ResourceSample sample_process_resources();
+
+// Growth allowed between the start and the end of the measured part of a run.
+struct ResourceBudgets {
+    std::uint64_t rss_kb = 8192;
+    std::uint64_t heap_kb = 4096;
+    std::uint64_t open_fds = 4;
+    std::uint64_t threads = 2;
+    // Steady heap growth per request above this is reported as a leak.
+    double heap_bytes_per_request = 16.0;
+};
+
+// Reads BEAVER_SOAK_RSS_KB, BEAVER_SOAK_HEAP_KB, BEAVER_SOAK_FDS,
+// BEAVER_SOAK_THREADS and BEAVER_SOAK_BYTES_PER_REQUEST on top of the defaults.
+ResourceBudgets resource_budgets_from_environment();
+
+struct ResourceTrend {
+    std::string name;
+    std::string unit;
+    double start = 0.0;  // Median of the first quarter of the measured samples.
+    double end = 0.0;    // Median of the last quarter.
+    double growth = 0.0;
+    // Least-squares slope against the request count.
+    double per_request = 0.0;
+    // Every quarter's median above the previous one.
+    bool monotonic = false;
+    double budget = 0.0;
+    bool over_budget = false;
+};
+
+// Trends of RSS, heap, fds and threads over the samples after the first
+// `warmup_fraction` of the run, which is left out so caches and lazily
+// created state can settle. Medians of quarters keep one noisy sample from
+// failing a run.
+std::vector<ResourceTrend> analyze_resource_growth(const std::vector<ResourceSample>& samples,
+                                                   const ResourceBudgets& budgets,
+                                                   double warmup_fraction = 0.2);
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class RouteKind {
+    kExact,
+    kPrefix,  // Also matches any deeper path; the remainder is RouteParams::rest().
+};
+
+enum class RouteCaching {
+    kUnspecified,  // No Cache-Control header.
+    kNoStore,      // Dynamic pages and live status.
+    kRevalidate,   // Assets that change with a redeploy.
+    kPublic,       // Icons and other long-lived assets.
+    kImmutable,    // Fingerprinted assets, whose content never changes.
+};
+
+// Cache-Control value for `caching`, or nullptr for kUnspecified.
+const char* route_cache_control(RouteCaching caching);
+
+struct RouteOptions {
+    RouteKind kind = RouteKind::kExact;
+    RouteCaching caching = RouteCaching::kUnspecified;
+    const char* content_type = nullptr;
+};
+
+// Values captured while matching a path. They point into the matched path and
+// the route table, so they are only valid while both are alive.
+class RouteParams {
+public:
+    static constexpr std::size_t kMaxParams = 4;
+
+    // Value of the ":name" segment, or an empty view.
+    std::string_view get(std::string_view name) const;
+    // For prefix routes, whatever followed the pattern (without the leading '/').
+    std::string_view rest() const { return rest_; }
+
+private:
+    friend class RouteTrie;
+
+    std::array<std::pair<std::string_view, std::string_view>, kMaxParams> values_{};
+    std::size_t count_ = 0;
+    std::string_view rest_;
+};
+
+// Segment trie behind Router. Patterns are split on '/', and a segment written
+// as ":name" matches any single segment. Lookup walks one hash probe per path
+// segment, so its cost depends on the depth of the path, not on the number of
+// routes. Literal segments win over parameters, and an exact route wins over a
+// prefix route registered at the same node; otherwise the deepest matching
+// prefix route is used. Empty segments ("//", trailing '/') are ignored.
+class RouteTrie {
+public:
+    static constexpr std::size_t kNoRoute = static_cast<std::size_t>(-1);
+
+    RouteTrie();
+
+    // Returns false, leaving the trie unchanged, if the pattern has more than
+    // RouteParams::kMaxParams parameters, an empty or repeated parameter name,
+    // a parameter named differently from the one already registered at the
+    // same position, or the same kind of route as an existing one.
+    bool insert(std::string_view pattern, RouteKind kind, std::size_t route_index);
+    std::size_t find(std::string_view path, RouteParams& params) const;
+
+private:
+    struct Node {
+        std::string segment;
+        std::unordered_map<std::string_view, std::size_t> literal_children;
+        std::size_t parameter_child = kNoRoute;
+        std::size_t exact_route = kNoRoute;
+        std::size_t prefix_route = kNoRoute;
+    };
+
+    bool can_insert(std::string_view pattern, RouteKind kind) const;
+
+    // A deque keeps nodes (and the segment strings the child maps point into)
+    // at stable addresses as the trie grows.
+    std::deque<Node> nodes_;
+};
+
+// Route table shared by the front-ends. Handler is whatever the front-end
+// dispatches on: a callable for the HTTP server, a page id for the GTK shell.
+template <typename Handler>
+class Router {
+public:
+    struct Route {
+        std::string pattern;
+        RouteOptions options;
+        Handler handler;
+    };
+
+    bool add(std::string pattern, Handler handler, RouteOptions options = {}) {
+        if (!trie_.insert(pattern, options.kind, routes_.size())) {
+            return false;
+        }
+        routes_.push_back(Route{std::move(pattern), options, std::move(handler)});
+        return true;
+    }
+
+    const Route* match(std::string_view path, RouteParams& params) const {
+        const std::size_t index = trie_.find(path, params);
+        return index == RouteTrie::kNoRoute ? nullptr : &routes_[index];
+    }
+
+    const std::vector<Route>& routes() const { return routes_; }
+
+private:
+    std::vector<Route> routes_;
+    RouteTrie trie_;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <dirent.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SocketOwner {
+    int pid = -1;
+    std::string command;
+};
+
+// Resolves socket inodes to the process holding them by reading the
+// <proc_root>/[pid]/fd symlinks. The inode -> PID index is kept between calls
+// and a process's fd table is re-read when the process is new or its
+// descriptor count (st_size of the fd directory) changed. The count stays the
+// same when a process closes one descriptor and opens a socket (and kernels
+// that do not report it always say 0), so while requested inodes remain
+// unresolved the other processes are rescanned too, until all are found.
+// Sockets of processes we cannot read never resolve, so that full rescan is
+// only repeated when the set of unresolved inodes changes, or once every
+// `full_rescan_interval` otherwise.
+class SocketOwnerIndex {
+public:
+    explicit SocketOwnerIndex(std::string proc_root = "/proc",
+                              std::chrono::seconds full_rescan_interval = std::chrono::minutes(1));
+    ~SocketOwnerIndex();
+
+    SocketOwnerIndex(const SocketOwnerIndex&) = delete;
+    SocketOwnerIndex& operator=(const SocketOwnerIndex&) = delete;
+
+    std::unordered_map<std::uint64_t, SocketOwner> resolve(
+        const std::vector<std::uint64_t>& inodes);
+
+private:
+    struct ProcessEntry {
+        long long fd_count = -1;
+        std::uint64_t generation = 0;
+        bool readable = true;
+        std::vector<std::uint64_t> socket_inodes;
+        std::string command;
+    };
+
+    bool open_proc_directory();
+    void rescan_process(int pid, ProcessEntry& entry);
+    void forget_inodes(int pid, ProcessEntry& entry);
+    bool all_resolved(const std::vector<std::uint64_t>& inodes) const;
+
+    std::string proc_root_;
+    std::chrono::seconds full_rescan_interval_;
+    // Requested inodes still unresolved after the last full rescan, sorted.
+    std::vector<std::uint64_t> unresolved_after_rescan_;
+    std::chrono::steady_clock::time_point last_full_rescan_;
+    DIR* proc_dir_ = nullptr;
+    std::unordered_map<int, ProcessEntry> processes_;
+    std::unordered_map<std::uint64_t, std::vector<int>> inode_owners_;
+    std::uint64_t generation_ = 0;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Leaf values of a status JSON document keyed by dotted path, e.g.
+// {"debian.loadAverage", "[0.10,0.20,0.30]"}. Objects are flattened, arrays
+// and scalars are kept as compact JSON text.
+using StatusFields = std::vector<std::pair<std::string, std::string>>;
+
+StatusFields flatten_status_json(std::string_view json);
+
+// True when the two documents differ in anything but the fields named in `ignored`.
+bool status_fields_differ(const StatusFields& from, const StatusFields& to,
+                          const std::vector<std::string_view>& ignored = {});
+
+// {"type":"status","mode":"delta","epoch":E,"version":to,"since":from,"changes":{...},
+//  "removed":[...]}
+// `changes` maps dotted paths to their new value. Versions are only comparable
+// within one epoch (see StatusSampler::epoch()).
+std::string encode_status_delta(const StatusFields& from, const StatusFields& to,
+                                std::string_view epoch, std::uint64_t from_version,
+                                std::uint64_t to_version);
+
+// {"type":"status","mode":"full","epoch":E,"version":N,"status":{...}}
+std::string encode_status_full(std::string_view status_json, std::string_view epoch,
+                               std::uint64_t version);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/status_delta.h"
+#include "core/system_status.h"
+
+struct PublishedStatus {
+    std::uint64_t version = 0;
+    SystemStatusSnapshot snapshot;
+    std::string json;
+    StatusFields fields;
+    std::string full_update;   // encode_status_full() of this version.
+    std::string delta_update;  // Delta from the previous version; empty for the first.
+};
+
+enum class StatusUpdateKind { kUnchanged, kDelta, kFull };
+
+struct StatusUpdate {
+    StatusUpdateKind kind = StatusUpdateKind::kUnchanged;
+    std::uint64_t version = 0;
+    std::string payload;
+};
+
+// Collects the system status on a background thread and publishes immutable,
+// versioned snapshots. A new version is only published when something other than
+// the timestamp changed. The JSON, the full update and the delta from the previous
+// version are serialized once per version so any number of readers can share them;
+// the last `history_size` versions are kept to answer deltas for lagging clients.
+//
+// Versions restart at 1 with every process, so clients hold them as a token
+// "<epoch>-<version>", where the epoch is a random nonce drawn at construction.
+// A token from another epoch (an earlier run of the server) reads as version 0,
+// which always gets a full resync.
+class StatusSampler {
+public:
+    using Collector = std::function<SystemStatusSnapshot()>;
+    using Listener = std::function<void(std::uint64_t version)>;
+
+    explicit StatusSampler(std::chrono::milliseconds interval = std::chrono::seconds(2),
+                           Collector collector = collect_system_status,
+                           std::size_t history_size = 64);
+    ~StatusSampler();
+
+    StatusSampler(const StatusSampler&) = delete;
+    StatusSampler& operator=(const StatusSampler&) = delete;
+
+    // Takes a first sample synchronously, then keeps sampling in the background.
+    void start();
+    void stop();
+
+    // Listeners run on the sampler thread right after a version is published and
+    // must not block; they are meant for waking other event loops.
+    void add_listener(Listener listener);
+
+    std::shared_ptr<const PublishedStatus> latest() const;
+
+    const std::string& epoch() const { return epoch_; }
+    std::string version_token(std::uint64_t version) const;
+    // The version in a token of this epoch, 0 for any other token.
+    std::uint64_t parse_version_token(std::string_view token) const;
+
+    // What a client holding `version` needs to catch up: nothing, a delta, or a
+    // full resync when that version is unknown or no longer in the history.
+    StatusUpdate update_since(std::uint64_t version) const;
+
+    // Blocks until a version newer than `version` is published, the deadline passes
+    // or the sampler stops. Returns nullptr when nothing newer is available.
+    std::shared_ptr<const PublishedStatus> wait_for_newer(
+        std::uint64_t version, std::chrono::steady_clock::time_point deadline) const;
+
+private:
+    void run();
+    void publish(SystemStatusSnapshot snapshot);
+
+    const std::string epoch_;
+    std::chrono::milliseconds interval_;
+    Collector collector_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable changed_;
+    std::size_t history_size_;
+    std::shared_ptr<const PublishedStatus> latest_;
+    std::deque<std::shared_ptr<const PublishedStatus>> history_;
+    std::vector<Listener> listeners_;
+    // Serialization scratch space, only touched by the publishing thread.
+    std::string json_buffer_;
+    bool running_ = false;
+    std::thread thread_;
+};
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
+#include "core/alert_engine.h"
+#include "core/json_writer.h"
+
 struct WifiStatus {
     bool available = false;
     bool connected = false;
@@ -11,11 +15,29 @@ struct WifiStatus {
     std::string status_text;
 };
 
+struct LatencySummary {
+    std::size_t samples = 0;
+    double p50_ms = -1.0;
+    double p90_ms = -1.0;
+    double p99_ms = -1.0;
+};
+
 struct WebSocketStatus {
     bool listening = false;
     std::string address;
     std::string last_message;
     double uptime_seconds = -1.0;
+    // Unix time the service became reachable, or -1; clients derive the
+    // uptime from it between status versions.
+    double up_since_epoch_seconds = -1.0;
+    bool reachable = false;
+    std::string probe_error;
+    double connect_ms = -1.0;
+    double round_trip_ms = -1.0;
+    LatencySummary connect_latency;
+    LatencySummary round_trip_latency;
+    std::uint64_t probes = 0;
+    std::uint64_t probe_failures = 0;
 };
 
 struct BatteryStatus {
@@ -28,11 +50,20 @@ struct DebianStatus {
     double uptime_seconds = 0.0;
     std::string uptime_human;
     std::string boot_time_iso;
+    long long boot_epoch_seconds = -1;  // Unix time of the boot, from btime in /proc/stat.
     double load_average[3] = {0.0, 0.0, 0.0};
 };
 
+struct ListeningSocket {
+    std::uint16_t port = 0;
+    std::uint64_t inode = 0;
+    int pid = -1;
+    std::string command;
+};
+
 struct NetworkStatus {
     std::vector<std::uint16_t> listening_ports;
+    std::vector<ListeningSocket> listening_sockets;
 };
 
 struct SystemStatusSnapshot {
@@ -41,9 +72,22 @@ struct SystemStatusSnapshot {
     BatteryStatus battery;
     DebianStatus debian;
     NetworkStatus network;
+    std::vector<ActiveAlert> alerts;
     std::string generated_at_iso;
 };
 
 SystemStatusSnapshot collect_system_status();
-std::string system_status_to_json(const SystemStatusSnapshot& status);
+// The dial service that places calls: BEAVER_WS_ADDRESS, else
+// ws://<BEAVER_WS_HOST or localhost>:<BEAVER_WS_PORT or 5001>.
+std::string dial_service_address();
+// Port of the HTTP server in this process, 0 when there is none. With no
+// BEAVER_WS_* variable set, the status probe then checks the server's own /ws
+// endpoint instead of the dial service on port 5001.
+void set_status_http_port(std::uint16_t port);
+// Appends the snapshot's JSON document to `out`; the string can be reused
+// across calls to avoid reallocating on every sample.
+void append_system_status_json(std::string& out, const SystemStatusSnapshot& status,
+                               JsonStyle style = JsonStyle::kPretty);
+std::string system_status_to_json(const SystemStatusSnapshot& status,
+                                  JsonStyle style = JsonStyle::kPretty);
 
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Escaping kernels shared by the HTML renderer and JsonWriter. Both scan the
+// input 32 bytes at a time with AVX2 (when the CPU has it), 16 at a time with
+// SSE2 otherwise, or through a lookup table on other architectures. Clean runs
+// are appended to `out` in one copy; only the rare special characters take the
+// slow path. `out` is appended to, never cleared, so callers can reuse it.
+
+// Escapes & < > " ' as HTML entities.
+void append_html_escaped(std::string& out, std::string_view text);
+
+// Escapes " \ and control characters for use inside a JSON string literal.
+void append_json_escaped(std::string& out, std::string_view text);
+
+std::string html_escape(std::string_view text);
+
+// Appends a serialized JSON document for inline use in a <script> element,
+// with < > & written as \u003c \u003e \u0026. They can only occur inside
+// strings, which may hold text any local user controls (process command
+// lines), and a raw "</script>" would otherwise end the element early.
+void append_json_for_script(std::string& out, std::string_view json);
+
+// Name of the kernel selected for this CPU ("avx2", "sse2" or "scalar").
+const char* text_escape_kernel_name();
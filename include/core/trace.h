@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Scoped spans recorded as Chrome trace events (chrome://tracing, Perfetto).
+// Each thread appends finished spans to its own ring of recent events; a dump
+// collects the events of every thread that ended after a given time. Tracing
+// is off unless a capture is running, and a span then costs one relaxed load
+// and a branch.
+
+namespace trace_internal {
+inline std::atomic<int> active_captures{0};
+}  // namespace trace_internal
+
+inline bool tracing_enabled() {
+    return trace_internal::active_captures.load(std::memory_order_relaxed) > 0;
+}
+
+// Captures nest: tracing stays on until every start has been matched by a stop.
+void start_tracing();
+void stop_tracing();
+
+// {"traceEvents":[...]} with the spans that ended at or after `since`.
+std::string trace_events_json(std::chrono::steady_clock::time_point since);
+
+// BEAVER_TRACE=1 traces from startup. The signal (SIGUSR2 by default) starts a
+// capture, and the next one writes it to logs/trace-<time>.json.
+void install_trace_controls(int signal_number);
+
+// Names are "category.event" string literals. `detail` (e.g. the request path)
+// is copied when the span ends, so it only has to outlive the span.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::string_view detail = {}) {
+        if (tracing_enabled()) {
+            begin(name, detail);
+        }
+    }
+    ~TraceSpan() {
+        if (name_ != nullptr) {
+            end();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // For spans that start before their detail is known.
+    void set_detail(std::string_view detail) { detail_ = detail; }
+
+private:
+    void begin(const char* name, std::string_view detail);
+    void end();
+
+    const char* name_ = nullptr;
+    std::string_view detail_;
+    std::int64_t start_ns_ = 0;
+};
@@ -8,14 +8,16 @@
 
 class TranslationCatalog {
 public:
-    explicit TranslationCatalog(std::string locales_directory);
+    // Reads <locales_root>/<code>/strings.txt through find_resource(), so
+    // `locales_root` is a resource path ("locales"), not a directory.
+    explicit TranslationCatalog(std::string locales_root);
 
     std::string translate(const std::string& key, Language language) const;
 
 private:
     using TranslationMap = std::unordered_map<std::string, std::string>;
 
-    static TranslationMap load_language_file(const std::string& locales_directory,
+    static TranslationMap load_language_file(const std::string& locales_root,
                                              const std::string& language_code);
     static std::string trim(const std::string& text);
 
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// The parts of an absolute URI the core needs. Stands in for g_uri_parse()
+// with G_URI_FLAGS_NONE so the core builds without GLib.
+struct UriParts {
+    std::string scheme;  // Lowercased.
+    std::string host;    // Empty without an authority ("file:/x", "mailto:a@b").
+    int port = -1;       // -1 when the URI has none.
+};
+
+// False for relative references and malformed URIs (bad scheme, bad port).
+bool parse_uri(std::string_view uri, UriParts& parts);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/system_status.h"
+
+// User-Agent sent by probe_websocket_endpoint(), so a server probing its own
+// /ws endpoint can tell the probe from real clients.
+inline constexpr std::string_view kWebSocketProbeUserAgent = "BeaverKiosk-probe";
+
+struct WebSocketEndpoint {
+    std::string host;
+    std::uint16_t port = 0;
+    std::string path = "/";
+    bool secure = false;
+};
+
+struct WebSocketProbeResult {
+    bool connected = false;
+    bool handshake_ok = false;
+    bool pong_received = false;
+    double connect_ms = -1.0;
+    double round_trip_ms = -1.0;
+    std::string error;
+    std::string message;
+};
+
+// Parses ws://host[:port][/path]. wss:// is recognised but cannot be probed
+// without TLS support.
+std::optional<WebSocketEndpoint> parse_websocket_address(const std::string& address);
+
+// Connects without blocking past `timeout`, performs the RFC 6455 handshake and a
+// ping/pong exchange, then closes the connection. Text frames received along the
+// way are reported in `message`.
+WebSocketProbeResult probe_websocket_endpoint(const WebSocketEndpoint& endpoint,
+                                              std::chrono::milliseconds timeout);
+
+// Connects, performs the handshake, sends `text` as one masked text frame and
+// closes the connection, all within `timeout`. Returns an empty string once the
+// frame was sent, otherwise what failed.
+std::string send_websocket_text(const WebSocketEndpoint& endpoint, std::string_view text,
+                                std::chrono::milliseconds timeout);
+
+// Probe results kept for reporting: latency percentiles over the last
+// `history_size` probes, the last text message seen and how long the service
+// has been continuously reachable.
+class WebSocketProbeHistory {
+public:
+    explicit WebSocketProbeHistory(std::size_t history_size = 64);
+
+    void record(const WebSocketProbeResult& result, std::chrono::steady_clock::time_point now);
+    // Fills the probe fields of `status`; uptime is measured up to `now`.
+    void fill(WebSocketStatus& status, std::chrono::steady_clock::time_point now) const;
+
+    static LatencySummary summarize(const std::vector<double>& samples);
+
+private:
+    std::size_t history_size_;
+    std::optional<std::chrono::steady_clock::time_point> up_since_;
+    std::chrono::system_clock::time_point up_since_wall_;  // Reported to clients.
+    WebSocketProbeResult last_result_;
+    std::string last_message_;
+    std::vector<double> connect_samples_;
+    std::vector<double> round_trip_samples_;
+    std::size_t next_connect_sample_ = 0;
+    std::size_t next_round_trip_sample_ = 0;
+    std::uint64_t probes_ = 0;
+    std::uint64_t failures_ = 0;
+};
+
+// Probes the address last passed to update() on a thread of its own, every
+// `interval`, and only while update() keeps being called. update() copies the
+// cached results and never waits on the network, so a slow DNS lookup or a
+// blackholed endpoint cannot stall collect_system_status() on the accept
+// thread. getaddrinfo() ignores `timeout`; only the probe thread waits on it.
+class WebSocketProbe {
+public:
+    explicit WebSocketProbe(std::size_t history_size = 64,
+                            std::chrono::milliseconds interval = std::chrono::seconds(1),
+                            std::chrono::milliseconds timeout = std::chrono::milliseconds(500));
+    ~WebSocketProbe();
+
+    WebSocketProbe(const WebSocketProbe&) = delete;
+    WebSocketProbe& operator=(const WebSocketProbe&) = delete;
+
+    // Switches to `address` (dropping the history when it changed) and fills
+    // the probe fields of `status` from the latest results.
+    void update(const std::string& address, WebSocketStatus& status);
+
+private:
+    void run();
+
+    const std::size_t history_size_;
+    const std::chrono::milliseconds interval_;
+    const std::chrono::milliseconds timeout_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::string address_;
+    WebSocketProbeHistory history_;
+    std::chrono::steady_clock::time_point last_update_;
+    bool stopping_ = false;
+    std::thread worker_;
+};
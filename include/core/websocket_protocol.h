@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// RFC 6455 helpers shared by the WebSocket probe and server code.
+
+enum class WebSocketOpcode : std::uint8_t {
+    kContinuation = 0x0,
+    kText = 0x1,
+    kBinary = 0x2,
+    kClose = 0x8,
+    kPing = 0x9,
+    kPong = 0xA,
+};
+
+struct WebSocketFrameHeader {
+    bool fin = true;
+    WebSocketOpcode opcode = WebSocketOpcode::kText;
+    bool masked = false;
+    std::uint8_t mask[4] = {0, 0, 0, 0};
+    std::uint64_t payload_length = 0;
+    std::size_t header_length = 0;
+};
+
+// Returns std::nullopt until `size` bytes hold a complete frame header.
+std::optional<WebSocketFrameHeader> parse_websocket_frame_header(const char* data,
+                                                                 std::size_t size);
+
+// Appends a single unfragmented frame. Client frames must be masked.
+void append_websocket_frame(std::string& out, WebSocketOpcode opcode, std::string_view payload,
+                            const std::uint8_t* mask = nullptr);
+
+// XORs `size` bytes in place with the frame mask, starting at mask offset `offset`.
+void unmask_websocket_payload(char* data, std::size_t size, const std::uint8_t mask[4],
+                              std::size_t offset = 0);
+
+std::string websocket_accept_key(std::string_view client_key);
+std::string base64_encode(const unsigned char* data, std::size_t size);
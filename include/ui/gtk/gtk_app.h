@@ -6,6 +6,7 @@
 #include <string>
 
 #include "core/app_manager.h"
+#include "core/router.h"
 
 class GtkApp {
 public:
@@ -33,8 +34,7 @@ private:
 
     void build_ui(GtkApplication* application);
     void load_language(WebKitWebView* web_view, Language language);
-    void load_beavertask_page(WebKitWebView* web_view, Language language);
-    void load_beaveralarm_page(WebKitWebView* web_view, Language language);
+    void load_app_page(WebKitWebView* web_view, AppPage page, Language language);
     void ensure_remote_navigation_controls(WebKitWebView* web_view);
     void remove_remote_navigation_controls(WebKitWebView* web_view);
     void handle_remote_go_home();
@@ -42,6 +42,7 @@ private:
     GtkWindow* resolve_parent_window() const;
 
     AppManager& manager_;
+    Router<AppPage> page_router_;
     WebKitWebView* web_view_ = nullptr;
     GtkWidget* overlay_root_ = nullptr;
 };
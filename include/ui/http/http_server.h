@@ -1,10 +1,38 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
+#include "core/alloc_stats.h"
 #include "core/app_manager.h"
+#include "core/metrics.h"
+#include "core/process_scanner.h"
+#include "core/router.h"
+#include "core/status_sampler.h"
 #include "ui/http/http_utils.h"
+#include "ui/http/sse_broadcaster.h"
+#include "ui/http/traffic_capture.h"
+#include "ui/http/websocket_hub.h"
+
+// Everything a route handler needs to answer one request.
+struct HttpRouteContext {
+    int client_socket;
+    const HttpRequest& request;
+    const std::map<std::string, std::string>& query;
+    const RouteParams& params;
+    Language language;
+    HttpResponse& response;
+    // Set when the handler handed the socket over (SSE, WebSocket); no response
+    // is written and the socket is left open.
+    bool detached = false;
+};
+
+using HttpRouteHandler = std::function<void(HttpRouteContext&)>;
 
 class HttpServerApp {
 public:
@@ -14,12 +42,49 @@ public:
     int run();
     void stop();
 
+    // Replaces the handler for {type:'dial'} messages received on /ws.
+    void set_dial_handler(DialHandler handler);
+
 private:
+    // Request metrics of one route. The series for a status code is registered
+    // with the first response carrying it; only the accept thread touches these.
+    struct RouteMetrics {
+        std::string route;
+        Counter* response_bytes = nullptr;
+        // Registered once allocation accounting is on.
+        Counter* allocations = nullptr;
+        Counter* allocated_bytes = nullptr;
+        std::array<Histogram*, 500> duration_by_status{};  // Indexed by status - 100.
+    };
+
+    void register_routes();
+    // /debug/trace and /debug/profile; see debug_endpoints_enabled().
+    void register_debug_routes();
     void handle_request(int client_socket);
-    std::string read_file(const std::string& filepath) const;
+    // Records a finished request in the access log and the route's metrics.
+    void record_request(const HttpRequest& request, std::size_t route_index, int status,
+                        std::size_t bytes, std::chrono::steady_clock::time_point started,
+                        const AllocationCounts& allocations);
+    void serve_public_asset(HttpRouteContext& context, const std::string& directory,
+                            const char* not_found_message) const;
+    // Answers with a bundled resource (core/resource_bundle.h): 304 when
+    // If-None-Match carries its hash, the gzip copy when the client takes it.
+    void serve_resource(HttpRouteContext& context, const std::string& path,
+                        const char* not_found_message) const;
     bool setup_socket();
 
     AppManager& manager_;
+    ProcessScanner process_scanner_;
+    StatusSampler status_sampler_;
+    SseBroadcaster sse_broadcaster_;
+    WebSocketHub websocket_hub_;
+    Router<HttpRouteHandler> router_;
+    std::vector<RouteMetrics> route_metrics_;  // One per route, then unmatched requests.
+    Gauge& active_requests_;
+    CacheMetrics status_cache_;
+    // Started by BEAVER_CAPTURE; only answered requests are recorded, not
+    // streams or WebSocket upgrades.
+    TrafficCapture traffic_capture_;
     int port_;
     int server_socket_;
     std::atomic<bool> running_;
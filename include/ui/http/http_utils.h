@@ -27,3 +27,5 @@ std::string build_http_response(const HttpResponse& response);
 std::string get_mime_type(const std::string& path);
 std::string url_decode(const std::string& str);
 std::map<std::string, std::string> parse_query_parameters(const std::string& query);
+// Case-insensitive header lookup; returns an empty string when absent.
+std::string find_http_header(const HttpRequest& request, const std::string& name);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+// Blocking IPv4 connection to 127.0.0.1:`port` with a 10 s receive timeout,
+// or -1. Used by the in-process soak and self-bench drivers.
+int connect_loopback(int port);
+
+// One GET over a fresh connection, reading the response to the end. Returns
+// the status code, or 0 on I/O errors.
+int loopback_get(int port, const std::string& path);
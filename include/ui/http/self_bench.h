@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "core/app_manager.h"
+
+struct SelfBenchConfig {
+    // Time spent measuring each subsystem, after a short warm-up.
+    std::chrono::milliseconds time_per_subsystem{500};
+    int port = 5000;
+    std::string report_path = "logs/self-bench.json";
+};
+
+// BEAVER_SELF_BENCH_MS and BEAVER_SELF_BENCH_REPORT on top of the defaults.
+SelfBenchConfig self_bench_config_from_environment();
+
+// Runs the same fixed workload on any kiosk so results can be compared across
+// the fleet: every page rendered in both languages, status serialization,
+// request parsing, translation loading and a short loopback HTTP run against
+// HttpServerApp on `config.port`. Prints the CPU model and frequency and a
+// score per subsystem (1000 is the reference machine, higher is faster), and
+// writes the report as JSON. Returns 0, or 1 when the HTTP run failed.
+int run_self_bench(AppManager& manager, const SelfBenchConfig& config);
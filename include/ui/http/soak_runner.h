@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "core/app_manager.h"
+#include "core/resource_monitor.h"
+
+struct SoakConfig {
+    std::chrono::seconds duration{std::chrono::hours(1)};
+    // 0 picks about 60 samples over the run, at least one a second.
+    std::chrono::seconds sample_interval{0};
+    // Loopback requests per second; 0 sends them back to back.
+    double request_rate = 200.0;
+    int port = 5000;
+    ResourceBudgets budgets;
+    std::string report_path = "logs/soak-report.json";
+};
+
+// Budgets from resource_budgets_from_environment(), BEAVER_SOAK_RATE and
+// BEAVER_SOAK_REPORT on top of the defaults.
+SoakConfig soak_config_from_environment();
+
+// "90s", "45m", "8h" or plain seconds.
+bool parse_soak_duration(std::string_view text, std::chrono::seconds& duration);
+
+// Runs HttpServerApp on `config.port` and, for `config.duration`, drives it
+// with loopback requests for every page, API and asset route while replaying
+// the GTK shell's navigation handlers (route matching, navigation history,
+// menu and app page renders) headlessly through `manager`. Process resources
+// are sampled throughout; the report lists each resource's growth and
+// per-request estimate and is also written as JSON. Returns 0 when every
+// resource stayed within budget, 1 otherwise.
+int run_soak(AppManager& manager, const SoakConfig& config);
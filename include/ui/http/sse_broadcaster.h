@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/metrics.h"
+#include "core/status_sampler.h"
+
+// Pushes status updates published by the sampler to Server-Sent Events
+// subscribers. The event id is the status version token: a new subscriber (or one
+// reconnecting with Last-Event-ID) first receives a delta or full resync from
+// the sampler, then the delta of each new version, formatted once into a shared
+// frame. Slow clients only ever hold one unsent frame, which is recomputed from
+// the version they actually received, so a stalled subscriber cannot grow memory
+// or delay the others.
+class SseBroadcaster {
+public:
+    explicit SseBroadcaster(StatusSampler& sampler,
+                            std::chrono::seconds heartbeat_interval = std::chrono::seconds(15),
+                            std::size_t max_subscribers = 64);
+    ~SseBroadcaster();
+
+    SseBroadcaster(const SseBroadcaster&) = delete;
+    SseBroadcaster& operator=(const SseBroadcaster&) = delete;
+
+    void start();
+    void stop();
+
+    // Sends the event-stream response headers and whatever a client holding
+    // `since` needs to catch up, then takes ownership of the socket. Returns
+    // false (socket untouched) when full.
+    bool add_subscriber(int client_socket, std::uint64_t since = 0);
+    std::size_t subscriber_count() const;
+
+private:
+    struct Subscriber {
+        int socket = -1;
+        std::shared_ptr<const std::string> pending;
+        std::size_t offset = 0;
+        std::uint64_t pending_version = 0;  // Status version carried by `pending`, 0 if none.
+        std::uint64_t version = 0;          // Last status version fully written.
+    };
+
+    void run();
+    std::shared_ptr<const std::string> frame_since(std::uint64_t version);
+    bool queue_latest(Subscriber& subscriber);
+    std::shared_ptr<const std::string> build_event_frame(std::uint64_t version,
+                                                         std::string_view payload) const;
+    static bool flush(Subscriber& subscriber);
+    void drop_closed_subscribers();
+
+    StatusSampler& sampler_;
+    std::chrono::seconds heartbeat_interval_;
+    std::size_t max_subscribers_;
+    mutable std::mutex mutex_;
+    std::vector<Subscriber> subscribers_;
+    std::uint64_t latest_version_ = 0;
+    std::shared_ptr<const std::string> latest_delta_frame_;
+    std::unordered_map<std::uint64_t, std::shared_ptr<const std::string>> catch_up_frames_;
+    Gauge& subscriber_gauge_;
+    CacheMetrics frame_cache_;
+    bool running_ = false;
+    std::thread thread_;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "core/app_manager.h"
+
+// Writes everything HttpServerApp answers the same way on every request into
+// `directory`, for nginx or a CDN to serve in front of the live server:
+//
+//   css/, icons/, contact/  public/ under both its plain and fingerprinted
+//                           names ("css/styles.3f9a1c2b.css")
+//   http/<lang>/            pages as served over HTTP ("/" is index.html,
+//                           "/apps/beaverphone" is apps/beaverphone.html) and
+//                           api/menu.json
+//   manifest.json           every file with its route, language, content
+//                           type, size and content hash
+//
+// <lang> is "fr" or "en", the values of ?lang=. Pages and the menu refer to
+// assets by their fingerprinted names, so those can be cached forever. Each
+// file gets a `gzip -9` copy next to it (file.gz, for gzip_static) when that
+// is smaller. Pages that embed live data (BeaverSystem) are not exported and
+// are listed under "live" in the manifest. Kiosk pages are not exported: the
+// GTK shell renders them itself and handles their relative links. The output only depends on the
+// build and the URL options, so two exports of one build are identical.
+// Returns 0, or 1 when a file could not be written.
+int run_static_export(const AppManager& manager, const std::string& directory);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Capture files hold the requests HttpServerApp answered, in arrival order, so
+// a bench machine can replay real kiosk traffic. All integers are
+// little-endian:
+//
+//   header  "BVRCAP01"  u64 capture start (Unix time, µs)
+//   record  u64 arrival (µs after start)  u32 latency (µs)  u32 response bytes
+//           u16 status  u16 reserved  u32 request length  request bytes
+struct CapturedRequest {
+    std::uint64_t offset_us = 0;
+    std::uint32_t latency_us = 0;
+    std::uint32_t response_bytes = 0;
+    std::uint16_t status = 0;
+    std::string request;  // Raw bytes as read from the socket.
+};
+
+// BEAVER_CAPTURE=<path>; empty while capture is off.
+std::string traffic_capture_path_from_environment();
+
+// Appends records to an in-memory batch that a background thread writes out
+// every half second (or once 64 KiB are pending), so the accept loop never
+// waits on the disk. Past 16 MiB of unwritten records, new ones are dropped
+// and counted.
+class TrafficCapture {
+public:
+    TrafficCapture() = default;
+    ~TrafficCapture();
+
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    // Creates (truncates) the file and writes the header.
+    bool start(const std::string& path);
+    // Writes what is pending, then closes the file.
+    void stop();
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    void record(std::chrono::steady_clock::time_point received, std::string_view raw_request,
+                int status, std::size_t response_bytes,
+                std::chrono::steady_clock::duration latency);
+
+    std::uint64_t recorded() const { return recorded_.load(std::memory_order_relaxed); }
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    std::atomic<bool> running_{false};
+    std::chrono::steady_clock::time_point started_;
+    int fd_ = -1;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::string pending_;
+    std::uint64_t pending_records_ = 0;
+    std::thread thread_;
+
+    std::atomic<std::uint64_t> recorded_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+// Reads a capture file record by record.
+class CaptureReader {
+public:
+    // False if the file cannot be read or is not a capture file.
+    bool open(const std::string& path);
+    std::uint64_t start_unix_us() const { return start_unix_us_; }
+    // False at the end of the file or on a truncated record.
+    bool next(CapturedRequest& request);
+
+private:
+    std::ifstream file_;
+    std::uint64_t start_unix_us_ = 0;
+};
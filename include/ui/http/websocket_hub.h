@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/metrics.h"
+#include "core/status_sampler.h"
+#include "ui/http/http_utils.h"
+
+struct DialRequest {
+    std::string number;
+    std::string source;
+};
+
+struct DialResult {
+    bool accepted = false;
+    std::string message;
+};
+
+using DialHandler = std::function<DialResult(const DialRequest& request)>;
+
+// Serves WebSocket connections upgraded by HttpServerApp on a single poll() loop.
+// Incoming frames are parsed and unmasked in place in the connection's read
+// buffer; only fragmented messages are copied. Unmasked frames, fragmented or
+// oversized control frames, and a new message inside a fragmented one close
+// the connection with 1002. Clients send JSON messages:
+//   {"type":"dial","number":"...","source":"..."}   -> DialHandler, dial-result reply
+//   {"type":"subscribe","topic":"status","since":"<epoch>-N"}
+//                                                    -> status updates (see StatusSampler)
+//   {"type":"unsubscribe","topic":"status"}
+// Subscribers first get a delta or full resync from `since`, then the delta of
+// each new version, framed once and shared by all subscribers that are up to
+// date. An unsent status frame is replaced by one computed from the version the
+// connection already has, and a connection whose send queue exceeds the byte
+// budget is dropped. The dial handler runs on a thread of its own, one request
+// at a time, so a handler that waits on the network never stalls the poll
+// loop; its dial-result is sent once it returns.
+class WebSocketHub {
+public:
+    explicit WebSocketHub(StatusSampler& sampler, std::size_t max_connections = 64,
+                          std::size_t max_queued_bytes = 1024 * 1024);
+    ~WebSocketHub();
+
+    WebSocketHub(const WebSocketHub&) = delete;
+    WebSocketHub& operator=(const WebSocketHub&) = delete;
+
+    void start();
+    void stop();
+
+    // Must be set before start().
+    void set_dial_handler(DialHandler handler);
+
+    // Validates an upgrade request, sends the 101 response and takes ownership of
+    // the socket. Returns false, leaving the socket to the caller, when the
+    // request is not a valid RFC 6455 upgrade or the hub is full.
+    bool accept_upgrade(int client_socket, const HttpRequest& request);
+
+private:
+    struct Connection {
+        std::uint64_t id = 0;
+        int socket = -1;
+        std::string input;
+        std::string fragments;
+        bool fragmented = false;
+        std::deque<std::shared_ptr<const std::string>> output;
+        std::size_t output_offset = 0;
+        std::size_t queued_bytes = 0;
+        // Latest status frame not yet handed to `output`; a newer version replaces it.
+        std::shared_ptr<const std::string> pending_status;
+        std::uint64_t pending_status_version = 0;
+        std::uint64_t status_version = 0;  // Last status version handed to `output`.
+        bool status_subscriber = false;
+        bool closing = false;
+        bool ping_outstanding = false;
+        std::chrono::steady_clock::time_point last_activity;
+    };
+
+    struct PendingDial {
+        std::uint64_t connection_id = 0;
+        DialRequest request;
+    };
+
+    void run();
+    void run_dials();
+    void wake();
+    void adopt_incoming();
+    void deliver_dial_results();
+    void broadcast_status();
+    void queue_status_since(Connection& connection, std::uint64_t version);
+    void read_from(Connection& connection);
+    void process_frames(Connection& connection);
+    void handle_message(Connection& connection, std::string_view message);
+    void handle_dial(Connection& connection, std::string_view message);
+    void queue(Connection& connection, std::shared_ptr<const std::string> frame);
+    void queue_text(Connection& connection, std::string_view text);
+    void queue_close(Connection& connection, std::uint16_t code);
+    void flush(Connection& connection);
+    void close_connection(Connection& connection);
+
+    StatusSampler& sampler_;
+    std::size_t max_connections_;
+    std::size_t max_queued_bytes_;
+    DialHandler dial_handler_;
+    int wake_fd_ = -1;
+    std::thread thread_;
+    std::thread dial_thread_;
+    std::mutex mutex_;
+    std::condition_variable dial_ready_;
+    bool running_ = false;
+    std::vector<int> incoming_;
+    std::deque<PendingDial> pending_dials_;
+    // (connection id, dial-result message) pairs for the poll loop to send.
+    std::vector<std::pair<std::uint64_t, std::string>> dial_results_;
+    std::uint64_t next_connection_id_ = 0;
+    std::size_t connection_count_ = 0;
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::uint64_t status_version_ = 0;
+    std::shared_ptr<const std::string> status_delta_frame_;
+    std::unordered_map<std::uint64_t, std::shared_ptr<const std::string>> catch_up_frames_;
+    Gauge& connection_gauge_;
+    CacheMetrics frame_cache_;
+};
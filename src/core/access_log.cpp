@@ -0,0 +1,474 @@
+#include "core/access_log.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+
+#include "core/json_writer.h"
+#include "core/log.h"
+
+namespace {
+
+enum class RecordKind : std::uint8_t {
+    kRequest,
+    kRender,
+};
+
+template <std::size_t N>
+void copy_truncated(char (&destination)[N], std::string_view source) {
+    std::size_t length = std::min(source.size(), N - 1);
+    // Do not cut a UTF-8 sequence in half.
+    while (length < source.size() && length > 0 &&
+           (static_cast<unsigned char>(source[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    std::memcpy(destination, source.data(), length);
+    destination[length] = '\0';
+}
+
+std::uint32_t clamp_u32(std::uint64_t value) {
+    return static_cast<std::uint32_t>(std::min<std::uint64_t>(value, UINT32_MAX));
+}
+
+std::int64_t now_microseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string format_timestamp(std::int64_t microseconds) {
+    const std::time_t seconds = static_cast<std::time_t>(microseconds / 1000000);
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+    char formatted[40];
+    std::size_t length = std::strftime(formatted, sizeof(formatted), "%Y-%m-%d %H:%M:%S", &tm);
+    length += static_cast<std::size_t>(std::snprintf(formatted + length,
+                                                     sizeof(formatted) - length, ".%03d",
+                                                     static_cast<int>(microseconds / 1000 % 1000)));
+    return std::string(formatted, length);
+}
+
+std::uint64_t parse_unsigned_env(const char* name, std::uint64_t fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const unsigned long long parsed = std::strtoull(value, &end, 10);
+    if (end == value || *end != '\0') {
+        log_warning("Ignoring invalid %s=%s", name, value);
+        return fallback;
+    }
+    return parsed;
+}
+
+}  // namespace
+
+struct AccessLog::Record {
+    std::int64_t timestamp_us = 0;
+    std::uint32_t latency_us = 0;
+    std::uint32_t bytes = 0;
+    std::uint16_t status = 0;
+    std::uint16_t worker = 0;
+    RecordKind kind = RecordKind::kRequest;
+    LogLevel level = LogLevel::kInfo;
+    char tag[10] = {};  // Request method, or the render language.
+    char target[100] = {};  // Request path, or the rendered page.
+};
+
+// Single-producer/single-consumer ring. Only the owning thread pushes; only the
+// writer thread pops.
+class AccessLog::Ring {
+public:
+    static constexpr std::size_t kCapacity = 1024;
+
+    explicit Ring(std::uint16_t worker) : worker_(worker) {}
+
+    std::uint16_t worker() const { return worker_; }
+
+    bool should_sample(std::uint32_t every) { return every <= 1 || sample_counter_++ % every == 0; }
+
+    void push(const Record& record) {
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        records_[head % kCapacity] = record;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    template <typename Consumer>
+    void drain(Consumer&& consume) {
+        const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const std::uint64_t head = head_.load(std::memory_order_acquire);
+        for (std::uint64_t i = tail; i < head; ++i) {
+            consume(records_[i % kCapacity]);
+        }
+        tail_.store(head, std::memory_order_release);
+    }
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    void orphan() { orphaned_.store(true, std::memory_order_release); }
+    bool orphaned() const { return orphaned_.load(std::memory_order_acquire); }
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<Record, kCapacity> records_;
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<bool> orphaned_{false};
+    std::uint32_t sample_counter_ = 0;
+    std::uint16_t worker_;
+};
+
+namespace {
+
+// Hands the thread's ring back to the writer when the thread exits, so the
+// writer can drain and release it.
+struct ThreadRing {
+    const AccessLog* owner = nullptr;
+    std::shared_ptr<AccessLog::Ring> ring;
+
+    ~ThreadRing() {
+        if (ring) {
+            ring->orphan();
+        }
+    }
+};
+
+thread_local ThreadRing t_ring;
+
+}  // namespace
+
+const char* log_level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::kDebug:
+            return "debug";
+        case LogLevel::kInfo:
+            return "info";
+        case LogLevel::kWarning:
+            return "warning";
+        case LogLevel::kError:
+        default:
+            return "error";
+    }
+}
+
+bool parse_log_level(std::string_view text, LogLevel& level) {
+    for (LogLevel candidate :
+         {LogLevel::kDebug, LogLevel::kInfo, LogLevel::kWarning, LogLevel::kError}) {
+        if (text == log_level_name(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+AccessLogConfig access_log_config_from_environment() {
+    AccessLogConfig config;
+    if (const char* path = std::getenv("BEAVER_ACCESS_LOG"); path && *path) {
+        config.path = path;
+    }
+    if (const char* level = std::getenv("BEAVER_LOG_LEVEL"); level && *level) {
+        if (!parse_log_level(level, config.min_level)) {
+            log_warning("Ignoring unknown BEAVER_LOG_LEVEL=%s", level);
+        }
+    }
+    config.sample_every = std::max<std::uint32_t>(
+        1, clamp_u32(parse_unsigned_env("BEAVER_LOG_SAMPLE", config.sample_every)));
+    config.max_file_bytes =
+        parse_unsigned_env("BEAVER_ACCESS_LOG_MAX_BYTES", config.max_file_bytes);
+    config.max_files = static_cast<std::size_t>(
+        parse_unsigned_env("BEAVER_ACCESS_LOG_FILES", config.max_files));
+    return config;
+}
+
+AccessLog::AccessLog() = default;
+
+AccessLog::~AccessLog() {
+    stop();
+}
+
+void AccessLog::start(AccessLogConfig config) {
+    if (running()) {
+        return;
+    }
+    config_ = std::move(config);
+    min_level_.store(static_cast<std::uint8_t>(config_.min_level), std::memory_order_relaxed);
+    sample_every_.store(std::max<std::uint32_t>(1, config_.sample_every),
+                        std::memory_order_relaxed);
+    open_file();
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&AccessLog::run, this);
+}
+
+void AccessLog::stop() {
+    if (!running()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_.store(false, std::memory_order_release);
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+AccessLog::Ring* AccessLog::thread_ring() {
+    if (t_ring.owner == this && t_ring.ring) {
+        return t_ring.ring.get();
+    }
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    auto ring = std::make_shared<Ring>(next_worker_++);
+    rings_.push_back(ring);
+    if (t_ring.ring) {
+        t_ring.ring->orphan();
+    }
+    t_ring.owner = this;
+    t_ring.ring = std::move(ring);
+    return t_ring.ring.get();
+}
+
+bool AccessLog::admit(LogLevel level, Ring*& ring) {
+    if (!running() ||
+        static_cast<std::uint8_t>(level) < min_level_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    ring = thread_ring();
+    if (level <= LogLevel::kInfo &&
+        !ring->should_sample(sample_every_.load(std::memory_order_relaxed))) {
+        return false;
+    }
+    return true;
+}
+
+void AccessLog::log_request(std::string_view method, std::string_view path, int status,
+                            std::size_t bytes, std::chrono::microseconds latency) {
+    const LogLevel level = status >= 500   ? LogLevel::kError
+                           : status >= 400 ? LogLevel::kWarning
+                                           : LogLevel::kInfo;
+    Ring* ring = nullptr;
+    if (!admit(level, ring)) {
+        return;
+    }
+    Record record;
+    record.timestamp_us = now_microseconds();
+    record.latency_us =
+        clamp_u32(static_cast<std::uint64_t>(std::max<std::int64_t>(0, latency.count())));
+    record.bytes = clamp_u32(bytes);
+    record.status = static_cast<std::uint16_t>(std::clamp(status, 0, 999));
+    record.worker = ring->worker();
+    record.kind = RecordKind::kRequest;
+    record.level = level;
+    copy_truncated(record.tag, method);
+    copy_truncated(record.target, path);
+    ring->push(record);
+}
+
+void AccessLog::log_render(std::string_view page, std::string_view language, std::size_t bytes,
+                           std::chrono::microseconds elapsed) {
+    Ring* ring = nullptr;
+    if (!admit(LogLevel::kDebug, ring)) {
+        return;
+    }
+    Record record;
+    record.timestamp_us = now_microseconds();
+    record.latency_us =
+        clamp_u32(static_cast<std::uint64_t>(std::max<std::int64_t>(0, elapsed.count())));
+    record.bytes = clamp_u32(bytes);
+    record.worker = ring->worker();
+    record.kind = RecordKind::kRender;
+    record.level = LogLevel::kDebug;
+    copy_truncated(record.tag, language);
+    copy_truncated(record.target, page);
+    ring->push(record);
+}
+
+AccessLogStats AccessLog::stats() const {
+    AccessLogStats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.rotations = rotations_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    stats.dropped = retired_dropped_;
+    for (const auto& ring : rings_) {
+        stats.dropped += ring->dropped();
+    }
+    return stats;
+}
+
+void AccessLog::run() {
+    std::string batch;
+    for (;;) {
+        const bool keep_running = running();
+        batch.clear();
+        drain(batch);
+        if (!batch.empty()) {
+            write_batch(batch);
+        }
+        if (!keep_running) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait_for(lock, config_.flush_interval, [this] { return !running(); });
+    }
+}
+
+void AccessLog::drain(std::string& batch) {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings = rings_;
+    }
+
+    const std::uint32_t sample_every = sample_every_.load(std::memory_order_relaxed);
+    std::uint64_t dropped = 0;
+    std::uint64_t count = 0;
+    for (const auto& ring : rings) {
+        ring->drain([&](const Record& record) {
+            JsonWriter json(batch, JsonStyle::kCompact);
+            json.begin_object();
+            json.key("ts").string(format_timestamp(record.timestamp_us));
+            json.key("level").string(log_level_name(record.level));
+            if (record.kind == RecordKind::kRequest) {
+                json.key("event").string("request");
+                json.key("method").string(record.tag);
+                json.key("path").string(record.target);
+                json.key("status").number(static_cast<unsigned int>(record.status));
+                json.key("bytes").number(static_cast<unsigned int>(record.bytes));
+                json.key("latencyUs").number(static_cast<unsigned int>(record.latency_us));
+            } else {
+                json.key("event").string("render");
+                json.key("page").string(record.target);
+                json.key("lang").string(record.tag);
+                json.key("bytes").number(static_cast<unsigned int>(record.bytes));
+                json.key("elapsedUs").number(static_cast<unsigned int>(record.latency_us));
+            }
+            json.key("worker").number(static_cast<unsigned int>(record.worker));
+            if (sample_every > 1 && record.level <= LogLevel::kInfo) {
+                json.key("sampleRate").number(sample_every);
+            }
+            json.end_object();
+            batch += '\n';
+            ++count;
+        });
+    }
+
+    // Rings whose thread has exited are released once drained; their drop
+    // counts move to retired_dropped_ so the totals stay stable.
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                    [this](const std::shared_ptr<Ring>& ring) {
+                                        if (!ring->orphaned() || !ring->empty()) {
+                                            return false;
+                                        }
+                                        retired_dropped_ += ring->dropped();
+                                        return true;
+                                    }),
+                     rings_.end());
+        dropped = retired_dropped_;
+        for (const auto& ring : rings_) {
+            dropped += ring->dropped();
+        }
+    }
+
+    if (dropped > reported_dropped_) {
+        const std::uint64_t newly_dropped = dropped - reported_dropped_;
+        reported_dropped_ = dropped;
+        JsonWriter json(batch, JsonStyle::kCompact);
+        json.begin_object();
+        json.key("ts").string(format_timestamp(now_microseconds()));
+        json.key("level").string("warning");
+        json.key("event").string("dropped");
+        json.key("records").number(newly_dropped);
+        json.key("total").number(dropped);
+        json.end_object();
+        batch += '\n';
+        log_warning("Access log buffers overflowed; dropped %llu records (%llu total)",
+                    static_cast<unsigned long long>(newly_dropped),
+                    static_cast<unsigned long long>(dropped));
+    }
+    written_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void AccessLog::write_batch(const std::string& batch) {
+    if (config_.max_file_bytes > 0 && file_bytes_ > 0 &&
+        file_bytes_ + batch.size() > config_.max_file_bytes) {
+        rotate();
+    }
+    const int fd = fd_ >= 0 ? fd_ : STDERR_FILENO;
+    std::size_t offset = 0;
+    while (offset < batch.size()) {
+        const ssize_t written = ::write(fd, batch.data() + offset, batch.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offset += static_cast<std::size_t>(written);
+    }
+    file_bytes_ += offset;
+}
+
+void AccessLog::open_file() {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    const fs::path path(config_.path);
+    if (path.has_parent_path()) {
+        fs::create_directories(path.parent_path(), error);
+    }
+    fd_ = ::open(config_.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        log_warning("Could not open access log %s (%s); logging to stderr", config_.path.c_str(),
+                    std::strerror(errno));
+        file_bytes_ = 0;
+        return;
+    }
+    const off_t size = ::lseek(fd_, 0, SEEK_END);
+    file_bytes_ = size > 0 ? static_cast<std::uint64_t>(size) : 0;
+}
+
+void AccessLog::rotate() {
+    if (fd_ < 0) {
+        return;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    if (config_.max_files == 0) {
+        std::remove(config_.path.c_str());
+    } else {
+        for (std::size_t index = config_.max_files; index > 1; --index) {
+            const std::string from = config_.path + "." + std::to_string(index - 1);
+            const std::string to = config_.path + "." + std::to_string(index);
+            std::rename(from.c_str(), to.c_str());
+        }
+        std::rename(config_.path.c_str(), (config_.path + ".1").c_str());
+    }
+    rotations_.fetch_add(1, std::memory_order_relaxed);
+    open_file();
+}
+
+AccessLog& access_log() {
+    static AccessLog log;
+    return log;
+}
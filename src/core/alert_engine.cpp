@@ -0,0 +1,336 @@
+#include "core/alert_engine.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <utility>
+
+#include "core/log.h"
+
+namespace {
+
+std::optional<AlertComparator> parse_comparator(const std::string& text) {
+    if (text == "<") {
+        return AlertComparator::kLess;
+    }
+    if (text == "<=") {
+        return AlertComparator::kLessEqual;
+    }
+    if (text == ">") {
+        return AlertComparator::kGreater;
+    }
+    if (text == ">=") {
+        return AlertComparator::kGreaterEqual;
+    }
+    if (text == "==") {
+        return AlertComparator::kEqual;
+    }
+    if (text == "!=") {
+        return AlertComparator::kNotEqual;
+    }
+    return std::nullopt;
+}
+
+std::optional<double> parse_number(const std::string& text) {
+    char* end = nullptr;
+    const double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || *end != '\0' || !std::isfinite(value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<std::chrono::seconds> parse_duration(std::string text) {
+    long multiplier = 1;
+    if (!text.empty()) {
+        switch (text.back()) {
+            case 's':
+                text.pop_back();
+                break;
+            case 'm':
+                multiplier = 60;
+                text.pop_back();
+                break;
+            case 'h':
+                multiplier = 3600;
+                text.pop_back();
+                break;
+            default:
+                break;
+        }
+    }
+    const auto value = parse_number(text);
+    if (!value || *value < 0.0) {
+        return std::nullopt;
+    }
+    return std::chrono::seconds(static_cast<long>(*value * multiplier));
+}
+
+bool condition_holds(AlertComparator comparator, double value, double threshold) {
+    switch (comparator) {
+        case AlertComparator::kLess:
+            return value < threshold;
+        case AlertComparator::kLessEqual:
+            return value <= threshold;
+        case AlertComparator::kGreater:
+            return value > threshold;
+        case AlertComparator::kGreaterEqual:
+            return value >= threshold;
+        case AlertComparator::kEqual:
+            return value == threshold;
+        case AlertComparator::kNotEqual:
+            return value != threshold;
+    }
+    return false;
+}
+
+// A firing alert only resolves once the value is `hysteresis` past the threshold,
+// so a metric hovering around the limit does not flap.
+bool condition_cleared(const AlertRule& rule, double value) {
+    switch (rule.comparator) {
+        case AlertComparator::kLess:
+            return value >= rule.threshold + rule.hysteresis;
+        case AlertComparator::kLessEqual:
+            return value > rule.threshold + rule.hysteresis;
+        case AlertComparator::kGreater:
+            return value <= rule.threshold - rule.hysteresis;
+        case AlertComparator::kGreaterEqual:
+            return value < rule.threshold - rule.hysteresis;
+        case AlertComparator::kEqual:
+        case AlertComparator::kNotEqual:
+            return !condition_holds(rule.comparator, value, rule.threshold);
+    }
+    return true;
+}
+
+}  // namespace
+
+const char* alert_comparator_symbol(AlertComparator comparator) {
+    switch (comparator) {
+        case AlertComparator::kLess:
+            return "<";
+        case AlertComparator::kLessEqual:
+            return "<=";
+        case AlertComparator::kGreater:
+            return ">";
+        case AlertComparator::kGreaterEqual:
+            return ">=";
+        case AlertComparator::kEqual:
+            return "==";
+        case AlertComparator::kNotEqual:
+            return "!=";
+    }
+    return "?";
+}
+
+std::vector<AlertRule> load_alert_rules(const std::string& path) {
+    std::vector<AlertRule> rules;
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        log_message("AlertEngine found no rule file at %s; alerts disabled", path.c_str());
+        return rules;
+    }
+
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        const std::size_t comment_position = line.find('#');
+        if (comment_position != std::string::npos) {
+            line = line.substr(0, comment_position);
+        }
+
+        std::istringstream tokens(line);
+        AlertRule rule;
+        std::string comparator;
+        std::string threshold;
+        if (!(tokens >> rule.name)) {
+            continue;
+        }
+
+        bool valid = static_cast<bool>(tokens >> rule.metric >> comparator >> threshold);
+        if (valid) {
+            const auto parsed_comparator = parse_comparator(comparator);
+            const auto parsed_threshold = parse_number(threshold);
+            valid = parsed_comparator && parsed_threshold;
+            if (valid) {
+                rule.comparator = *parsed_comparator;
+                rule.threshold = *parsed_threshold;
+            }
+        }
+
+        std::string keyword;
+        std::string argument;
+        while (valid && tokens >> keyword) {
+            if (!(tokens >> argument)) {
+                valid = false;
+            } else if (keyword == "for") {
+                const auto duration = parse_duration(argument);
+                valid = duration.has_value();
+                rule.duration = duration.value_or(std::chrono::seconds(0));
+            } else if (keyword == "hysteresis") {
+                const auto hysteresis = parse_number(argument);
+                valid = hysteresis && *hysteresis >= 0.0;
+                rule.hysteresis = hysteresis.value_or(0.0);
+            } else {
+                valid = false;
+            }
+        }
+
+        if (!valid) {
+            log_warning("AlertEngine skipped malformed rule at %s:%zu", path.c_str(), line_number);
+            continue;
+        }
+        rules.push_back(std::move(rule));
+    }
+
+    log_message("AlertEngine loaded %zu rules from %s", rules.size(), path.c_str());
+    return rules;
+}
+
+AlertEngine::AlertEngine(std::vector<AlertRule> rules)
+    : rules_(std::move(rules)), runtime_(rules_.size()) {
+    // Intern metric names first so the string_view keys stay valid.
+    std::unordered_map<std::string, std::size_t> ids;
+    for (const auto& rule : rules_) {
+        if (ids.emplace(rule.metric, metric_names_.size()).second) {
+            metric_names_.push_back(rule.metric);
+        }
+    }
+    rules_by_metric_.resize(metric_names_.size());
+    metric_values_.assign(metric_names_.size(), 0.0);
+    metric_seen_.assign(metric_names_.size(), false);
+    metric_pass_.assign(metric_names_.size(), 0);
+    for (std::size_t id = 0; id < metric_names_.size(); ++id) {
+        metric_ids_.emplace(metric_names_[id], id);
+    }
+    for (std::size_t index = 0; index < rules_.size(); ++index) {
+        rules_by_metric_[ids[rules_[index].metric]].push_back(index);
+    }
+}
+
+std::vector<AlertTransition> AlertEngine::evaluate(const std::vector<MetricSample>& samples,
+                                                   std::chrono::steady_clock::time_point now,
+                                                   std::chrono::system_clock::time_point wall_now) {
+    std::vector<AlertTransition> transitions;
+    ++pass_;
+    sampled_now_.clear();
+    for (const auto& sample : samples) {
+        const auto id_it = metric_ids_.find(sample.metric);
+        if (id_it == metric_ids_.end()) {
+            continue;
+        }
+        const std::size_t id = id_it->second;
+        if (metric_pass_[id] != pass_) {
+            metric_pass_[id] = pass_;
+            sampled_now_.push_back(id);
+        }
+        if (metric_seen_[id] && metric_values_[id] == sample.value) {
+            continue;
+        }
+        metric_seen_[id] = true;
+        metric_values_[id] = sample.value;
+        for (std::size_t index : rules_by_metric_[id]) {
+            evaluate_rule(index, sample.value, now, wall_now, transitions);
+        }
+    }
+
+    // Only metrics sampled last pass can have gone missing in this one.
+    for (std::size_t id : sampled_before_) {
+        if (metric_pass_[id] != pass_ && metric_seen_[id]) {
+            forget_metric(id, transitions);
+        }
+    }
+    sampled_before_.swap(sampled_now_);
+
+    // Pending rules whose metric did not change still fire once their duration elapses.
+    while (!deadlines_.empty() && deadlines_.begin()->first <= now) {
+        const std::size_t index = deadlines_.begin()->second;
+        deadlines_.erase(deadlines_.begin());
+        fire(index, wall_now, transitions);
+    }
+    return transitions;
+}
+
+std::vector<ActiveAlert> AlertEngine::active_alerts() const {
+    std::vector<ActiveAlert> alerts;
+    alerts.reserve(firing_.size());
+    for (std::size_t index : firing_) {
+        const auto& rule = rules_[index];
+        ActiveAlert alert;
+        alert.name = rule.name;
+        alert.metric = rule.metric;
+        alert.comparator = rule.comparator;
+        alert.threshold = rule.threshold;
+        alert.value = runtime_[index].value;
+        alert.since = runtime_[index].firing_since;
+        alerts.push_back(std::move(alert));
+    }
+    return alerts;
+}
+
+void AlertEngine::evaluate_rule(std::size_t index, double value,
+                                std::chrono::steady_clock::time_point now,
+                                std::chrono::system_clock::time_point wall_now,
+                                std::vector<AlertTransition>& transitions) {
+    const auto& rule = rules_[index];
+    auto& runtime = runtime_[index];
+    runtime.value = value;
+
+    switch (runtime.state) {
+        case RuleState::kInactive:
+            if (!condition_holds(rule.comparator, value, rule.threshold)) {
+                return;
+            }
+            if (rule.duration.count() == 0) {
+                fire(index, wall_now, transitions);
+                return;
+            }
+            runtime.state = RuleState::kPending;
+            runtime.pending_since = now;
+            runtime.deadline = deadlines_.emplace(now + rule.duration, index);
+            return;
+        case RuleState::kPending:
+            if (!condition_holds(rule.comparator, value, rule.threshold)) {
+                deadlines_.erase(runtime.deadline);
+                runtime.state = RuleState::kInactive;
+            } else if (now - runtime.pending_since >= rule.duration) {
+                deadlines_.erase(runtime.deadline);
+                fire(index, wall_now, transitions);
+            }
+            return;
+        case RuleState::kFiring:
+            if (condition_cleared(rule, value)) {
+                runtime.state = RuleState::kInactive;
+                firing_.erase(index);
+                transitions.push_back({rule.name, false, value});
+            }
+            return;
+    }
+}
+
+void AlertEngine::fire(std::size_t index, std::chrono::system_clock::time_point wall_now,
+                       std::vector<AlertTransition>& transitions) {
+    auto& runtime = runtime_[index];
+    runtime.state = RuleState::kFiring;
+    runtime.firing_since = wall_now;
+    firing_.insert(index);
+    transitions.push_back({rules_[index].name, true, runtime.value});
+}
+
+// The next sample of the metric starts its rules from scratch.
+void AlertEngine::forget_metric(std::size_t id, std::vector<AlertTransition>& transitions) {
+    metric_seen_[id] = false;
+    for (std::size_t index : rules_by_metric_[id]) {
+        auto& runtime = runtime_[index];
+        if (runtime.state == RuleState::kPending) {
+            deadlines_.erase(runtime.deadline);
+        } else if (runtime.state == RuleState::kFiring) {
+            firing_.erase(index);
+            transitions.push_back({rules_[index].name, false, runtime.value, true});
+        }
+        runtime.state = RuleState::kInactive;
+    }
+}
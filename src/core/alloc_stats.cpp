@@ -0,0 +1,139 @@
+#include "core/alloc_stats.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+// Constant-initialized, so touching it from operator new never allocates.
+thread_local AllocationCounts t_counts;
+
+void count_allocation(std::size_t size) {
+    if (allocation_accounting_enabled()) {
+        ++t_counts.allocations;
+        t_counts.bytes += size;
+    }
+}
+
+void count_free(void* pointer) {
+    if (pointer != nullptr && allocation_accounting_enabled()) {
+        ++t_counts.frees;
+    }
+}
+
+void* allocate(std::size_t size) {
+    count_allocation(size);
+    for (;;) {
+        if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t alignment) {
+    count_allocation(size);
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    for (;;) {
+        if (void* pointer = std::aligned_alloc(align, rounded)) {
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void release(void* pointer) noexcept {
+    count_free(pointer);
+    std::free(pointer);
+}
+
+}  // namespace
+
+void set_allocation_accounting(bool enabled) {
+    alloc_stats_internal::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void allocation_accounting_from_environment() {
+    const char* value = std::getenv("BEAVER_ALLOC_STATS");
+    set_allocation_accounting(value != nullptr && std::strcmp(value, "1") == 0);
+}
+
+AllocationCounts thread_allocation_counts() {
+    return t_counts;
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocate_aligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocate_aligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    release(pointer);
+}
@@ -1,17 +1,69 @@
 #include "core/app_manager.h"
 
 #include <algorithm>
-#include <filesystem>
-#include <sstream>
+#include <chrono>
 
+#include "core/access_log.h"
+#include "core/alloc_stats.h"
+#include "core/json_writer.h"
+#include "core/log.h"
+#include "core/metrics.h"
 #include "core/system_status.h"
+#include "core/trace.h"
+#include "core/uri.h"
 #include "ui/html_renderer.h"
-#include <glib.h>
 
 namespace {
-std::string locale_directory() {
-    namespace fs = std::filesystem;
-    return (fs::current_path() / "locales").string();
+// One page generator, as named in warnings, the access log and /metrics.
+struct RenderTarget {
+    RenderTarget(const char* label, const char* page)
+        : label(label),
+          page(page),
+          duration(metrics().histogram("beaver_render_duration_seconds",
+                                       "Time spent generating a page, by page.",
+                                       {{"page", page}})) {
+        if (allocation_accounting_enabled()) {
+            allocations = &metrics().counter("beaver_render_allocations",
+                                             "Heap allocations made while generating pages.",
+                                             {{"page", page}});
+            allocated_bytes = &metrics().counter("beaver_render_allocated_bytes",
+                                                 "Bytes allocated while generating pages.",
+                                                 {{"page", page}});
+        }
+    }
+
+    const char* label;
+    const char* page;
+    Histogram& duration;
+    // Only registered when allocation accounting was on at the first render.
+    Counter* allocations = nullptr;
+    Counter* allocated_bytes = nullptr;
+};
+
+// Where a render started: the clock and the thread's allocation counters.
+struct RenderStart {
+    std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+    AllocationScope allocations;
+};
+
+// Records a finished page render in the access log and metrics, or warns when
+// the generator produced nothing.
+void report_render(const RenderTarget& target, Language language, const std::string& html,
+                   const RenderStart& started) {
+    const auto elapsed = std::chrono::steady_clock::now() - started.time;
+    target.duration.observe(elapsed);
+    if (target.allocations != nullptr && allocation_accounting_enabled()) {
+        const AllocationCounts counts = started.allocations.elapsed();
+        target.allocations->inc(counts.allocations);
+        target.allocated_bytes->inc(counts.bytes);
+    }
+    if (html.empty()) {
+        log_warning("AppManager generated empty %s HTML for language: %s", target.label,
+                    language_to_string(language));
+        return;
+    }
+    access_log().log_render(target.page, language_to_string(language), html.size(),
+                            std::chrono::duration_cast<std::chrono::microseconds>(elapsed));
 }
 
 std::string extract_origin(const std::string& uri) {
@@ -19,27 +71,22 @@ std::string extract_origin(const std::string& uri) {
         return "";
     }
 
-    GUri* parsed_uri = g_uri_parse(uri.c_str(), G_URI_FLAGS_NONE, nullptr);
-    if (parsed_uri == nullptr) {
+    UriParts parts;
+    if (!parse_uri(uri, parts)) {
         return "";
     }
 
-    const gchar* scheme = g_uri_get_scheme(parsed_uri);
-    const gchar* host = g_uri_get_host(parsed_uri);
-    const gint port = g_uri_get_port(parsed_uri);
-
     std::string origin;
-    if (scheme != nullptr && scheme[0] != '\0' && host != nullptr && host[0] != '\0') {
-        origin.assign(scheme);
+    if (!parts.scheme.empty() && !parts.host.empty()) {
+        origin.assign(parts.scheme);
         origin.append("://");
-        origin.append(host);
-        if (port > 0) {
+        origin.append(parts.host);
+        if (parts.port > 0) {
             origin.push_back(':');
-            origin.append(std::to_string(port));
+            origin.append(std::to_string(parts.port));
         }
     }
 
-    g_uri_unref(parsed_uri);
     return origin;
 }
 
@@ -57,6 +104,18 @@ void normalize_route_entry(RouteEntry& entry) {
 
 }  // namespace
 
+const std::vector<AppPageRoute>& app_page_routes() {
+    static const std::vector<AppPageRoute> routes = {
+        {"/", AppPage::kMenu},
+        {"/index.html", AppPage::kMenu},
+        {"/apps/beaverphone", AppPage::kBeaverPhone},
+        {"/apps/beavertask", AppPage::kBeaverTask},
+        {"/apps/beaveralarm", AppPage::kBeaverAlarm},
+        {"/apps/beaversystem", AppPage::kBeaverSystem},
+    };
+    return routes;
+}
+
 AppManager::AppManager()
     : apps_({
           {"BeaverPhone", "violet", "icons/phone.svg",
@@ -81,9 +140,9 @@ AppManager::AppManager()
            {make_route_entry("https://rgbeavernet.ca/", true),
             make_route_entry("https://rgbeavernet.ca/", true)}}}),
       default_language_(Language::French),
-      translation_catalog_(locale_directory()) {
-    g_message("AppManager initialized with %zu apps. default_language=%s", apps_.size(),
-              language_to_string(default_language_));
+      translation_catalog_("locales") {
+    log_message("AppManager initialized with %zu apps. default_language=%s", apps_.size(),
+                language_to_string(default_language_));
 }
 
 const std::vector<AppTile>& AppManager::get_available_apps() const {
@@ -96,8 +155,8 @@ void AppManager::set_app_routes(const std::string& app_name, const AppRoutes& ro
     });
 
     if (it == apps_.end()) {
-        g_warning("AppManager could not find app named '%s' when attempting to update routes.",
-                  app_name.c_str());
+        log_warning("AppManager could not find app named '%s' when attempting to update routes.",
+                    app_name.c_str());
         return;
     }
 
@@ -105,32 +164,39 @@ void AppManager::set_app_routes(const std::string& app_name, const AppRoutes& ro
     normalize_route_entry(normalized.kiosk);
     normalize_route_entry(normalized.http);
     it->routes = normalized;
-    g_message("AppManager updated routes for '%s'. kiosk=%s http=%s", app_name.c_str(),
-              normalized.kiosk.uri.c_str(), normalized.http.uri.c_str());
+    log_message("AppManager updated routes for '%s'. kiosk=%s http=%s", app_name.c_str(),
+                normalized.kiosk.uri.c_str(), normalized.http.uri.c_str());
 }
 
 void AppManager::record_navigation(const std::string& app_name, MenuRouteMode route_mode) {
     if (!navigation_history_.empty()) {
         const NavigationRecord& previous = navigation_history_.back();
         if (previous.app_name == app_name && previous.route_mode == route_mode) {
-            g_message("AppManager navigation unchanged (app=%s mode=%s).", app_name.c_str(),
+            log_debug("AppManager navigation unchanged (app=%s mode=%s).", app_name.c_str(),
                       route_mode == MenuRouteMode::kKiosk ? "kiosk" : "http");
             return;
         }
     }
 
+    if (navigation_history_.size() >= kMaxNavigationHistory) {
+        navigation_history_.pop_front();
+    }
     navigation_history_.push_back({app_name, route_mode});
-    g_message("AppManager recorded navigation. app=%s mode=%s", app_name.c_str(),
+    log_debug("AppManager recorded navigation. app=%s mode=%s", app_name.c_str(),
               route_mode == MenuRouteMode::kKiosk ? "kiosk" : "http");
 }
 
 void AppManager::clear_navigation_history() {
     if (!navigation_history_.empty()) {
-        g_message("AppManager clearing %zu navigation records.", navigation_history_.size());
+        log_debug("AppManager clearing %zu navigation records.", navigation_history_.size());
     }
     navigation_history_.clear();
 }
 
+std::size_t AppManager::navigation_history_size() const {
+    return navigation_history_.size();
+}
+
 std::optional<RouteMatch> AppManager::match_route_for_uri(const std::string& uri,
                                                           MenuRouteMode route_mode) const {
     const std::string origin = extract_origin(uri);
@@ -164,7 +230,7 @@ std::optional<RouteMatch> AppManager::match_route_for_uri(const std::string& uri
 
 void AppManager::set_default_language(Language language) {
     default_language_ = language;
-    g_message("AppManager default language set to %s", language_to_string(language));
+    log_message("AppManager default language set to %s", language_to_string(language));
 }
 
 Language AppManager::get_default_language() const {
@@ -187,42 +253,61 @@ std::string AppManager::to_html(Language language, MenuRouteMode route_mode) con
     return to_html(language, "", route_mode);
 }
 
-std::string AppManager::to_json(Language language) const {
-    std::ostringstream json;
-    json << "{\n";
-    json << "  \"apps\": [\n";
-
-    for (std::size_t i = 0; i < apps_.size(); ++i) {
-        const auto& app = apps_[i];
-        const std::string localized_name = translation_catalog_.translate(app.name, language);
-        json << "    {\n";
-        json << "      \"name\": \"" << localized_name << "\",\n";
-        json << "      \"accent\": \"" << app.accent << "\",\n";
-        json << "      \"icon\": \"" << app.icon << "\"\n";
-        json << "    }";
-        if (i + 1 < apps_.size()) {
-            json << ",";
-        }
-        json << "\n";
+std::string AppManager::page_html(AppPage page, Language language,
+                                  MenuRouteMode route_mode) const {
+    TraceSpan span("app.page_html");
+    const bool http = route_mode == MenuRouteMode::kHttpServer;
+    const std::string asset_prefix = http ? "/" : "";
+    switch (page) {
+        case AppPage::kBeaverPhone:
+            return beaverphone_page_html(language, asset_prefix,
+                                         http ? BeaverphoneMenuLinkMode::kAbsoluteRoot
+                                              : BeaverphoneMenuLinkMode::kRelativeIndex);
+        case AppPage::kBeaverTask:
+            return beavertask_page_html(language, asset_prefix,
+                                        http ? BeaverTaskMenuLinkMode::kAbsoluteRoot
+                                             : BeaverTaskMenuLinkMode::kRelativeIndex);
+        case AppPage::kBeaverAlarm:
+            return beaveralarm_page_html(language, asset_prefix,
+                                         http ? BeaverAlarmMenuLinkMode::kAbsoluteRoot
+                                              : BeaverAlarmMenuLinkMode::kRelativeIndex);
+        case AppPage::kBeaverSystem:
+            return beaversystem_page_html(language, asset_prefix,
+                                          http ? BeaverSystemMenuLinkMode::kAbsoluteRoot
+                                               : BeaverSystemMenuLinkMode::kRelativeIndex);
+        case AppPage::kMenu:
+        default:
+            return to_html(language, asset_prefix, route_mode);
     }
+}
 
-    json << "  ]\n";
-    json << "}\n";
-
-    return json.str();
+std::string AppManager::to_json(Language language) const {
+    TraceSpan span("app.to_json");
+    std::string out;
+    out.reserve(64 + 96 * apps_.size());
+    JsonWriter json(out);
+    json.begin_object();
+    json.key("apps").begin_array();
+    for (const auto& app : apps_) {
+        json.begin_object();
+        json.key("name").string(translation_catalog_.translate(app.name, language));
+        json.key("accent").string(app.accent);
+        json.key("icon").string(app.icon);
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+    json.finish();
+    return out;
 }
 
 std::string AppManager::to_html(Language language, const std::string& asset_prefix,
                                 MenuRouteMode route_mode) const {
+    const RenderStart started;
     std::string html = generate_menu_page_html(apps_, translation_catalog_, language, route_mode,
                                                asset_prefix);
-    if (html.empty()) {
-        g_warning("AppManager generated empty menu HTML for language: %s",
-                  language_to_string(language));
-    } else {
-        g_message("AppManager generated menu HTML. language=%s bytes=%zu",
-                  language_to_string(language), html.size());
-    }
+    static const RenderTarget target("menu", "menu");
+    report_render(target, language, html, started);
     return html;
 }
 
@@ -245,15 +330,11 @@ std::string AppManager::beaverphone_page_html(Language language,
 std::string AppManager::beaverphone_page_html(Language language,
                                               const std::string& asset_prefix,
                                               BeaverphoneMenuLinkMode menu_link_mode) const {
+    const RenderStart started;
     std::string html = generate_beaverphone_dialpad_html(translation_catalog_, language,
                                                          asset_prefix, menu_link_mode);
-    if (html.empty()) {
-        g_warning("AppManager generated empty BeaverPhone HTML for language: %s",
-                  language_to_string(language));
-    } else {
-        g_message("AppManager generated BeaverPhone HTML. language=%s bytes=%zu",
-                  language_to_string(language), html.size());
-    }
+    static const RenderTarget target("BeaverPhone", "beaverphone");
+    report_render(target, language, html, started);
     return html;
 }
 
@@ -275,15 +356,11 @@ std::string AppManager::beaveralarm_page_html(Language language,
 std::string AppManager::beaveralarm_page_html(Language language,
                                               const std::string& asset_prefix,
                                               BeaverAlarmMenuLinkMode menu_link_mode) const {
+    const RenderStart started;
     std::string html = generate_beaveralarm_console_html(translation_catalog_, language,
                                                          asset_prefix, menu_link_mode);
-    if (html.empty()) {
-        g_warning("AppManager generated empty BeaverAlarm HTML for language: %s",
-                  language_to_string(language));
-    } else {
-        g_message("AppManager generated BeaverAlarm HTML. language=%s bytes=%zu",
-                  language_to_string(language), html.size());
-    }
+    static const RenderTarget target("BeaverAlarm", "beaveralarm");
+    report_render(target, language, html, started);
     return html;
 }
 
@@ -305,17 +382,13 @@ std::string AppManager::beaversystem_page_html(Language language,
 std::string AppManager::beaversystem_page_html(Language language,
                                                const std::string& asset_prefix,
                                                BeaverSystemMenuLinkMode menu_link_mode) const {
+    const RenderStart started;
     SystemStatusSnapshot snapshot = collect_system_status();
     std::string html = generate_beaversystem_dashboard_html(translation_catalog_, language,
                                                             asset_prefix, menu_link_mode,
                                                             snapshot);
-    if (html.empty()) {
-        g_warning("AppManager generated empty BeaverSystem HTML for language: %s",
-                  language_to_string(language));
-    } else {
-        g_message("AppManager generated BeaverSystem HTML. language=%s bytes=%zu",
-                  language_to_string(language), html.size());
-    }
+    static const RenderTarget target("BeaverSystem", "beaversystem");
+    report_render(target, language, html, started);
     return html;
 }
 
@@ -330,14 +403,10 @@ std::string AppManager::beavertask_page_html(Language language,
 
 std::string AppManager::beavertask_page_html(Language language, const std::string& asset_prefix,
                                              BeaverTaskMenuLinkMode menu_link_mode) const {
+    const RenderStart started;
     std::string html = generate_beavertask_board_html(translation_catalog_, language,
                                                       asset_prefix, menu_link_mode);
-    if (html.empty()) {
-        g_warning("AppManager generated empty BeaverTask HTML for language: %s",
-                  language_to_string(language));
-    } else {
-        g_message("AppManager generated BeaverTask HTML. language=%s bytes=%zu",
-                  language_to_string(language), html.size());
-    }
+    static const RenderTarget target("BeaverTask", "beavertask");
+    report_render(target, language, html, started);
     return html;
 }
@@ -0,0 +1,42 @@
+#include "core/asset_manifest.h"
+
+#include <utility>
+
+#include "core/content_hash.h"
+#include "core/log.h"
+#include "core/resource_bundle.h"
+
+namespace {
+
+constexpr std::string_view kPublic = "public/";
+
+}  // namespace
+
+AssetManifest::AssetManifest() {
+    if (!resources_embedded()) {
+        return;
+    }
+    for (const auto& resource : list_resources(kPublic)) {
+        // Embedded resources are static, so their paths can key the map.
+        const std::string_view plain = resource->path.substr(kPublic.size());
+        std::string fingerprinted = fingerprinted_path(plain, resource->hash);
+        resource_by_fingerprint_.emplace(fingerprinted, std::string(resource->path));
+        by_plain_name_.emplace(plain, std::move(fingerprinted));
+    }
+    log_debug("AssetManifest fingerprinted %zu public assets", by_plain_name_.size());
+}
+
+std::string_view AssetManifest::fingerprinted(std::string_view plain) const {
+    const auto it = by_plain_name_.find(plain);
+    return it != by_plain_name_.end() ? std::string_view(it->second) : plain;
+}
+
+const std::string* AssetManifest::resource_for(std::string_view fingerprinted) const {
+    const auto it = resource_by_fingerprint_.find(std::string(fingerprinted));
+    return it != resource_by_fingerprint_.end() ? &it->second : nullptr;
+}
+
+const AssetManifest& asset_manifest() {
+    static const AssetManifest manifest;
+    return manifest;
+}
@@ -0,0 +1,34 @@
+#include "core/content_hash.h"
+
+#include <cstdint>
+
+std::string content_hash(std::string_view data) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char byte : data) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 0x100000001b3ULL;
+    }
+
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (std::size_t i = hex.size(); i-- > 0;) {
+        hex[i] = kDigits[hash & 0xf];
+        hash >>= 4;
+    }
+    return hex;
+}
+
+std::string fingerprinted_path(std::string_view path, std::string_view hash) {
+    const std::size_t slash = path.rfind('/');
+    std::size_t dot = path.rfind('.');
+    // No extension, or only a leading dot ("dir/.hidden"): append instead.
+    if (dot == std::string_view::npos || (slash != std::string_view::npos && dot <= slash + 1) ||
+        dot == 0) {
+        dot = path.size();
+    }
+    std::string out(path.substr(0, dot));
+    out.push_back('.');
+    out += hash.substr(0, 8);
+    out += path.substr(dot);
+    return out;
+}
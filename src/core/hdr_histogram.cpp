@@ -0,0 +1,108 @@
+#include "core/hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int bit_length(std::uint64_t value) {
+    return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+}  // namespace
+
+HdrHistogram::HdrHistogram(std::uint64_t highest_trackable_value, int significant_digits)
+    : highest_trackable_value_(std::max<std::uint64_t>(2, highest_trackable_value)) {
+    significant_digits = std::clamp(significant_digits, 1, 5);
+    // Enough sub-buckets to tell 10^digits apart at the top of each bucket.
+    const auto largest_single_unit =
+        static_cast<std::uint64_t>(2 * std::pow(10, significant_digits));
+    const int sub_bucket_count_magnitude = bit_length(largest_single_unit - 1);
+    sub_bucket_half_count_magnitude_ = sub_bucket_count_magnitude - 1;
+    sub_bucket_count_ = std::uint64_t{1} << sub_bucket_count_magnitude;
+    sub_bucket_mask_ = sub_bucket_count_ - 1;
+
+    std::size_t bucket_count = 1;
+    std::uint64_t smallest_untrackable = sub_bucket_count_;
+    while (smallest_untrackable <= highest_trackable_value_) {
+        smallest_untrackable <<= 1;
+        ++bucket_count;
+    }
+    counts_.assign((bucket_count + 1) * (sub_bucket_count_ / 2), 0);
+}
+
+std::size_t HdrHistogram::counts_index(std::uint64_t value) const {
+    const int bucket =
+        bit_length(value | sub_bucket_mask_) - (sub_bucket_half_count_magnitude_ + 1);
+    const std::uint64_t sub_bucket = value >> bucket;
+    return (static_cast<std::size_t>(bucket + 1) << sub_bucket_half_count_magnitude_) +
+           static_cast<std::size_t>(sub_bucket - (sub_bucket_count_ / 2));
+}
+
+std::uint64_t HdrHistogram::value_at_index(std::size_t index) const {
+    int bucket = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+    std::uint64_t sub_bucket = (index & ((sub_bucket_count_ / 2) - 1)) + sub_bucket_count_ / 2;
+    if (bucket < 0) {
+        sub_bucket -= sub_bucket_count_ / 2;
+        bucket = 0;
+    }
+    // Highest value that maps to this index.
+    return (sub_bucket << bucket) + (std::uint64_t{1} << bucket) - 1;
+}
+
+void HdrHistogram::record(std::uint64_t value, std::uint64_t count) {
+    value = std::min(value, highest_trackable_value_);
+    counts_[counts_index(value)] += count;
+    total_count_ += count;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void HdrHistogram::merge(const HdrHistogram& other) {
+    const std::size_t size = std::min(counts_.size(), other.counts_.size());
+    for (std::size_t i = 0; i < size; ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_count_ += other.total_count_;
+    if (other.total_count_ > 0) {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+}
+
+void HdrHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_count_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+}
+
+double HdrHistogram::mean() const {
+    if (total_count_ == 0) {
+        return 0.0;
+    }
+    double total = 0.0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] != 0) {
+            total += static_cast<double>(counts_[i]) * static_cast<double>(value_at_index(i));
+        }
+    }
+    return total / static_cast<double>(total_count_);
+}
+
+std::uint64_t HdrHistogram::value_at_percentile(double percentile) const {
+    if (total_count_ == 0) {
+        return 0;
+    }
+    const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    const auto wanted = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(total_count_))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= wanted) {
+            return std::min(value_at_index(i), max_);
+        }
+    }
+    return max_;
+}
@@ -0,0 +1,187 @@
+#include "core/json_writer.h"
+
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#include "core/text_escape.h"
+
+void append_json_string(std::string& out, std::string_view text) {
+    out += '"';
+    append_json_escaped(out, text);
+    out += '"';
+}
+
+std::string json_escape(std::string_view text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    append_json_escaped(escaped, text);
+    return escaped;
+}
+
+JsonWriter::JsonWriter(std::string& out, JsonStyle style)
+    : out_(out), pretty_(style == JsonStyle::kPretty) {}
+
+JsonWriter& JsonWriter::begin_object() {
+    open('{', false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    close('}', false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    open('[', true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    close(']', true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    assert(depth_ > 0 && !is_array_[depth_] && "JSON key outside of an object");
+    assert(!after_key_ && "JSON key without a value");
+    if (has_items_[depth_]) {
+        out_ += ',';
+    }
+    has_items_[depth_] = true;
+    newline();
+    append_json_string(out_, name);
+    out_ += pretty_ ? ": " : ":";
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(std::string_view text) {
+    before_value();
+    append_json_string(out_, text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool value) {
+    before_value();
+    out_ += value ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    before_value();
+    out_ += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(long long value) {
+    before_value();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(unsigned long long value) {
+    before_value();
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(double value, int precision) {
+    if (!std::isfinite(value)) {
+        return null();
+    }
+    before_value();
+    char buffer[64];
+    const auto result =
+        std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, precision);
+    if (result.ec != std::errc()) {
+        // Only reachable for magnitudes beyond ~1e60; exponent form always fits.
+        const auto fallback = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, fallback.ptr);
+        return *this;
+    }
+    out_.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::optional_number(double value, int precision) {
+    if (value < 0.0) {
+        return null();
+    }
+    return number(value, precision);
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    before_value();
+    out_ += json;
+    return *this;
+}
+
+void JsonWriter::finish() {
+    assert(depth_ == 0 && "unterminated JSON container");
+    assert(!after_key_ && "JSON key without a value");
+    if (pretty_) {
+        out_ += '\n';
+    }
+}
+
+void JsonWriter::before_value() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (depth_ == 0) {
+        assert(!has_items_[0] && "JSON document with more than one top-level value");
+        has_items_[0] = true;
+        return;
+    }
+    assert(is_array_[depth_] && "JSON object member without a key");
+    if (has_items_[depth_]) {
+        out_ += ',';
+    }
+    has_items_[depth_] = true;
+    newline();
+}
+
+void JsonWriter::open(char bracket, bool is_array) {
+    if (depth_ + 1 >= kMaxDepth) {
+        throw std::logic_error("JSON nesting deeper than JsonWriter::kMaxDepth");
+    }
+    before_value();
+    out_ += bracket;
+    ++depth_;
+    has_items_[depth_] = false;
+#ifndef NDEBUG
+    is_array_[depth_] = is_array;
+#else
+    (void)is_array;
+#endif
+}
+
+void JsonWriter::close(char bracket, bool is_array) {
+    if (depth_ == 0) {
+        throw std::logic_error("JSON container closed without being opened");
+    }
+    assert(is_array_[depth_] == is_array && "mismatched JSON container");
+    assert(!after_key_ && "JSON key without a value");
+    (void)is_array;
+    const bool had_items = has_items_[depth_];
+    --depth_;
+    if (had_items) {
+        newline();
+    }
+    out_ += bracket;
+}
+
+void JsonWriter::newline() {
+    if (!pretty_) {
+        return;
+    }
+    out_ += '\n';
+    out_.append(depth_ * 2, ' ');
+}
@@ -0,0 +1,74 @@
+#include "core/log.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+
+std::atomic<bool> g_muted{false};
+
+bool debug_enabled() {
+    static const bool enabled = [] {
+        const char* domains = std::getenv("G_MESSAGES_DEBUG");
+        return domains != nullptr && *domains != '\0';
+    }();
+    return enabled;
+}
+
+// One fwrite per line, so lines from different threads do not interleave.
+void write_line(const char* prefix, const char* format, va_list arguments) {
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    const auto milliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() %
+        1000;
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+
+    char line[1024];
+    int length = std::snprintf(line, sizeof(line), "%s: %02d:%02d:%02d.%03d: ", prefix,
+                               tm.tm_hour, tm.tm_min, tm.tm_sec, static_cast<int>(milliseconds));
+    const int available = static_cast<int>(sizeof(line)) - length - 1;
+    const int written = std::vsnprintf(line + length, static_cast<std::size_t>(available) + 1,
+                                       format, arguments);
+    length += written < 0 ? 0 : written > available ? available : written;
+    line[length++] = '\n';
+    std::fwrite(line, 1, static_cast<std::size_t>(length), stderr);
+}
+
+}  // namespace
+
+void log_debug(const char* format, ...) {
+    if (!debug_enabled() || g_muted.load(std::memory_order_relaxed)) {
+        return;
+    }
+    va_list arguments;
+    va_start(arguments, format);
+    write_line("** Debug", format, arguments);
+    va_end(arguments);
+}
+
+void log_message(const char* format, ...) {
+    if (g_muted.load(std::memory_order_relaxed)) {
+        return;
+    }
+    va_list arguments;
+    va_start(arguments, format);
+    write_line("** Message", format, arguments);
+    va_end(arguments);
+}
+
+void log_warning(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    write_line("** WARNING **", format, arguments);
+    va_end(arguments);
+}
+
+void set_log_messages_muted(bool muted) {
+    g_muted.store(muted, std::memory_order_relaxed);
+}
@@ -0,0 +1,245 @@
+#include "core/metrics.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+void append_label_value(std::string& out, const std::string& value) {
+    for (char ch : value) {
+        switch (ch) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += ch;
+                break;
+        }
+    }
+}
+
+std::string render_labels(const MetricLabels& labels) {
+    std::string rendered;
+    for (const auto& [name, value] : labels) {
+        if (!rendered.empty()) {
+            rendered += ',';
+        }
+        rendered += name;
+        rendered += "=\"";
+        append_label_value(rendered, value);
+        rendered += '"';
+    }
+    return rendered;
+}
+
+template <typename Number>
+void append_number(std::string& out, Number value) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Writes `name{labels,extra} value`, omitting the braces when there are no labels.
+template <typename Number>
+void append_sample(std::string& out, const std::string& name, const char* suffix,
+                   const std::string& labels, const std::string& extra_label, Number value) {
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra_label.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra_label.empty()) {
+            out += ',';
+        }
+        out += extra_label;
+        out += '}';
+    }
+    out += ' ';
+    append_number(out, value);
+    out += '\n';
+}
+
+}  // namespace
+
+std::size_t metric_shard() {
+    static std::atomic<std::size_t> next_shard{0};
+    thread_local const std::size_t shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+    return shard;
+}
+
+std::uint64_t Counter::value() const {
+    std::uint64_t total = 0;
+    for (const Cell& cell : cells_) {
+        total += cell.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+Histogram::Histogram(const std::vector<double>& upper_bounds_seconds) {
+    for (double bound : upper_bounds_seconds) {
+        if (bucket_count_ == kMaxBuckets) {
+            break;
+        }
+        if (!std::isfinite(bound) ||
+            (!bounds_seconds_.empty() && bound <= bounds_seconds_.back())) {
+            throw std::invalid_argument("histogram bounds must be finite and increasing");
+        }
+        bounds_seconds_.push_back(bound);
+        bounds_ns_[bucket_count_++] = static_cast<std::uint64_t>(std::llround(bound * 1e9));
+    }
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.upper_bounds = bounds_seconds_;
+    snapshot.cumulative_counts.assign(bucket_count_ + 1, 0);
+    std::uint64_t sum_ns = 0;
+    for (const Shard& shard : shards_) {
+        for (std::size_t bucket = 0; bucket <= bucket_count_; ++bucket) {
+            snapshot.cumulative_counts[bucket] +=
+                shard.buckets[bucket].load(std::memory_order_relaxed);
+        }
+        sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+    }
+    for (std::size_t bucket = 1; bucket <= bucket_count_; ++bucket) {
+        snapshot.cumulative_counts[bucket] += snapshot.cumulative_counts[bucket - 1];
+    }
+    snapshot.count = snapshot.cumulative_counts.back();
+    snapshot.sum_seconds = static_cast<double>(sum_ns) / 1e9;
+    return snapshot;
+}
+
+const std::vector<double>& default_latency_buckets() {
+    static const std::vector<double> buckets = {0.0001, 0.00025, 0.0005, 0.001, 0.0025,
+                                                0.005,  0.01,    0.025,  0.05,  0.1,
+                                                0.25,   0.5,     1.0,    2.5};
+    return buckets;
+}
+
+MetricsRegistry::Series& MetricsRegistry::series(const std::string& name, const std::string& help,
+                                                 Type type, const MetricLabels& labels,
+                                                 const std::vector<double>* upper_bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family* family = nullptr;
+    if (const auto found = by_name_.find(name); found != by_name_.end()) {
+        family = found->second;
+        if (family->type != type) {
+            throw std::logic_error("metric " + name + " registered with another type");
+        }
+    } else {
+        auto created = std::make_unique<Family>();
+        created->name = name;
+        created->help = help;
+        created->type = type;
+        family = created.get();
+        families_.push_back(std::move(created));
+        by_name_.emplace(name, family);
+    }
+
+    std::string rendered = render_labels(labels);
+    if (const auto found = family->by_labels.find(rendered); found != family->by_labels.end()) {
+        return *found->second;
+    }
+    auto created = std::make_unique<Series>();
+    created->labels = rendered;
+    switch (type) {
+        case Type::kCounter:
+            created->counter = std::make_unique<Counter>();
+            break;
+        case Type::kGauge:
+            created->gauge = std::make_unique<Gauge>();
+            break;
+        case Type::kHistogram:
+            created->histogram = std::make_unique<Histogram>(
+                upper_bounds != nullptr ? *upper_bounds : default_latency_buckets());
+            break;
+    }
+    Series* series = created.get();
+    family->series.push_back(std::move(created));
+    family->by_labels.emplace(std::move(rendered), series);
+    return *series;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const MetricLabels& labels) {
+    return *series(name, help, Type::kCounter, labels).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const MetricLabels& labels) {
+    return *series(name, help, Type::kGauge, labels).gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const MetricLabels& labels,
+                                      const std::vector<double>& upper_bounds) {
+    return *series(name, help, Type::kHistogram, labels, &upper_bounds).histogram;
+}
+
+void MetricsRegistry::write_openmetrics(std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& family : families_) {
+        out += "# TYPE ";
+        out += family->name;
+        out += family->type == Type::kCounter ? " counter"
+               : family->type == Type::kGauge ? " gauge"
+                                              : " histogram";
+        out += "\n# HELP ";
+        out += family->name;
+        out += ' ';
+        out += family->help;
+        out += '\n';
+
+        for (const auto& series : family->series) {
+            if (series->counter) {
+                append_sample(out, family->name, "_total", series->labels, {},
+                              series->counter->value());
+            } else if (series->gauge) {
+                append_sample(out, family->name, "", series->labels, {},
+                              series->gauge->value());
+            } else if (series->histogram) {
+                const Histogram::Snapshot snapshot = series->histogram->snapshot();
+                std::string le;
+                for (std::size_t bucket = 0; bucket < snapshot.cumulative_counts.size();
+                     ++bucket) {
+                    le = "le=\"";
+                    if (bucket < snapshot.upper_bounds.size()) {
+                        char bound[32];
+                        const auto result =
+                            std::to_chars(bound, bound + sizeof(bound),
+                                          snapshot.upper_bounds[bucket], std::chars_format::fixed);
+                        le.append(bound, result.ptr);
+                    } else {
+                        le += "+Inf";
+                    }
+                    le += '"';
+                    append_sample(out, family->name, "_bucket", series->labels, le,
+                                  snapshot.cumulative_counts[bucket]);
+                }
+                append_sample(out, family->name, "_count", series->labels, {}, snapshot.count);
+                append_sample(out, family->name, "_sum", series->labels, {},
+                              snapshot.sum_seconds);
+            }
+        }
+    }
+    out += "# EOF\n";
+}
+
+MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+CacheMetrics::CacheMetrics(const std::string& cache)
+    : hits_(metrics().counter("beaver_cache_lookups", "Cache lookups by cache and result.",
+                              {{"cache", cache}, {"result", "hit"}})),
+      misses_(metrics().counter("beaver_cache_lookups", "Cache lookups by cache and result.",
+                                {{"cache", cache}, {"result", "miss"}})) {}
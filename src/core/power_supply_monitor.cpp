@@ -0,0 +1,228 @@
+#include "core/power_supply_monitor.h"
+
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include "core/log.h"
+
+namespace {
+
+// Without uevents the cache can only be as fresh as the polling interval.
+constexpr std::chrono::seconds kPollingFallbackInterval{5};
+
+std::string read_attribute(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::string value;
+    std::getline(file, value);
+    while (!value.empty() && (value.back() == '\n' || value.back() == ' ')) {
+        value.pop_back();
+    }
+    return value;
+}
+
+int parse_capacity(const std::string& text) {
+    if (text.empty()) {
+        return -1;
+    }
+    try {
+        return std::clamp(std::stoi(text), 0, 100);
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+}  // namespace
+
+PowerSupplyMonitor::PowerSupplyMonitor(std::string sysfs_root,
+                                       std::chrono::seconds refresh_interval)
+    : sysfs_root_(std::move(sysfs_root)), refresh_interval_(refresh_interval) {
+    open_uevent_socket();
+}
+
+PowerSupplyMonitor::~PowerSupplyMonitor() {
+    if (uevent_fd_ >= 0) {
+        close(uevent_fd_);
+    }
+}
+
+BatteryStatus PowerSupplyMonitor::current() {
+    drain_events();
+
+    const auto now = std::chrono::steady_clock::now();
+    if (needs_discovery_) {
+        discover();
+        last_refresh_ = now;
+    } else if (!last_refresh_ || now - *last_refresh_ >= refresh_interval_) {
+        refresh_from_sysfs();
+        last_refresh_ = now;
+    }
+    return cached_;
+}
+
+void PowerSupplyMonitor::open_uevent_socket() {
+    const int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                          NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        log_message("PowerSupplyMonitor: uevent socket unavailable, polling sysfs instead");
+        refresh_interval_ = std::min(refresh_interval_, kPollingFallbackInterval);
+        return;
+    }
+
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;  // Kernel broadcast group, not the udev daemon's re-broadcast.
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        log_message("PowerSupplyMonitor: unable to bind uevent socket, polling sysfs instead");
+        close(fd);
+        refresh_interval_ = std::min(refresh_interval_, kPollingFallbackInterval);
+        return;
+    }
+    uevent_fd_ = fd;
+}
+
+void PowerSupplyMonitor::drain_events() {
+    if (uevent_fd_ < 0) {
+        return;
+    }
+
+    char buffer[8192];
+    for (;;) {
+        sockaddr_nl sender{};
+        socklen_t sender_length = sizeof(sender);
+        const ssize_t received = recvfrom(uevent_fd_, buffer, sizeof(buffer), MSG_DONTWAIT,
+                                          reinterpret_cast<sockaddr*>(&sender), &sender_length);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                // Events were dropped; fall back to a full rescan.
+                needs_discovery_ = true;
+                continue;
+            }
+            return;
+        }
+        if (sender.nl_pid != 0) {
+            continue;
+        }
+        apply_event(std::string_view(buffer, static_cast<std::size_t>(received)));
+    }
+}
+
+void PowerSupplyMonitor::apply_event(std::string_view message) {
+    // Kernel uevents are "ACTION@DEVPATH\0KEY=VALUE\0KEY=VALUE\0...".
+    const std::size_t header_end = message.find('\0');
+    if (header_end == std::string_view::npos) {
+        return;
+    }
+    const std::string_view header = message.substr(0, header_end);
+    const std::string_view action = header.substr(0, header.find('@'));
+
+    std::string_view subsystem;
+    std::string_view name;
+    std::string_view type;
+    std::string_view status;
+    std::string_view capacity;
+    std::size_t position = header_end + 1;
+    while (position < message.size()) {
+        std::size_t end = message.find('\0', position);
+        if (end == std::string_view::npos) {
+            end = message.size();
+        }
+        const std::string_view field = message.substr(position, end - position);
+        const std::size_t separator = field.find('=');
+        if (separator != std::string_view::npos) {
+            const std::string_view key = field.substr(0, separator);
+            const std::string_view value = field.substr(separator + 1);
+            if (key == "SUBSYSTEM") {
+                subsystem = value;
+            } else if (key == "POWER_SUPPLY_NAME") {
+                name = value;
+            } else if (key == "POWER_SUPPLY_TYPE") {
+                type = value;
+            } else if (key == "POWER_SUPPLY_STATUS") {
+                status = value;
+            } else if (key == "POWER_SUPPLY_CAPACITY") {
+                capacity = value;
+            }
+        }
+        position = end + 1;
+    }
+
+    if (subsystem != "power_supply") {
+        return;
+    }
+    if (action != "change") {
+        needs_discovery_ = true;
+        return;
+    }
+    if (battery_name_.empty()) {
+        if (type == "Battery") {
+            needs_discovery_ = true;
+        }
+        return;
+    }
+    if (name != battery_name_) {
+        return;
+    }
+
+    cached_.present = true;
+    if (!status.empty()) {
+        cached_.state = std::string(status);
+    }
+    if (!capacity.empty()) {
+        cached_.percentage = parse_capacity(std::string(capacity));
+    }
+}
+
+void PowerSupplyMonitor::discover() {
+    needs_discovery_ = false;
+    battery_name_.clear();
+    cached_ = BatteryStatus{};
+
+    namespace fs = std::filesystem;
+    std::error_code error;
+    const fs::path root(sysfs_root_);
+    if (fs::is_directory(root, error)) {
+        for (const auto& entry : fs::directory_iterator(root, error)) {
+            if (read_attribute(entry.path() / "type") == "Battery") {
+                battery_name_ = entry.path().filename().string();
+                break;
+            }
+        }
+    }
+
+    if (battery_name_.empty()) {
+        cached_.state = "Unavailable";
+        return;
+    }
+    refresh_from_sysfs();
+}
+
+void PowerSupplyMonitor::refresh_from_sysfs() {
+    if (battery_name_.empty()) {
+        discover();
+        return;
+    }
+
+    const std::filesystem::path device = std::filesystem::path(sysfs_root_) / battery_name_;
+    std::error_code error;
+    if (!std::filesystem::exists(device, error)) {
+        discover();
+        return;
+    }
+
+    cached_.present = true;
+    cached_.state = read_attribute(device / "status");
+    if (cached_.state.empty()) {
+        cached_.state = "Unknown";
+    }
+    cached_.percentage = parse_capacity(read_attribute(device / "capacity"));
+}
@@ -0,0 +1,406 @@
+#include "core/process_scanner.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+
+#include "core/json_writer.h"
+#include "core/metrics.h"
+
+namespace {
+
+constexpr std::size_t kStatBufferSize = 1024;
+constexpr std::size_t kStatmBufferSize = 128;
+constexpr std::size_t kMaxDescriptorBudget = 8192;
+
+std::size_t compute_descriptor_budget() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return 256;
+    }
+    if (limit.rlim_cur == RLIM_INFINITY) {
+        return kMaxDescriptorBudget;
+    }
+    // Leave half of the descriptor table to the server itself.
+    return std::min<std::size_t>(static_cast<std::size_t>(limit.rlim_cur) / 2,
+                                 kMaxDescriptorBudget);
+}
+
+bool parse_pid(const char* name, int& pid) {
+    if (name == nullptr || name[0] < '1' || name[0] > '9') {
+        return false;
+    }
+    const char* end = name + std::char_traits<char>::length(name);
+    const auto result = std::from_chars(name, end, pid);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+std::string_view read_into(int fd, char* buffer, std::size_t size) {
+    const ssize_t bytes_read = pread(fd, buffer, size - 1, 0);
+    if (bytes_read <= 0) {
+        return {};
+    }
+    buffer[bytes_read] = '\0';
+    return std::string_view(buffer, static_cast<std::size_t>(bytes_read));
+}
+
+std::string_view next_field(const char*& cursor, const char* end) {
+    while (cursor < end && *cursor == ' ') {
+        ++cursor;
+    }
+    const char* start = cursor;
+    while (cursor < end && *cursor != ' ' && *cursor != '\n') {
+        ++cursor;
+    }
+    return std::string_view(start, static_cast<std::size_t>(cursor - start));
+}
+
+template <typename Number>
+bool parse_number(std::string_view text, Number& value) {
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc();
+}
+
+struct StatFields {
+    std::string_view command;
+    char state = '?';
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    unsigned long long start_time = 0;
+};
+
+// Parses "pid (comm) state ppid ...". The command may itself contain spaces or
+// parentheses, so the fields are located relative to the last ')'.
+bool parse_stat(std::string_view text, StatFields& fields) {
+    const std::size_t open = text.find('(');
+    const std::size_t close = text.rfind(')');
+    if (open == std::string_view::npos || close == std::string_view::npos || close < open) {
+        return false;
+    }
+    fields.command = text.substr(open + 1, close - open - 1);
+
+    const char* cursor = text.data() + close + 1;
+    const char* end = text.data() + text.size();
+    const std::string_view state = next_field(cursor, end);
+    if (state.empty()) {
+        return false;
+    }
+    fields.state = state.front();
+
+    for (int field = 4; field <= 22; ++field) {
+        const std::string_view token = next_field(cursor, end);
+        if (token.empty()) {
+            return false;
+        }
+        if (field == 14 && !parse_number(token, fields.utime)) {
+            return false;
+        }
+        if (field == 15 && !parse_number(token, fields.stime)) {
+            return false;
+        }
+        if (field == 22 && !parse_number(token, fields.start_time)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parse_resident_pages(std::string_view text, std::uint64_t& resident_pages) {
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+    const std::string_view size = next_field(cursor, end);
+    const std::string_view resident = next_field(cursor, end);
+    return !size.empty() && parse_number(resident, resident_pages);
+}
+
+struct Candidate {
+    double cpu_percent = 0.0;
+    std::uint64_t rss_bytes = 0;
+    int pid = 0;
+    char state = '?';
+    const std::string* command = nullptr;
+};
+
+bool ranks_higher_by_cpu(const Candidate& left, const Candidate& right) {
+    if (left.cpu_percent != right.cpu_percent) {
+        return left.cpu_percent > right.cpu_percent;
+    }
+    if (left.rss_bytes != right.rss_bytes) {
+        return left.rss_bytes > right.rss_bytes;
+    }
+    return left.pid < right.pid;
+}
+
+bool ranks_higher_by_memory(const Candidate& left, const Candidate& right) {
+    if (left.rss_bytes != right.rss_bytes) {
+        return left.rss_bytes > right.rss_bytes;
+    }
+    if (left.cpu_percent != right.cpu_percent) {
+        return left.cpu_percent > right.cpu_percent;
+    }
+    return left.pid < right.pid;
+}
+
+// Keeps the best `limit` candidates in a heap whose front is the weakest entry,
+// so each offer costs O(log limit) and the whole scan never sorts every process.
+template <typename Compare>
+void offer_candidate(std::vector<Candidate>& heap, std::size_t limit, const Candidate& candidate,
+                     Compare ranks_higher) {
+    if (limit == 0) {
+        return;
+    }
+    if (heap.size() < limit) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end(), ranks_higher);
+        return;
+    }
+    if (ranks_higher(candidate, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), ranks_higher);
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end(), ranks_higher);
+    }
+}
+
+template <typename Compare>
+std::vector<ProcessSample> drain_heap(std::vector<Candidate>& heap, Compare ranks_higher) {
+    std::sort_heap(heap.begin(), heap.end(), ranks_higher);
+    std::vector<ProcessSample> samples;
+    samples.reserve(heap.size());
+    for (const Candidate& candidate : heap) {
+        ProcessSample sample;
+        sample.pid = candidate.pid;
+        sample.command = candidate.command != nullptr ? *candidate.command : std::string();
+        sample.state = candidate.state;
+        sample.cpu_percent = candidate.cpu_percent;
+        sample.rss_bytes = candidate.rss_bytes;
+        samples.push_back(std::move(sample));
+    }
+    return samples;
+}
+
+void append_samples(JsonWriter& json, const std::vector<ProcessSample>& samples) {
+    json.begin_array();
+    for (const ProcessSample& sample : samples) {
+        json.begin_object();
+        json.key("pid").number(sample.pid);
+        json.key("command").string(sample.command);
+        json.key("state").string(std::string_view(&sample.state, 1));
+        json.key("cpuPercent").number(sample.cpu_percent, 2);
+        json.key("rssBytes").number(sample.rss_bytes);
+        json.end_object();
+    }
+    json.end_array();
+}
+
+}  // namespace
+
+ProcessScanner::ProcessScanner(std::string proc_root)
+    : proc_root_(std::move(proc_root)), descriptor_budget_(compute_descriptor_budget()) {
+    const long ticks = sysconf(_SC_CLK_TCK);
+    if (ticks > 0) {
+        clock_ticks_per_second_ = ticks;
+    }
+    const long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0) {
+        page_size_ = page_size;
+    }
+}
+
+ProcessScanner::~ProcessScanner() {
+    for (auto& entry : processes_) {
+        release_descriptors(entry.second);
+    }
+    if (proc_dir_ != nullptr) {
+        closedir(proc_dir_);
+    }
+}
+
+bool ProcessScanner::open_proc_directory() {
+    if (proc_dir_ != nullptr) {
+        rewinddir(proc_dir_);
+        return true;
+    }
+    proc_dir_ = opendir(proc_root_.c_str());
+    return proc_dir_ != nullptr;
+}
+
+void ProcessScanner::release_descriptors(TrackedProcess& process) {
+    if (process.stat_fd >= 0) {
+        close(process.stat_fd);
+        process.stat_fd = -1;
+        --open_descriptors_;
+    }
+    if (process.statm_fd >= 0) {
+        close(process.statm_fd);
+        process.statm_fd = -1;
+        --open_descriptors_;
+    }
+}
+
+bool ProcessScanner::read_process(int pid, TrackedProcess& process, Reading& reading) {
+    const bool had_descriptors = process.stat_fd >= 0;
+    if (read_process_once(pid, process, reading)) {
+        return true;
+    }
+    if (!had_descriptors) {
+        return false;
+    }
+    // A cached descriptor keeps pointing at the process it was opened for; if the
+    // PID has been recycled since, reopen by path before giving up on it.
+    release_descriptors(process);
+    return read_process_once(pid, process, reading);
+}
+
+bool ProcessScanner::read_process_once(int pid, TrackedProcess& process, Reading& reading) {
+    int stat_fd = process.stat_fd;
+    int statm_fd = process.statm_fd;
+    const bool cached = stat_fd >= 0 && statm_fd >= 0;
+    static CacheMetrics descriptor_cache("process_descriptors");
+    descriptor_cache.record(cached);
+
+    if (!cached) {
+        char path[32];
+        const int dir_fd = dirfd(proc_dir_);
+        std::snprintf(path, sizeof(path), "%d/stat", pid);
+        stat_fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+        if (stat_fd < 0) {
+            return false;
+        }
+        std::snprintf(path, sizeof(path), "%d/statm", pid);
+        statm_fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+        if (statm_fd < 0) {
+            close(stat_fd);
+            return false;
+        }
+    }
+
+    char stat_buffer[kStatBufferSize];
+    char statm_buffer[kStatmBufferSize];
+    StatFields fields;
+    const bool ok = parse_stat(read_into(stat_fd, stat_buffer, sizeof(stat_buffer)), fields) &&
+                    parse_resident_pages(read_into(statm_fd, statm_buffer, sizeof(statm_buffer)),
+                                         reading.resident_pages);
+
+    if (!cached) {
+        if (ok && open_descriptors_ + 2 <= descriptor_budget_) {
+            process.stat_fd = stat_fd;
+            process.statm_fd = statm_fd;
+            open_descriptors_ += 2;
+        } else {
+            close(stat_fd);
+            close(statm_fd);
+        }
+    }
+
+    if (!ok) {
+        return false;
+    }
+
+    reading.cpu_ticks = fields.utime + fields.stime;
+    reading.start_time = fields.start_time;
+    process.state = fields.state;
+    if (process.command != fields.command) {
+        process.command.assign(fields.command.data(), fields.command.size());
+    }
+    return true;
+}
+
+ProcessTable ProcessScanner::scan(std::size_t top_n) {
+    ProcessTable table;
+    if (!open_proc_directory()) {
+        return table;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed_seconds =
+        has_previous_scan_ ? std::chrono::duration<double>(now - last_scan_).count() : 0.0;
+    const double elapsed_ticks = elapsed_seconds * static_cast<double>(clock_ticks_per_second_);
+    ++generation_;
+
+    std::vector<Candidate> cpu_heap;
+    std::vector<Candidate> memory_heap;
+    cpu_heap.reserve(top_n);
+    memory_heap.reserve(top_n);
+
+    while (const dirent* entry = readdir(proc_dir_)) {
+        int pid = 0;
+        if (!parse_pid(entry->d_name, pid)) {
+            continue;
+        }
+
+        auto [it, inserted] = processes_.try_emplace(pid);
+        TrackedProcess& process = it->second;
+        Reading reading;
+        if (!read_process(pid, process, reading)) {
+            release_descriptors(process);
+            processes_.erase(it);
+            continue;
+        }
+
+        const bool recycled = !inserted && process.start_time != reading.start_time;
+        unsigned long long delta_ticks = 0;
+        if (!inserted && !recycled) {
+            delta_ticks = reading.cpu_ticks >= process.cpu_ticks
+                              ? reading.cpu_ticks - process.cpu_ticks
+                              : 0;
+        } else if (has_previous_scan_) {
+            // Every PID visible now but unknown before started after the last scan.
+            delta_ticks = reading.cpu_ticks;
+        }
+
+        process.start_time = reading.start_time;
+        process.cpu_ticks = reading.cpu_ticks;
+        process.generation = generation_;
+        ++table.total_processes;
+
+        Candidate candidate;
+        candidate.pid = pid;
+        candidate.state = process.state;
+        candidate.command = &process.command;
+        candidate.rss_bytes = reading.resident_pages * static_cast<std::uint64_t>(page_size_);
+        candidate.cpu_percent =
+            elapsed_ticks > 0.0 ? static_cast<double>(delta_ticks) / elapsed_ticks * 100.0 : 0.0;
+
+        offer_candidate(cpu_heap, top_n, candidate, ranks_higher_by_cpu);
+        offer_candidate(memory_heap, top_n, candidate, ranks_higher_by_memory);
+    }
+
+    table.top_cpu = drain_heap(cpu_heap, ranks_higher_by_cpu);
+    table.top_memory = drain_heap(memory_heap, ranks_higher_by_memory);
+    table.interval_seconds = elapsed_seconds;
+
+    for (auto it = processes_.begin(); it != processes_.end();) {
+        if (it->second.generation != generation_) {
+            release_descriptors(it->second);
+            it = processes_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    last_scan_ = now;
+    has_previous_scan_ = true;
+    return table;
+}
+
+std::string process_table_to_json(const ProcessTable& table) {
+    std::string out;
+    out.reserve(256 + 128 * (table.top_cpu.size() + table.top_memory.size()));
+    JsonWriter json(out);
+    json.begin_object();
+    json.key("totalProcesses").number(table.total_processes);
+    json.key("intervalSeconds").number(table.interval_seconds, 2);
+    json.key("topCpu");
+    append_samples(json, table.top_cpu);
+    json.key("topMemory");
+    append_samples(json, table.top_memory);
+    json.end_object();
+    json.finish();
+    return out;
+}
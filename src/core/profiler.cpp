@@ -0,0 +1,296 @@
+#include "core/profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/log.h"
+
+namespace {
+
+constexpr std::size_t kMaxDepth = 32;
+// 80 s of one busy core at 100 Hz in about 2 MiB, allocated on first use.
+constexpr std::size_t kCapacity = 8192;
+// The signal handler and the kernel's signal trampoline.
+constexpr int kSkippedFrames = 2;
+
+struct ProfileSample {
+    std::uint32_t depth = 0;
+    std::array<void*, kMaxDepth> frames{};
+};
+
+std::mutex g_profile_mutex;  // Serializes start and stop.
+bool g_profiling = false;
+std::unique_ptr<ProfileSample[]> g_samples;
+std::atomic<bool> g_sampling{false};
+std::atomic<int> g_handlers_running{0};
+std::atomic<std::uint64_t> g_samples_written{0};
+
+// Runs on whichever thread was burning CPU when the timer expired. Only
+// backtrace() (already warmed up by start_profiling) and atomics in here.
+void on_profile_signal(int /*signal_number*/) {
+    const int saved_errno = errno;
+    // Sequentially consistent, as in stop_profiling(): either this increment
+    // is seen there, or this load sees g_sampling cleared.
+    g_handlers_running.fetch_add(1, std::memory_order_seq_cst);
+    if (g_sampling.load(std::memory_order_seq_cst)) {
+        std::array<void*, kMaxDepth + kSkippedFrames> frames;
+        const int depth = backtrace(frames.data(), static_cast<int>(frames.size()));
+        const std::uint64_t index = g_samples_written.fetch_add(1, std::memory_order_relaxed);
+        ProfileSample& sample = g_samples[index % kCapacity];
+        sample.depth = 0;
+        for (int i = kSkippedFrames; i < depth; ++i) {
+            sample.frames[sample.depth++] = frames[static_cast<std::size_t>(i)];
+        }
+    }
+    g_handlers_running.fetch_sub(1, std::memory_order_release);
+    errno = saved_errno;
+}
+
+void install_signal_handler() {
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        struct sigaction action {};
+        action.sa_handler = on_profile_signal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        // Never reset: a SIGPROF still pending after the timer is disarmed
+        // must not reach the default action, which terminates the process.
+        sigaction(SIGPROF, &action, nullptr);
+    });
+}
+
+void set_timer(int frequency_hz) {
+    itimerval timer{};
+    if (frequency_hz > 0) {
+        timer.it_interval.tv_usec = 1'000'000 / frequency_hz;
+        timer.it_value = timer.it_interval;
+    }
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+std::string demangle(const char* name) {
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(
+        abi::__cxa_demangle(name, nullptr, nullptr, &status), &std::free);
+    return status == 0 && demangled ? demangled.get() : name;
+}
+
+// "function" from the dynamic symbol table, else "module+0xoffset".
+std::string symbolize(void* address) {
+    Dl_info info{};
+    std::string name;
+    if (dladdr(address, &info) != 0 && info.dli_sname != nullptr) {
+        name = demangle(info.dli_sname);
+    } else if (info.dli_fname != nullptr) {
+        char offset[32];
+        std::snprintf(offset, sizeof(offset), "+0x%zx",
+                      static_cast<std::size_t>(static_cast<char*>(address) -
+                                               static_cast<char*>(info.dli_fbase)));
+        name = std::filesystem::path(info.dli_fname).filename().string() + offset;
+    } else {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%p", address);
+        name = text;
+    }
+    // ';' separates frames and the last ' ' the count in the folded format.
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+}
+
+std::string folded_stacks(const std::vector<ProfileSample>& samples) {
+    std::unordered_map<void*, std::string> names;
+    const auto name_of = [&names](void* address) -> const std::string& {
+        auto [it, inserted] = names.try_emplace(address);
+        if (inserted) {
+            it->second = symbolize(address);
+        }
+        return it->second;
+    };
+
+    std::unordered_map<std::string, std::uint64_t> counts;
+    std::string stack;
+    for (const ProfileSample& sample : samples) {
+        stack.clear();
+        for (std::uint32_t i = sample.depth; i-- > 0;) {
+            // Callers' return addresses point past the call; look up the call.
+            void* address = sample.frames[i];
+            if (i > 0) {
+                address = static_cast<char*>(address) - 1;
+            }
+            if (!stack.empty()) {
+                stack.push_back(';');
+            }
+            stack += name_of(address);
+        }
+        if (!stack.empty()) {
+            ++counts[stack];
+        }
+    }
+
+    std::vector<std::pair<std::string, std::uint64_t>> sorted(counts.begin(), counts.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& left, const auto& right) {
+        return left.second != right.second ? left.second > right.second : left.first < right.first;
+    });
+    std::string out;
+    for (const auto& [folded, count] : sorted) {
+        out += folded;
+        out.push_back(' ');
+        out += std::to_string(count);
+        out.push_back('\n');
+    }
+    return out;
+}
+
+int profile_frequency_from_environment() {
+    if (const char* value = std::getenv("BEAVER_PROFILE_HZ"); value != nullptr && *value) {
+        return std::atoi(value);
+    }
+    return 100;
+}
+
+// Signal-driven profiles: the handler only pokes a pipe, the control thread
+// does the work.
+int g_signal_pipe[2] = {-1, -1};
+
+void on_control_signal(int /*signal_number*/) {
+    const int saved_errno = errno;
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = write(g_signal_pipe[1], &byte, 1);
+    errno = saved_errno;
+}
+
+std::string profile_file_path() {
+    const std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    localtime_r(&now, &tm);
+    char name[64];
+    std::strftime(name, sizeof(name), "profile-%Y%m%d-%H%M%S.folded", &tm);
+    return (std::filesystem::path("logs") / name).string();
+}
+
+void run_profile_controls(bool profiling) {
+    for (;;) {
+        char byte = 0;
+        const ssize_t received = read(g_signal_pipe[0], &byte, 1);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return;
+        }
+        if (!profiling) {
+            profiling = start_profiling(profile_frequency_from_environment());
+            if (profiling) {
+                log_message("Profiling started; send the signal again to write the profile");
+            } else {
+                log_warning("A profile is already running");
+            }
+            continue;
+        }
+
+        const std::string folded = stop_profiling();
+        profiling = false;
+        const std::string path = profile_file_path();
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << folded;
+        if (file) {
+            log_message("Profile written to %s", path.c_str());
+        } else {
+            log_warning("Could not write profile to %s", path.c_str());
+        }
+    }
+}
+
+}  // namespace
+
+bool start_profiling(int frequency_hz) {
+    std::lock_guard<std::mutex> lock(g_profile_mutex);
+    if (g_profiling) {
+        return false;
+    }
+    if (!g_samples) {
+        g_samples = std::make_unique<ProfileSample[]>(kCapacity);
+    }
+    // The first backtrace() loads the unwinder with dlopen(), which must not
+    // happen inside the signal handler.
+    std::array<void*, 4> warm_up;
+    backtrace(warm_up.data(), static_cast<int>(warm_up.size()));
+
+    install_signal_handler();
+    g_samples_written.store(0, std::memory_order_relaxed);
+    g_sampling.store(true, std::memory_order_release);
+    set_timer(std::clamp(frequency_hz, 1, 1000));
+    g_profiling = true;
+    return true;
+}
+
+std::string stop_profiling() {
+    std::vector<ProfileSample> samples;
+    std::uint64_t written = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_profile_mutex);
+        if (!g_profiling) {
+            return {};
+        }
+        set_timer(0);
+        // Store then load, each sequentially consistent: with acquire/release
+        // alone the load could miss a handler that still saw g_sampling set.
+        g_sampling.store(false, std::memory_order_seq_cst);
+        // Let handlers that already passed the check finish their sample.
+        while (g_handlers_running.load(std::memory_order_seq_cst) > 0) {
+            std::this_thread::yield();
+        }
+        g_profiling = false;
+
+        written = g_samples_written.load(std::memory_order_relaxed);
+        const std::uint64_t kept = std::min<std::uint64_t>(written, kCapacity);
+        samples.reserve(kept);
+        for (std::uint64_t i = written - kept; i < written; ++i) {
+            samples.push_back(g_samples[i % kCapacity]);
+        }
+    }
+    if (written > kCapacity) {
+        log_warning("Profile kept the last %zu of %llu samples", kCapacity,
+                    static_cast<unsigned long long>(written));
+    }
+    return folded_stacks(samples);
+}
+
+void install_profile_controls(int signal_number) {
+    bool profiling = false;
+    if (const char* enabled = std::getenv("BEAVER_PROFILE");
+        enabled != nullptr && std::strcmp(enabled, "1") == 0) {
+        profiling = start_profiling(profile_frequency_from_environment());
+    }
+
+    if (g_signal_pipe[0] >= 0 || pipe2(g_signal_pipe, O_CLOEXEC) != 0) {
+        return;
+    }
+    fcntl(g_signal_pipe[1], F_SETFL, O_NONBLOCK);
+    std::signal(signal_number, on_control_signal);
+    std::thread(run_profile_controls, profiling).detach();
+}
@@ -0,0 +1,118 @@
+#include "core/resource_bundle.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "core/content_hash.h"
+
+namespace {
+
+// A file read through the BEAVER_RESOURCE_DIR override; the views in the base
+// point into the strings below.
+struct DiskResource : Resource {
+    std::string path_storage;
+    std::string data_storage;
+    std::string hash_storage;
+};
+
+const std::string& resource_directory() {
+    static const std::string directory = [] {
+        const char* value = std::getenv("BEAVER_RESOURCE_DIR");
+        return std::string(value != nullptr ? value : "");
+    }();
+    return directory;
+}
+
+std::shared_ptr<const Resource> read_resource_from_disk(std::string_view path) {
+    // Embedded lookups can only name bundled files; keep the override as tight.
+    if (path.empty() || path.front() == '/' || path.find("..") != std::string_view::npos) {
+        return nullptr;
+    }
+    const std::filesystem::path file_path = std::filesystem::path(resource_directory()) / path;
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file.is_open() || !std::filesystem::is_regular_file(file_path)) {
+        return nullptr;
+    }
+
+    auto resource = std::make_shared<DiskResource>();
+    resource->path_storage = std::string(path);
+    resource->data_storage.assign(std::istreambuf_iterator<char>(file),
+                                  std::istreambuf_iterator<char>());
+    resource->hash_storage = content_hash(resource->data_storage);
+    resource->path = resource->path_storage;
+    resource->data = resource->data_storage;
+    resource->hash = resource->hash_storage;
+    return resource;
+}
+
+}  // namespace
+
+std::shared_ptr<const Resource> find_resource(std::string_view path) {
+    if (!resource_directory().empty()) {
+        return read_resource_from_disk(path);
+    }
+
+    const Resource* begin = kEmbeddedResources;
+    const Resource* end = kEmbeddedResources + kEmbeddedResourceCount;
+    const Resource* it = std::lower_bound(
+        begin, end, path, [](const Resource& resource, std::string_view key) {
+            return resource.path < key;
+        });
+    if (it == end || it->path != path) {
+        return nullptr;
+    }
+    // Aliasing an empty owner: no allocation and no reference count to touch.
+    return std::shared_ptr<const Resource>(std::shared_ptr<const Resource>(), it);
+}
+
+std::vector<std::shared_ptr<const Resource>> list_resources(std::string_view prefix) {
+    std::vector<std::shared_ptr<const Resource>> resources;
+    if (resource_directory().empty()) {
+        const Resource* end = kEmbeddedResources + kEmbeddedResourceCount;
+        for (const Resource* it = std::lower_bound(
+                 kEmbeddedResources, end, prefix,
+                 [](const Resource& resource, std::string_view key) {
+                     return resource.path < key;
+                 });
+             it != end && it->path.substr(0, prefix.size()) == prefix; ++it) {
+            resources.emplace_back(std::shared_ptr<const Resource>(), it);
+        }
+        return resources;
+    }
+
+    namespace fs = std::filesystem;
+    const fs::path root(resource_directory());
+    // Only walk the directory the prefix names, not the whole source tree.
+    const fs::path start = root / std::string(prefix.substr(0, prefix.rfind('/') + 1));
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (fs::recursive_directory_iterator it(start, error), end; !error && it != end;
+         it.increment(error)) {
+        if (!it->is_regular_file(error)) {
+            continue;
+        }
+        std::string path = it->path().lexically_relative(root).generic_string();
+        if (path.compare(0, prefix.size(), prefix) == 0) {
+            paths.push_back(std::move(path));
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const std::string& path : paths) {
+        if (auto resource = read_resource_from_disk(path)) {
+            resources.push_back(std::move(resource));
+        }
+    }
+    return resources;
+}
+
+bool resources_embedded() {
+    return resource_directory().empty();
+}
+
+const char* resource_source() {
+    return resource_directory().empty() ? "embedded" : resource_directory().c_str();
+}
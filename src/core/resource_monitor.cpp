@@ -0,0 +1,184 @@
+#include "core/resource_monitor.h"
+
+#include <dirent.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "core/log.h"
+
+namespace {
+
+std::uint64_t parse_unsigned_env(const char* name, std::uint64_t fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const unsigned long long parsed = std::strtoull(value, &end, 10);
+    if (end == value || *end != '\0') {
+        log_warning("Ignoring invalid %s=%s", name, value);
+        return fallback;
+    }
+    return parsed;
+}
+
+std::uint64_t count_open_fds() {
+    DIR* directory = opendir("/proc/self/fd");
+    if (directory == nullptr) {
+        return 0;
+    }
+    std::uint64_t count = 0;
+    while (const dirent* entry = readdir(directory)) {
+        if (entry->d_name[0] != '.') {
+            ++count;
+        }
+    }
+    closedir(directory);
+    // The descriptor opendir() used to list the directory.
+    return count > 0 ? count - 1 : 0;
+}
+
+std::uint64_t heap_in_use_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast<std::uint64_t>(info.uordblks) + static_cast<std::uint64_t>(info.hblkhd);
+#elif defined(__GLIBC__)
+    const struct mallinfo info = mallinfo();
+    return static_cast<std::uint64_t>(static_cast<unsigned int>(info.uordblks)) +
+           static_cast<std::uint64_t>(static_cast<unsigned int>(info.hblkhd));
+#else
+    return 0;
+#endif
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const std::size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle),
+                     values.end());
+    return values[middle];
+}
+
+template <typename Field>
+ResourceTrend analyze(const char* name, const char* unit,
+                      const std::vector<ResourceSample>& samples, Field field, double budget) {
+    ResourceTrend trend;
+    trend.name = name;
+    trend.unit = unit;
+    trend.budget = budget;
+
+    constexpr std::size_t kQuarters = 4;
+    std::vector<double> quarter_medians;
+    for (std::size_t quarter = 0; quarter < kQuarters; ++quarter) {
+        const std::size_t begin = samples.size() * quarter / kQuarters;
+        const std::size_t end = samples.size() * (quarter + 1) / kQuarters;
+        std::vector<double> values;
+        for (std::size_t i = begin; i < end; ++i) {
+            values.push_back(field(samples[i]));
+        }
+        if (!values.empty()) {
+            quarter_medians.push_back(median(std::move(values)));
+        }
+    }
+    if (quarter_medians.empty()) {
+        return trend;
+    }
+    trend.start = quarter_medians.front();
+    trend.end = quarter_medians.back();
+    trend.growth = trend.end - trend.start;
+    trend.monotonic = quarter_medians.size() == kQuarters;
+    for (std::size_t i = 1; i < quarter_medians.size(); ++i) {
+        trend.monotonic = trend.monotonic && quarter_medians[i] > quarter_medians[i - 1];
+    }
+
+    double mean_requests = 0.0;
+    double mean_value = 0.0;
+    for (const ResourceSample& sample : samples) {
+        mean_requests += static_cast<double>(sample.requests);
+        mean_value += field(sample);
+    }
+    mean_requests /= static_cast<double>(samples.size());
+    mean_value /= static_cast<double>(samples.size());
+    double covariance = 0.0;
+    double variance = 0.0;
+    for (const ResourceSample& sample : samples) {
+        const double dx = static_cast<double>(sample.requests) - mean_requests;
+        covariance += dx * (field(sample) - mean_value);
+        variance += dx * dx;
+    }
+    trend.per_request = variance > 0.0 ? covariance / variance : 0.0;
+    trend.over_budget = trend.growth > budget;
+    return trend;
+}
+
+}  // namespace
+
+ResourceSample sample_process_resources() {
+    ResourceSample sample;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            sample.rss_kb = std::strtoull(line.c_str() + std::strlen("VmRSS:"), nullptr, 10);
+        } else if (line.rfind("Threads:", 0) == 0) {
+            sample.threads = std::strtoull(line.c_str() + std::strlen("Threads:"), nullptr, 10);
+        }
+    }
+    sample.open_fds = count_open_fds();
+    sample.heap_in_use_bytes = heap_in_use_bytes();
+    return sample;
+}
+
+ResourceBudgets resource_budgets_from_environment() {
+    ResourceBudgets budgets;
+    budgets.rss_kb = parse_unsigned_env("BEAVER_SOAK_RSS_KB", budgets.rss_kb);
+    budgets.heap_kb = parse_unsigned_env("BEAVER_SOAK_HEAP_KB", budgets.heap_kb);
+    budgets.open_fds = parse_unsigned_env("BEAVER_SOAK_FDS", budgets.open_fds);
+    budgets.threads = parse_unsigned_env("BEAVER_SOAK_THREADS", budgets.threads);
+    if (const char* value = std::getenv("BEAVER_SOAK_BYTES_PER_REQUEST"); value && *value) {
+        budgets.heap_bytes_per_request = std::strtod(value, nullptr);
+    }
+    return budgets;
+}
+
+std::vector<ResourceTrend> analyze_resource_growth(const std::vector<ResourceSample>& samples,
+                                                   const ResourceBudgets& budgets,
+                                                   double warmup_fraction) {
+    std::vector<ResourceSample> measured;
+    if (!samples.empty()) {
+        const double warmup_end =
+            samples.back().elapsed_seconds * std::clamp(warmup_fraction, 0.0, 0.9);
+        for (const ResourceSample& sample : samples) {
+            if (sample.elapsed_seconds >= warmup_end) {
+                measured.push_back(sample);
+            }
+        }
+    }
+
+    const auto rss = [](const ResourceSample& s) { return static_cast<double>(s.rss_kb); };
+    const auto heap_kb = [](const ResourceSample& s) {
+        return static_cast<double>(s.heap_in_use_bytes) / 1024.0;
+    };
+    const auto fds = [](const ResourceSample& s) { return static_cast<double>(s.open_fds); };
+    const auto threads = [](const ResourceSample& s) { return static_cast<double>(s.threads); };
+
+    std::vector<ResourceTrend> trends;
+    trends.push_back(analyze("rss", "KiB", measured, rss, static_cast<double>(budgets.rss_kb)));
+    ResourceTrend heap =
+        analyze("heap", "KiB", measured, heap_kb, static_cast<double>(budgets.heap_kb));
+    // A steady climb is a leak even while the total is still within budget.
+    heap.over_budget = heap.over_budget || (heap.monotonic && heap.per_request * 1024.0 >
+                                                                  budgets.heap_bytes_per_request);
+    trends.push_back(heap);
+    trends.push_back(analyze("fds", "", measured, fds, static_cast<double>(budgets.open_fds)));
+    trends.push_back(
+        analyze("threads", "", measured, threads, static_cast<double>(budgets.threads)));
+    return trends;
+}
@@ -0,0 +1,170 @@
+#include "core/router.h"
+
+#include <algorithm>
+
+namespace {
+
+// Returns the next non-empty segment at or after `position` and moves
+// `position` past it; an empty view means the path is exhausted.
+std::string_view next_segment(std::string_view path, std::size_t& position) {
+    while (position < path.size() && path[position] == '/') {
+        ++position;
+    }
+    const std::size_t start = position;
+    while (position < path.size() && path[position] != '/') {
+        ++position;
+    }
+    return path.substr(start, position - start);
+}
+
+}  // namespace
+
+const char* route_cache_control(RouteCaching caching) {
+    switch (caching) {
+        case RouteCaching::kNoStore:
+            return "no-cache, no-store, must-revalidate";
+        case RouteCaching::kRevalidate:
+            return "no-cache";
+        case RouteCaching::kPublic:
+            return "public, max-age=86400";
+        case RouteCaching::kImmutable:
+            return "public, max-age=31536000, immutable";
+        case RouteCaching::kUnspecified:
+        default:
+            return nullptr;
+    }
+}
+
+std::string_view RouteParams::get(std::string_view name) const {
+    for (std::size_t i = 0; i < count_; ++i) {
+        if (values_[i].first == name) {
+            return values_[i].second;
+        }
+    }
+    return {};
+}
+
+RouteTrie::RouteTrie() {
+    nodes_.emplace_back();
+}
+
+bool RouteTrie::can_insert(std::string_view pattern, RouteKind kind) const {
+    std::array<std::string_view, RouteParams::kMaxParams> names{};
+    std::size_t parameters = 0;
+    // Follows the existing nodes for as long as the pattern does; past that
+    // point everything is created fresh and cannot conflict.
+    std::size_t node = 0;
+    std::size_t position = 0;
+    for (std::string_view segment = next_segment(pattern, position); !segment.empty();
+         segment = next_segment(pattern, position)) {
+        if (segment.front() == ':') {
+            const std::string_view name = segment.substr(1);
+            if (name.empty() || parameters == RouteParams::kMaxParams ||
+                std::find(names.begin(), names.begin() + parameters, name) !=
+                    names.begin() + parameters) {
+                return false;
+            }
+            names[parameters++] = name;
+            if (node != kNoRoute) {
+                node = nodes_[node].parameter_child;
+                if (node != kNoRoute && nodes_[node].segment != name) {
+                    return false;
+                }
+            }
+        } else if (node != kNoRoute) {
+            const auto found = nodes_[node].literal_children.find(segment);
+            node = found == nodes_[node].literal_children.end() ? kNoRoute : found->second;
+        }
+    }
+    if (node == kNoRoute) {
+        return true;
+    }
+    const Node& target = nodes_[node];
+    return (kind == RouteKind::kExact ? target.exact_route : target.prefix_route) == kNoRoute;
+}
+
+bool RouteTrie::insert(std::string_view pattern, RouteKind kind, std::size_t route_index) {
+    // Checked up front so a rejected pattern leaves no nodes behind.
+    if (!can_insert(pattern, kind)) {
+        return false;
+    }
+
+    std::size_t node = 0;
+    std::size_t position = 0;
+    for (std::string_view segment = next_segment(pattern, position); !segment.empty();
+         segment = next_segment(pattern, position)) {
+        if (segment.front() == ':') {
+            std::size_t child = nodes_[node].parameter_child;
+            if (child == kNoRoute) {
+                child = nodes_.size();
+                nodes_.emplace_back().segment = std::string(segment.substr(1));
+                nodes_[node].parameter_child = child;
+            }
+            node = child;
+            continue;
+        }
+
+        auto& children = nodes_[node].literal_children;
+        const auto found = children.find(segment);
+        if (found != children.end()) {
+            node = found->second;
+            continue;
+        }
+        const std::size_t child = nodes_.size();
+        Node& created = nodes_.emplace_back();
+        created.segment = std::string(segment);
+        // Key the map with the child's own copy so it outlives `pattern`.
+        nodes_[node].literal_children.emplace(created.segment, child);
+        node = child;
+    }
+
+    (kind == RouteKind::kExact ? nodes_[node].exact_route : nodes_[node].prefix_route) =
+        route_index;
+    return true;
+}
+
+std::size_t RouteTrie::find(std::string_view path, RouteParams& params) const {
+    params.count_ = 0;
+    params.rest_ = {};
+
+    std::size_t prefix_route = kNoRoute;
+    std::size_t prefix_params = 0;
+    std::string_view prefix_rest;
+
+    std::size_t node = 0;
+    std::size_t position = 0;
+    for (;;) {
+        const Node& current = nodes_[node];
+        if (current.prefix_route != kNoRoute) {
+            prefix_route = current.prefix_route;
+            prefix_params = params.count_;
+            std::size_t rest_start = position;
+            while (rest_start < path.size() && path[rest_start] == '/') {
+                ++rest_start;
+            }
+            prefix_rest = path.substr(rest_start);
+        }
+
+        const std::string_view segment = next_segment(path, position);
+        if (segment.empty()) {
+            if (current.exact_route != kNoRoute) {
+                return current.exact_route;
+            }
+            break;
+        }
+
+        const auto found = current.literal_children.find(segment);
+        if (found != current.literal_children.end()) {
+            node = found->second;
+        } else if (current.parameter_child != kNoRoute) {
+            node = current.parameter_child;
+            params.values_[params.count_++] = {nodes_[node].segment, segment};
+        } else {
+            break;
+        }
+    }
+
+    params.count_ = prefix_params;
+    params.rest_ = prefix_rest;
+    return prefix_route;
+}
@@ -0,0 +1,238 @@
+#include "core/socket_owner_index.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+constexpr std::string_view kSocketLinkPrefix = "socket:[";
+
+bool parse_pid(const char* name, int& pid) {
+    if (name == nullptr || name[0] < '1' || name[0] > '9') {
+        return false;
+    }
+    const char* end = name + std::char_traits<char>::length(name);
+    const auto result = std::from_chars(name, end, pid);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+std::string read_small_file(int dir_fd, const char* path) {
+    const int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return {};
+    }
+    char buffer[512];
+    const ssize_t bytes_read = read(fd, buffer, sizeof(buffer));
+    close(fd);
+    if (bytes_read <= 0) {
+        return {};
+    }
+    return std::string(buffer, static_cast<std::size_t>(bytes_read));
+}
+
+// cmdline is NUL-separated; kernel threads have an empty one, so fall back to comm.
+std::string read_command_line(int dir_fd, int pid) {
+    char path[48];
+    std::snprintf(path, sizeof(path), "%d/cmdline", pid);
+    std::string command = read_small_file(dir_fd, path);
+    std::replace(command.begin(), command.end(), '\0', ' ');
+    while (!command.empty() && (command.back() == ' ' || command.back() == '\n')) {
+        command.pop_back();
+    }
+    if (command.empty()) {
+        std::snprintf(path, sizeof(path), "%d/comm", pid);
+        command = read_small_file(dir_fd, path);
+        while (!command.empty() && command.back() == '\n') {
+            command.pop_back();
+        }
+        if (!command.empty()) {
+            command = "[" + command + "]";
+        }
+    }
+    return command;
+}
+
+}  // namespace
+
+SocketOwnerIndex::SocketOwnerIndex(std::string proc_root,
+                                   std::chrono::seconds full_rescan_interval)
+    : proc_root_(std::move(proc_root)), full_rescan_interval_(full_rescan_interval) {}
+
+SocketOwnerIndex::~SocketOwnerIndex() {
+    if (proc_dir_ != nullptr) {
+        closedir(proc_dir_);
+    }
+}
+
+bool SocketOwnerIndex::open_proc_directory() {
+    if (proc_dir_ != nullptr) {
+        rewinddir(proc_dir_);
+        return true;
+    }
+    proc_dir_ = opendir(proc_root_.c_str());
+    return proc_dir_ != nullptr;
+}
+
+void SocketOwnerIndex::forget_inodes(int pid, ProcessEntry& entry) {
+    for (const std::uint64_t inode : entry.socket_inodes) {
+        auto owners_it = inode_owners_.find(inode);
+        if (owners_it == inode_owners_.end()) {
+            continue;
+        }
+        auto& pids = owners_it->second;
+        pids.erase(std::remove(pids.begin(), pids.end(), pid), pids.end());
+        if (pids.empty()) {
+            inode_owners_.erase(owners_it);
+        }
+    }
+    entry.socket_inodes.clear();
+}
+
+void SocketOwnerIndex::rescan_process(int pid, ProcessEntry& entry) {
+    forget_inodes(pid, entry);
+
+    const int proc_fd = dirfd(proc_dir_);
+    char path[48];
+    std::snprintf(path, sizeof(path), "%d/fd", pid);
+    const int fd = openat(proc_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        entry.readable = false;
+        return;
+    }
+    DIR* fd_dir = fdopendir(fd);
+    if (fd_dir == nullptr) {
+        close(fd);
+        entry.readable = false;
+        return;
+    }
+    entry.readable = true;
+
+    char link[64];
+    while (const dirent* fd_entry = readdir(fd_dir)) {
+        if (fd_entry->d_name[0] == '.') {
+            continue;
+        }
+        const ssize_t length = readlinkat(dirfd(fd_dir), fd_entry->d_name, link, sizeof(link));
+        if (length <= 0) {
+            continue;
+        }
+        const std::string_view target(link, static_cast<std::size_t>(length));
+        if (target.size() <= kSocketLinkPrefix.size() + 1 ||
+            target.substr(0, kSocketLinkPrefix.size()) != kSocketLinkPrefix ||
+            target.back() != ']') {
+            continue;
+        }
+        std::uint64_t inode = 0;
+        const char* digits = target.data() + kSocketLinkPrefix.size();
+        const char* digits_end = target.data() + target.size() - 1;
+        if (std::from_chars(digits, digits_end, inode).ec != std::errc()) {
+            continue;
+        }
+        entry.socket_inodes.push_back(inode);
+        inode_owners_[inode].push_back(pid);
+    }
+    closedir(fd_dir);
+
+    entry.command = read_command_line(proc_fd, pid);
+}
+
+bool SocketOwnerIndex::all_resolved(const std::vector<std::uint64_t>& inodes) const {
+    return std::all_of(inodes.begin(), inodes.end(), [this](std::uint64_t inode) {
+        return inode_owners_.find(inode) != inode_owners_.end();
+    });
+}
+
+std::unordered_map<std::uint64_t, SocketOwner> SocketOwnerIndex::resolve(
+    const std::vector<std::uint64_t>& inodes) {
+    std::unordered_map<std::uint64_t, SocketOwner> owners;
+    if (inodes.empty() || !open_proc_directory()) {
+        return owners;
+    }
+
+    ++generation_;
+    const int proc_fd = dirfd(proc_dir_);
+    // Processes whose fd table was not re-read this pass. The descriptor count
+    // misses a close followed by an open, so these are rescanned while any
+    // requested inode is still unresolved.
+    std::vector<int> unchanged;
+
+    while (const dirent* entry = readdir(proc_dir_)) {
+        int pid = 0;
+        if (!parse_pid(entry->d_name, pid)) {
+            continue;
+        }
+
+        char path[48];
+        std::snprintf(path, sizeof(path), "%d/fd", pid);
+        struct stat info {};
+        if (fstatat(proc_fd, path, &info, 0) != 0) {
+            continue;
+        }
+
+        auto [it, inserted] = processes_.try_emplace(pid);
+        ProcessEntry& process = it->second;
+        process.generation = generation_;
+        const long long fd_count = static_cast<long long>(info.st_size);
+        if (inserted || (fd_count > 0 && fd_count != process.fd_count)) {
+            process.fd_count = fd_count;
+            rescan_process(pid, process);
+        } else if (process.readable) {
+            unchanged.push_back(pid);
+        }
+    }
+
+    for (auto it = processes_.begin(); it != processes_.end();) {
+        if (it->second.generation != generation_) {
+            forget_inodes(it->first, it->second);
+            it = processes_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<std::uint64_t> unresolved;
+    for (const std::uint64_t inode : inodes) {
+        if (inode_owners_.find(inode) == inode_owners_.end()) {
+            unresolved.push_back(inode);
+        }
+    }
+    std::sort(unresolved.begin(), unresolved.end());
+    unresolved.erase(std::unique(unresolved.begin(), unresolved.end()), unresolved.end());
+    const auto now = std::chrono::steady_clock::now();
+    if (!unresolved.empty() && (unresolved != unresolved_after_rescan_ ||
+                                now - last_full_rescan_ >= full_rescan_interval_)) {
+        for (const int pid : unchanged) {
+            if (all_resolved(inodes)) {
+                break;
+            }
+            rescan_process(pid, processes_[pid]);
+        }
+        unresolved.erase(std::remove_if(unresolved.begin(), unresolved.end(),
+                                        [this](std::uint64_t inode) {
+                                            return inode_owners_.count(inode) != 0;
+                                        }),
+                         unresolved.end());
+        unresolved_after_rescan_ = std::move(unresolved);
+        last_full_rescan_ = now;
+    }
+
+    for (const std::uint64_t inode : inodes) {
+        const auto owners_it = inode_owners_.find(inode);
+        if (owners_it == inode_owners_.end() || owners_it->second.empty()) {
+            continue;
+        }
+        const int pid = *std::min_element(owners_it->second.begin(), owners_it->second.end());
+        SocketOwner owner;
+        owner.pid = pid;
+        owner.command = processes_[pid].command;
+        owners.emplace(inode, std::move(owner));
+    }
+    return owners;
+}
@@ -0,0 +1,197 @@
+#include "core/status_delta.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+#include "core/json_writer.h"
+
+namespace {
+
+class JsonFlattener {
+public:
+    JsonFlattener(std::string_view json, StatusFields& fields) : json_(json), fields_(fields) {}
+
+    void flatten() {
+        skip_whitespace();
+        if (peek() == '{') {
+            flatten_object(std::string());
+        }
+    }
+
+private:
+    char peek() const { return position_ < json_.size() ? json_[position_] : '\0'; }
+
+    void skip_whitespace() {
+        while (position_ < json_.size() &&
+               std::isspace(static_cast<unsigned char>(json_[position_])) != 0) {
+            ++position_;
+        }
+    }
+
+    std::string read_key() {
+        std::string key;
+        ++position_;  // Opening quote.
+        while (position_ < json_.size() && json_[position_] != '"') {
+            if (json_[position_] == '\\' && position_ + 1 < json_.size()) {
+                key += json_[position_++];
+            }
+            key += json_[position_++];
+        }
+        ++position_;  // Closing quote.
+        return key;
+    }
+
+    void flatten_object(const std::string& prefix) {
+        ++position_;  // '{'
+        for (;;) {
+            skip_whitespace();
+            if (peek() != '"') {
+                break;
+            }
+            const std::string key = read_key();
+            const std::string path = prefix.empty() ? key : prefix + "." + key;
+            skip_whitespace();
+            ++position_;  // ':'
+            skip_whitespace();
+            if (peek() == '{') {
+                flatten_object(path);
+            } else {
+                fields_.emplace_back(path, read_value());
+            }
+            skip_whitespace();
+            if (peek() == ',') {
+                ++position_;
+            }
+        }
+        if (peek() == '}') {
+            ++position_;
+        }
+    }
+
+    // Copies a scalar or array verbatim, dropping whitespace outside strings.
+    std::string read_value() {
+        std::string value;
+        int depth = 0;
+        bool in_string = false;
+        while (position_ < json_.size()) {
+            const char ch = json_[position_];
+            if (in_string) {
+                value += ch;
+                if (ch == '\\' && position_ + 1 < json_.size()) {
+                    value += json_[++position_];
+                } else if (ch == '"') {
+                    in_string = false;
+                }
+                ++position_;
+                continue;
+            }
+            if (depth == 0 && (ch == ',' || ch == '}' || ch == ']')) {
+                break;
+            }
+            if (ch == '"') {
+                in_string = true;
+            } else if (ch == '[' || ch == '{') {
+                ++depth;
+            } else if (ch == ']' || ch == '}') {
+                --depth;
+            }
+            if (std::isspace(static_cast<unsigned char>(ch)) == 0) {
+                value += ch;
+            }
+            ++position_;
+        }
+        return value;
+    }
+
+    std::string_view json_;
+    StatusFields& fields_;
+    std::size_t position_ = 0;
+};
+
+}  // namespace
+
+StatusFields flatten_status_json(std::string_view json) {
+    StatusFields fields;
+    JsonFlattener(json, fields).flatten();
+    return fields;
+}
+
+bool status_fields_differ(const StatusFields& from, const StatusFields& to,
+                          const std::vector<std::string_view>& ignored) {
+    if (from.size() != to.size()) {
+        return true;
+    }
+    for (std::size_t i = 0; i < from.size(); ++i) {
+        if (from[i].first != to[i].first) {
+            return true;
+        }
+        if (from[i].second != to[i].second &&
+            std::find(ignored.begin(), ignored.end(), from[i].first) == ignored.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string encode_status_delta(const StatusFields& from, const StatusFields& to,
+                                std::string_view epoch, std::uint64_t from_version,
+                                std::uint64_t to_version) {
+    std::unordered_map<std::string_view, std::string_view> previous;
+    previous.reserve(from.size());
+    for (const auto& [path, value] : from) {
+        previous.emplace(path, value);
+    }
+
+    std::string delta = "{\"type\":\"status\",\"mode\":\"delta\",\"epoch\":";
+    append_json_string(delta, epoch);
+    delta += ",\"version\":";
+    delta += std::to_string(to_version);
+    delta += ",\"since\":";
+    delta += std::to_string(from_version);
+    delta += ",\"changes\":{";
+    bool first = true;
+    for (const auto& [path, value] : to) {
+        const auto it = previous.find(path);
+        if (it != previous.end()) {
+            const bool changed = it->second != value;
+            previous.erase(it);
+            if (!changed) {
+                continue;
+            }
+        }
+        if (!first) {
+            delta += ',';
+        }
+        first = false;
+        append_json_string(delta, path);
+        delta += ':';
+        delta += value;
+    }
+    delta += "},\"removed\":[";
+    first = true;
+    for (const auto& [path, value] : from) {
+        if (previous.count(path) == 0) {
+            continue;
+        }
+        if (!first) {
+            delta += ',';
+        }
+        first = false;
+        append_json_string(delta, path);
+    }
+    delta += "]}";
+    return delta;
+}
+
+std::string encode_status_full(std::string_view status_json, std::string_view epoch,
+                               std::uint64_t version) {
+    std::string full = "{\"type\":\"status\",\"mode\":\"full\",\"epoch\":";
+    append_json_string(full, epoch);
+    full += ",\"version\":";
+    full += std::to_string(version);
+    full += ",\"status\":";
+    full += status_json;
+    full += '}';
+    return full;
+}
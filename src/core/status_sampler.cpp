@@ -0,0 +1,204 @@
+#include "core/status_sampler.h"
+
+#include <charconv>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Fields that change with every sample without anything having happened: the
+// timestamp, uptimes (clients count them on from bootEpoch and upSinceEpoch),
+// probe counters and the latest single probe timings (the percentiles stay).
+// They alone do not make a new version; the next one carries their values.
+const std::vector<std::string_view> kPerSampleFields = {
+    "generatedAt",
+    "debian.uptimeSeconds",
+    "debian.uptimeHuman",
+    "websocket.uptimeSeconds",
+    "websocket.probes",
+    "websocket.probeFailures",
+    "websocket.connectMs",
+    "websocket.roundTripMs",
+};
+
+// 48 random bits as 12 hex digits: unique enough across restarts of one server,
+// short enough for every ETag and event id.
+std::string make_epoch() {
+    std::random_device random;
+    const std::uint64_t bits =
+        ((static_cast<std::uint64_t>(random()) << 32) | random()) & 0xFFFFFFFFFFFFull;
+    char digits[12];
+    for (int i = 11; i >= 0; --i) {
+        digits[i] = "0123456789abcdef"[(bits >> ((11 - i) * 4)) & 0xF];
+    }
+    return std::string(digits, sizeof(digits));
+}
+
+}  // namespace
+
+StatusSampler::StatusSampler(std::chrono::milliseconds interval, Collector collector,
+                             std::size_t history_size)
+    : epoch_(make_epoch()),
+      interval_(interval),
+      collector_(std::move(collector)),
+      history_size_(history_size) {}
+
+StatusSampler::~StatusSampler() {
+    stop();
+}
+
+void StatusSampler::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+    }
+    publish(collector_());
+    thread_ = std::thread(&StatusSampler::run, this);
+}
+
+void StatusSampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    changed_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void StatusSampler::add_listener(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.push_back(std::move(listener));
+}
+
+std::shared_ptr<const PublishedStatus> StatusSampler::latest() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+std::string StatusSampler::version_token(std::uint64_t version) const {
+    return epoch_ + "-" + std::to_string(version);
+}
+
+std::uint64_t StatusSampler::parse_version_token(std::string_view token) const {
+    if (token.size() <= epoch_.size() + 1 || token.substr(0, epoch_.size()) != epoch_ ||
+        token[epoch_.size()] != '-') {
+        return 0;
+    }
+    token.remove_prefix(epoch_.size() + 1);
+    std::uint64_t version = 0;
+    const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), version);
+    if (error != std::errc() || end != token.data() + token.size()) {
+        return 0;
+    }
+    return version;
+}
+
+StatusUpdate StatusSampler::update_since(std::uint64_t version) const {
+    std::shared_ptr<const PublishedStatus> latest;
+    std::shared_ptr<const PublishedStatus> base;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest = latest_;
+        if (latest && version != 0 && version < latest->version) {
+            // Versions are consecutive, so the base is found by offset.
+            const std::uint64_t oldest = history_.front()->version;
+            if (version >= oldest) {
+                base = history_[static_cast<std::size_t>(version - oldest)];
+            }
+        }
+    }
+
+    StatusUpdate update;
+    if (!latest) {
+        return update;
+    }
+    update.version = latest->version;
+    if (version == latest->version) {
+        return update;
+    }
+    if (!base) {
+        update.kind = StatusUpdateKind::kFull;
+        update.payload = latest->full_update;
+    } else if (base->version + 1 == latest->version) {
+        update.kind = StatusUpdateKind::kDelta;
+        update.payload = latest->delta_update;
+    } else {
+        update.kind = StatusUpdateKind::kDelta;
+        update.payload =
+            encode_status_delta(base->fields, latest->fields, epoch_, base->version,
+                                latest->version);
+    }
+    return update;
+}
+
+std::shared_ptr<const PublishedStatus> StatusSampler::wait_for_newer(
+    std::uint64_t version, std::chrono::steady_clock::time_point deadline) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait_until(lock, deadline, [&] {
+        return !running_ || (latest_ && latest_->version > version);
+    });
+    if (latest_ && latest_->version > version) {
+        return latest_;
+    }
+    return nullptr;
+}
+
+void StatusSampler::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        if (changed_.wait_for(lock, interval_, [this] { return !running_; })) {
+            break;
+        }
+        lock.unlock();
+        SystemStatusSnapshot snapshot = collector_();
+        publish(std::move(snapshot));
+        lock.lock();
+    }
+}
+
+void StatusSampler::publish(SystemStatusSnapshot snapshot) {
+    json_buffer_.clear();
+    append_system_status_json(json_buffer_, snapshot, JsonStyle::kCompact);
+    StatusFields fields = flatten_status_json(json_buffer_);
+
+    // Only the sampler thread publishes, so latest_ cannot change underneath us.
+    const std::shared_ptr<const PublishedStatus> previous = latest();
+    if (previous && !status_fields_differ(previous->fields, fields, kPerSampleFields)) {
+        return;
+    }
+
+    auto status = std::make_shared<PublishedStatus>();
+    status->json = json_buffer_;
+    status->fields = std::move(fields);
+    status->snapshot = std::move(snapshot);
+
+    const std::uint64_t version = previous ? previous->version + 1 : 1;
+    status->version = version;
+    status->full_update = encode_status_full(status->json, epoch_, version);
+    if (previous) {
+        status->delta_update = encode_status_delta(previous->fields, status->fields, epoch_,
+                                                   previous->version, version);
+    }
+
+    std::vector<Listener> listeners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_ = status;
+        history_.push_back(std::move(status));
+        while (history_.size() > history_size_) {
+            history_.pop_front();
+        }
+        listeners = listeners_;
+    }
+    changed_.notify_all();
+    for (const auto& listener : listeners) {
+        listener(version);
+    }
+}
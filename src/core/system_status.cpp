@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
 #include <chrono>
 #include <cmath>
@@ -11,10 +12,22 @@
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
+#include <mutex>
 #include <optional>
-#include <set>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "core/json_writer.h"
+#include "core/log.h"
+#include "core/metrics.h"
+#include "core/power_supply_monitor.h"
+#include "core/socket_owner_index.h"
+#include "core/trace.h"
+#include "core/websocket_probe.h"
 
 #if defined(__has_include)
 #if __has_include(<sdbus-c++/sdbus-c++.h>)
@@ -61,6 +74,19 @@ std::optional<double> parse_first_double(const std::string& text) {
     return value;
 }
 
+// The "btime" line of /proc/stat: boot time in seconds since the epoch. It
+// stays the same from sample to sample, unlike now - uptime.
+std::optional<long long> read_boot_time_epoch() {
+    std::ifstream file("/proc/stat");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("btime ", 0) == 0) {
+            return std::strtoll(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return std::nullopt;
+}
+
 std::array<double, 3> parse_load_average(const std::string& text) {
     std::array<double, 3> load{0.0, 0.0, 0.0};
     std::istringstream stream(text);
@@ -103,18 +129,18 @@ std::string format_iso_timestamp(
 #else
     localtime_r(&time, &tm);
 #endif
-    std::ostringstream formatted;
-    formatted << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return formatted.str();
+    char formatted[32];
+    const std::size_t length = std::strftime(formatted, sizeof(formatted), "%Y-%m-%d %H:%M:%S", &tm);
+    return std::string(formatted, length);
 }
 
-std::vector<std::uint16_t> parse_tcp_table(const std::filesystem::path& path) {
+std::vector<ListeningSocket> parse_tcp_table(const std::filesystem::path& path) {
     std::ifstream file(path);
     if (!file.is_open()) {
         return {};
     }
 
-    std::set<std::uint16_t> ports;
+    std::vector<ListeningSocket> sockets;
     std::string line;
     // Skip header
     if (!std::getline(file, line)) {
@@ -131,7 +157,14 @@ std::vector<std::uint16_t> parse_tcp_table(const std::filesystem::path& path) {
         std::string local_address;
         std::string remote_address;
         std::string state;
-        if (!(stream >> index >> local_address >> remote_address >> state)) {
+        std::string queues;
+        std::string timer;
+        std::string retransmits;
+        std::string uid;
+        std::string timeout;
+        std::uint64_t inode = 0;
+        if (!(stream >> index >> local_address >> remote_address >> state >> queues >> timer >>
+              retransmits >> uid >> timeout >> inode)) {
             continue;
         }
 
@@ -154,10 +187,42 @@ std::vector<std::uint16_t> parse_tcp_table(const std::filesystem::path& path) {
         if (port_value == 0 || port_value > 65535) {
             continue;
         }
-        ports.insert(static_cast<std::uint16_t>(port_value));
+        ListeningSocket socket;
+        socket.port = static_cast<std::uint16_t>(port_value);
+        socket.inode = inode;
+        sockets.push_back(std::move(socket));
+    }
+
+    return sockets;
+}
+
+// Fills in the owning process of each listening socket. The index is shared
+// between collections so only processes whose fd tables changed are re-read.
+void resolve_socket_owners(std::vector<ListeningSocket>& sockets) {
+    static std::mutex index_mutex;
+    static SocketOwnerIndex owner_index;
+
+    std::vector<std::uint64_t> inodes;
+    inodes.reserve(sockets.size());
+    for (const auto& socket : sockets) {
+        if (socket.inode != 0) {
+            inodes.push_back(socket.inode);
+        }
+    }
+
+    std::unordered_map<std::uint64_t, SocketOwner> owners;
+    {
+        std::lock_guard<std::mutex> lock(index_mutex);
+        owners = owner_index.resolve(inodes);
     }
 
-    return {ports.begin(), ports.end()};
+    for (auto& socket : sockets) {
+        const auto owner_it = owners.find(socket.inode);
+        if (owner_it != owners.end()) {
+            socket.pid = owner_it->second.pid;
+            socket.command = owner_it->second.command;
+        }
+    }
 }
 
 WifiStatus collect_wifi_status_proc() {
@@ -317,47 +382,10 @@ WifiStatus collect_wifi_status() {
 }
 
 BatteryStatus collect_battery_status() {
-    BatteryStatus battery;
-    namespace fs = std::filesystem;
-    const fs::path power_supply_dir("/sys/class/power_supply");
-    if (!fs::exists(power_supply_dir) || !fs::is_directory(power_supply_dir)) {
-        battery.state = "Unavailable";
-        return battery;
-    }
-
-    for (const auto& entry : fs::directory_iterator(power_supply_dir)) {
-        if (!entry.is_directory()) {
-            continue;
-        }
-
-        const fs::path& device_path = entry.path();
-        const std::string type = read_file_trimmed(device_path / "type");
-        if (type != "Battery") {
-            continue;
-        }
-
-        battery.present = true;
-        battery.state = read_file_trimmed(device_path / "status");
-        if (battery.state.empty()) {
-            battery.state = "Unknown";
-        }
-
-        const std::string capacity_text = read_file_trimmed(device_path / "capacity");
-        if (!capacity_text.empty()) {
-            try {
-                battery.percentage = std::stoi(capacity_text);
-            } catch (const std::exception&) {
-                battery.percentage = -1;
-            }
-        }
-        break;
-    }
-
-    if (!battery.present && battery.state.empty()) {
-        battery.state = "Unavailable";
-    }
-
-    return battery;
+    static std::mutex monitor_mutex;
+    static PowerSupplyMonitor monitor;
+    std::lock_guard<std::mutex> lock(monitor_mutex);
+    return monitor.current();
 }
 
 std::array<double, 3> collect_load_average() {
@@ -368,56 +396,6 @@ std::array<double, 3> collect_load_average() {
     return parse_load_average(contents);
 }
 
-std::string json_escape(const std::string& input) {
-    std::string escaped;
-    escaped.reserve(input.size() + 16);
-    for (char ch : input) {
-        switch (ch) {
-            case '\\':
-                escaped += "\\\\";
-                break;
-            case '\"':
-                escaped += "\\\"";
-                break;
-            case '\n':
-                escaped += "\\n";
-                break;
-            case '\r':
-                escaped += "\\r";
-                break;
-            case '\t':
-                escaped += "\\t";
-                break;
-            default:
-                if (static_cast<unsigned char>(ch) < 0x20) {
-                    std::ostringstream oss;
-                    oss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
-                        << static_cast<int>(static_cast<unsigned char>(ch));
-                    escaped += oss.str();
-                } else {
-                    escaped += ch;
-                }
-        }
-    }
-    return escaped;
-}
-
-std::string format_double(double value, int precision = 2) {
-    if (!std::isfinite(value)) {
-        return "null";
-    }
-    std::ostringstream stream;
-    stream << std::fixed << std::setprecision(precision) << value;
-    return stream.str();
-}
-
-std::string optional_double(double value, int precision = 2) {
-    if (!std::isfinite(value) || value < 0.0) {
-        return "null";
-    }
-    return format_double(value, precision);
-}
-
 std::optional<std::uint16_t> parse_port_env(const char* name) {
     const char* value = std::getenv(name);
     if (!value || *value == '\0') {
@@ -434,6 +412,20 @@ std::optional<std::uint16_t> parse_port_env(const char* name) {
     return static_cast<std::uint16_t>(parsed);
 }
 
+// Port of the standalone dial service that predates the /ws endpoint.
+constexpr std::uint16_t kLegacyWebsocketPort = 5001;
+
+std::atomic<std::uint16_t> g_status_http_port{0};
+
+bool dial_service_configured() {
+    for (const char* name : {"BEAVER_WS_ADDRESS", "BEAVER_WS_HOST", "BEAVER_WS_PORT"}) {
+        if (const char* value = std::getenv(name); value && *value) {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::string build_websocket_address(std::uint16_t port) {
     if (const char* explicit_address = std::getenv("BEAVER_WS_ADDRESS"); explicit_address && *explicit_address) {
         return std::string(explicit_address);
@@ -449,54 +441,215 @@ std::string build_websocket_address(std::uint16_t port) {
     return address.str();
 }
 
+// BEAVER_ALERTS_FILE, else config/alerts.conf next to the executable, so the
+// rules do not depend on the directory the server was started from.
+std::string alert_rules_path() {
+    if (const char* path = std::getenv("BEAVER_ALERTS_FILE"); path && *path) {
+        return path;
+    }
+    std::error_code error;
+    const std::filesystem::path executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error) {
+        return "config/alerts.conf";
+    }
+    return (executable.parent_path() / "config" / "alerts.conf").string();
+}
+
+std::vector<MetricSample> collect_metric_samples(const SystemStatusSnapshot& snapshot) {
+    std::vector<MetricSample> samples;
+    samples.reserve(12);
+    if (snapshot.battery.present && snapshot.battery.percentage >= 0) {
+        samples.push_back({"battery.percent", static_cast<double>(snapshot.battery.percentage)});
+    }
+    samples.push_back({"load.1m", snapshot.debian.load_average[0]});
+    samples.push_back({"load.5m", snapshot.debian.load_average[1]});
+    samples.push_back({"load.15m", snapshot.debian.load_average[2]});
+    if (snapshot.debian.uptime_seconds >= 0.0) {
+        samples.push_back({"uptime.seconds", snapshot.debian.uptime_seconds});
+    }
+    if (snapshot.wifi.available) {
+        samples.push_back({"wifi.connected", snapshot.wifi.connected ? 1.0 : 0.0});
+    }
+    samples.push_back({"websocket.listening", snapshot.websocket.listening ? 1.0 : 0.0});
+    samples.push_back({"websocket.reachable", snapshot.websocket.reachable ? 1.0 : 0.0});
+    if (snapshot.websocket.connect_ms >= 0.0) {
+        samples.push_back({"websocket.connect_ms", snapshot.websocket.connect_ms});
+    }
+    if (snapshot.websocket.round_trip_ms >= 0.0) {
+        samples.push_back({"websocket.round_trip_ms", snapshot.websocket.round_trip_ms});
+    }
+    samples.push_back({"network.listening_ports",
+                       static_cast<double>(snapshot.network.listening_ports.size())});
+    return samples;
+}
+
+void evaluate_alerts(SystemStatusSnapshot& snapshot) {
+    static std::mutex alerts_mutex;
+    static AlertEngine engine(load_alert_rules(alert_rules_path()));
+    std::lock_guard<std::mutex> lock(alerts_mutex);
+    if (engine.rule_count() == 0) {
+        return;
+    }
+
+    const auto transitions = engine.evaluate(collect_metric_samples(snapshot),
+                                             std::chrono::steady_clock::now(),
+                                             std::chrono::system_clock::now());
+    for (const auto& transition : transitions) {
+        if (transition.firing) {
+            log_warning("Alert %s firing (value %.2f)", transition.name.c_str(), transition.value);
+        } else if (transition.metric_missing) {
+            log_message("Alert %s resolved: metric no longer reported (last value %.2f)",
+                        transition.name.c_str(), transition.value);
+        } else {
+            log_message("Alert %s resolved (value %.2f)", transition.name.c_str(),
+                        transition.value);
+        }
+    }
+    snapshot.alerts = engine.active_alerts();
+}
+
+// Time spent in each collector of collect_system_status(), in /metrics.
+struct CollectorMetrics {
+    static Histogram& collector(const char* name) {
+        return metrics().histogram("beaver_status_collect_duration_seconds",
+                                   "Time spent collecting the system status, by collector.",
+                                   {{"collector", name}});
+    }
+
+    Histogram& uptime = collector("uptime");
+    Histogram& load_average = collector("load_average");
+    Histogram& sockets = collector("sockets");
+    Histogram& wifi = collector("wifi");
+    Histogram& battery = collector("battery");
+    Histogram& websocket = collector("websocket");
+    Histogram& alerts = collector("alerts");
+    Histogram& total = collector("total");
+};
+
+const CollectorMetrics& collector_metrics() {
+    static const CollectorMetrics collectors;
+    return collectors;
+}
+
+// Times one collector for /metrics and, while tracing, as a span.
+struct CollectorScope {
+    CollectorScope(Histogram& histogram, const char* span_name)
+        : timer(histogram), span(span_name) {}
+
+    ScopedTimer timer;
+    TraceSpan span;
+};
+
 }  // namespace
 
+std::string dial_service_address() {
+    return build_websocket_address(
+        parse_port_env("BEAVER_WS_PORT").value_or(kLegacyWebsocketPort));
+}
+
+void set_status_http_port(std::uint16_t port) {
+    g_status_http_port.store(port, std::memory_order_relaxed);
+}
+
 SystemStatusSnapshot collect_system_status() {
+    const CollectorMetrics& collectors = collector_metrics();
+    CollectorScope total_scope(collectors.total, "status.collect");
     SystemStatusSnapshot snapshot;
 
-    const auto uptime_contents = read_file_trimmed("/proc/uptime");
-    if (const auto uptime_value = parse_first_double(uptime_contents)) {
-        snapshot.debian.uptime_seconds = *uptime_value;
-        snapshot.debian.uptime_human = format_uptime(*uptime_value);
-        const auto boot_time_point = std::chrono::system_clock::now() -
-                                     std::chrono::duration<double>(*uptime_value);
-        snapshot.debian.boot_time_iso = format_iso_timestamp(boot_time_point);
-    }
-
-    const auto load_average = collect_load_average();
-    snapshot.debian.load_average[0] = load_average[0];
-    snapshot.debian.load_average[1] = load_average[1];
-    snapshot.debian.load_average[2] = load_average[2];
-
-    snapshot.network.listening_ports = parse_tcp_table("/proc/net/tcp");
-    const auto tcp6_ports = parse_tcp_table("/proc/net/tcp6");
-    snapshot.network.listening_ports.insert(snapshot.network.listening_ports.end(),
-                                            tcp6_ports.begin(), tcp6_ports.end());
-    std::sort(snapshot.network.listening_ports.begin(), snapshot.network.listening_ports.end());
-    snapshot.network.listening_ports.erase(
-        std::unique(snapshot.network.listening_ports.begin(), snapshot.network.listening_ports.end()),
-        snapshot.network.listening_ports.end());
-
-    snapshot.wifi = collect_wifi_status();
-    snapshot.battery = collect_battery_status();
-
-    snapshot.websocket.last_message.clear();
-    snapshot.websocket.address.clear();
-    snapshot.websocket.listening = false;
-    snapshot.websocket.uptime_seconds = -1.0;
-
-    const auto is_port_open = [&](std::uint16_t port) {
-        return std::binary_search(snapshot.network.listening_ports.begin(),
-                                  snapshot.network.listening_ports.end(), port);
-    };
+    {
+        CollectorScope scope(collectors.uptime, "status.uptime");
+        const auto uptime_contents = read_file_trimmed("/proc/uptime");
+        if (const auto uptime_value = parse_first_double(uptime_contents)) {
+            snapshot.debian.uptime_seconds = *uptime_value;
+            snapshot.debian.uptime_human = format_uptime(*uptime_value);
+            if (const auto boot_time = read_boot_time_epoch()) {
+                snapshot.debian.boot_epoch_seconds = *boot_time;
+                snapshot.debian.boot_time_iso = format_iso_timestamp(
+                    std::chrono::system_clock::from_time_t(static_cast<std::time_t>(*boot_time)));
+            } else {
+                const auto boot_time_point = std::chrono::system_clock::now() -
+                                             std::chrono::duration<double>(*uptime_value);
+                snapshot.debian.boot_time_iso = format_iso_timestamp(boot_time_point);
+            }
+        }
+    }
 
-    if (const auto configured_port = parse_port_env("BEAVER_WS_PORT")) {
-        snapshot.websocket.address = build_websocket_address(*configured_port);
-        snapshot.websocket.listening = is_port_open(*configured_port);
-    } else {
-        constexpr std::uint16_t kLegacyWebsocketPort = 5001;
-        snapshot.websocket.address = build_websocket_address(kLegacyWebsocketPort);
-        snapshot.websocket.listening = is_port_open(kLegacyWebsocketPort);
+    {
+        CollectorScope scope(collectors.load_average, "status.load_average");
+        const auto load_average = collect_load_average();
+        snapshot.debian.load_average[0] = load_average[0];
+        snapshot.debian.load_average[1] = load_average[1];
+        snapshot.debian.load_average[2] = load_average[2];
+    }
+
+    {
+        CollectorScope scope(collectors.sockets, "status.sockets");
+        auto sockets = parse_tcp_table("/proc/net/tcp");
+        auto tcp6_sockets = parse_tcp_table("/proc/net/tcp6");
+        sockets.insert(sockets.end(), std::make_move_iterator(tcp6_sockets.begin()),
+                       std::make_move_iterator(tcp6_sockets.end()));
+        resolve_socket_owners(sockets);
+        // IPv4 and IPv6 listeners of the same service collapse into one entry.
+        std::sort(sockets.begin(), sockets.end(),
+                  [](const ListeningSocket& left, const ListeningSocket& right) {
+                      return std::tie(left.port, left.pid) < std::tie(right.port, right.pid);
+                  });
+        sockets.erase(std::unique(sockets.begin(), sockets.end(),
+                                  [](const ListeningSocket& left, const ListeningSocket& right) {
+                                      return left.port == right.port && left.pid == right.pid;
+                                  }),
+                      sockets.end());
+        for (const auto& socket : sockets) {
+            if (snapshot.network.listening_ports.empty() ||
+                snapshot.network.listening_ports.back() != socket.port) {
+                snapshot.network.listening_ports.push_back(socket.port);
+            }
+        }
+        snapshot.network.listening_sockets = std::move(sockets);
+    }
+
+    {
+        CollectorScope scope(collectors.wifi, "status.wifi");
+        snapshot.wifi = collect_wifi_status();
+    }
+    {
+        CollectorScope scope(collectors.battery, "status.battery");
+        snapshot.battery = collect_battery_status();
+    }
+
+    {
+        CollectorScope scope(collectors.websocket, "status.websocket");
+        snapshot.websocket.last_message.clear();
+        snapshot.websocket.address.clear();
+        snapshot.websocket.listening = false;
+        snapshot.websocket.uptime_seconds = -1.0;
+
+        const auto is_port_open = [&](std::uint16_t port) {
+            return std::binary_search(snapshot.network.listening_ports.begin(),
+                                      snapshot.network.listening_ports.end(), port);
+        };
+
+        const std::uint16_t http_port = g_status_http_port.load(std::memory_order_relaxed);
+        if (http_port != 0 && !dial_service_configured()) {
+            snapshot.websocket.address = "ws://127.0.0.1:" + std::to_string(http_port) + "/ws";
+            snapshot.websocket.listening = is_port_open(http_port);
+        } else {
+            const std::uint16_t port =
+                parse_port_env("BEAVER_WS_PORT").value_or(kLegacyWebsocketPort);
+            snapshot.websocket.address = build_websocket_address(port);
+            snapshot.websocket.listening = is_port_open(port);
+        }
+
+        // The probe runs on its own thread and keeps latency history and
+        // reachability uptime across snapshots; this only copies its results.
+        // Never destroyed, so exit does not wait for a probe in flight.
+        static WebSocketProbe& probe = *new WebSocketProbe();
+        probe.update(snapshot.websocket.address, snapshot.websocket);
+    }
+
+    {
+        CollectorScope scope(collectors.alerts, "status.alerts");
+        evaluate_alerts(snapshot);
     }
 
     snapshot.generated_at_iso = format_iso_timestamp(std::chrono::system_clock::now());
@@ -504,51 +657,108 @@ SystemStatusSnapshot collect_system_status() {
     return snapshot;
 }
 
-std::string system_status_to_json(const SystemStatusSnapshot& status) {
-    std::ostringstream json;
-    json << "{\n";
-    json << "  \"generatedAt\": \"" << json_escape(status.generated_at_iso) << "\",\n";
-    json << "  \"wifi\": {\n";
-    json << "    \"available\": " << (status.wifi.available ? "true" : "false") << ",\n";
-    json << "    \"connected\": " << (status.wifi.connected ? "true" : "false") << ",\n";
-    json << "    \"interface\": \"" << json_escape(status.wifi.interface_name) << "\",\n";
-    json << "    \"status\": \"" << json_escape(status.wifi.status_text) << "\"\n";
-    json << "  },\n";
-    json << "  \"websocket\": {\n";
-    json << "    \"listening\": " << (status.websocket.listening ? "true" : "false") << ",\n";
-    json << "    \"address\": \"" << json_escape(status.websocket.address) << "\",\n";
-    json << "    \"lastMessage\": \"" << json_escape(status.websocket.last_message) << "\",\n";
-    json << "    \"uptimeSeconds\": " << optional_double(status.websocket.uptime_seconds, 2)
-         << "\n";
-    json << "  },\n";
-    json << "  \"battery\": {\n";
-    json << "    \"present\": " << (status.battery.present ? "true" : "false") << ",\n";
+void append_system_status_json(std::string& out, const SystemStatusSnapshot& status,
+                               JsonStyle style) {
+    JsonWriter json(out, style);
+    json.begin_object();
+    json.key("generatedAt").string(status.generated_at_iso);
+
+    json.key("wifi").begin_object();
+    json.key("available").boolean(status.wifi.available);
+    json.key("connected").boolean(status.wifi.connected);
+    json.key("interface").string(status.wifi.interface_name);
+    json.key("status").string(status.wifi.status_text);
+    json.end_object();
+
+    const auto append_latency = [&json](const char* name, const LatencySummary& summary) {
+        json.key(name).begin_object();
+        json.key("samples").number(summary.samples);
+        json.key("p50Ms").optional_number(summary.p50_ms, 3);
+        json.key("p90Ms").optional_number(summary.p90_ms, 3);
+        json.key("p99Ms").optional_number(summary.p99_ms, 3);
+        json.end_object();
+    };
+    json.key("websocket").begin_object();
+    json.key("listening").boolean(status.websocket.listening);
+    json.key("address").string(status.websocket.address);
+    json.key("lastMessage").string(status.websocket.last_message);
+    json.key("uptimeSeconds").optional_number(status.websocket.uptime_seconds, 2);
+    json.key("upSinceEpoch").optional_number(status.websocket.up_since_epoch_seconds, 3);
+    json.key("reachable").boolean(status.websocket.reachable);
+    json.key("probeError").string(status.websocket.probe_error);
+    json.key("connectMs").optional_number(status.websocket.connect_ms, 3);
+    json.key("roundTripMs").optional_number(status.websocket.round_trip_ms, 3);
+    append_latency("connectLatency", status.websocket.connect_latency);
+    append_latency("roundTripLatency", status.websocket.round_trip_latency);
+    json.key("probes").number(status.websocket.probes);
+    json.key("probeFailures").number(status.websocket.probe_failures);
+    json.end_object();
+
+    json.key("battery").begin_object();
+    json.key("present").boolean(status.battery.present);
+    json.key("percentage");
     if (status.battery.percentage >= 0) {
-        json << "    \"percentage\": " << status.battery.percentage << ",\n";
+        json.number(status.battery.percentage);
     } else {
-        json << "    \"percentage\": null,\n";
-    }
-    json << "    \"state\": \"" << json_escape(status.battery.state) << "\"\n";
-    json << "  },\n";
-    json << "  \"debian\": {\n";
-    json << "    \"uptimeSeconds\": " << optional_double(status.debian.uptime_seconds, 2) << ",\n";
-    json << "    \"uptimeHuman\": \"" << json_escape(status.debian.uptime_human) << "\",\n";
-    json << "    \"bootTime\": \"" << json_escape(status.debian.boot_time_iso) << "\",\n";
-    json << "    \"loadAverage\": [" << format_double(status.debian.load_average[0], 2) << ", "
-         << format_double(status.debian.load_average[1], 2) << ", "
-         << format_double(status.debian.load_average[2], 2) << "]\n";
-    json << "  },\n";
-    json << "  \"network\": {\n";
-    json << "    \"listeningPorts\": [";
-    for (std::size_t i = 0; i < status.network.listening_ports.size(); ++i) {
-        if (i > 0) {
-            json << ", ";
+        json.null();
+    }
+    json.key("state").string(status.battery.state);
+    json.end_object();
+
+    json.key("debian").begin_object();
+    json.key("uptimeSeconds").optional_number(status.debian.uptime_seconds, 2);
+    json.key("uptimeHuman").string(status.debian.uptime_human);
+    json.key("bootTime").string(status.debian.boot_time_iso);
+    json.key("bootEpoch").optional_number(static_cast<double>(status.debian.boot_epoch_seconds), 0);
+    json.key("loadAverage").begin_array();
+    for (double load : status.debian.load_average) {
+        json.number(load, 2);
+    }
+    json.end_array();
+    json.end_object();
+
+    json.key("network").begin_object();
+    json.key("listeningPorts").begin_array();
+    for (const auto port : status.network.listening_ports) {
+        json.number(port);
+    }
+    json.end_array();
+    json.key("listeningSockets").begin_array();
+    for (const auto& socket : status.network.listening_sockets) {
+        json.begin_object();
+        json.key("port").number(socket.port);
+        json.key("pid");
+        if (socket.pid > 0) {
+            json.number(socket.pid);
+        } else {
+            json.null();
         }
-        json << status.network.listening_ports[i];
+        json.key("command").string(socket.command);
+        json.end_object();
     }
-    json << "]\n";
-    json << "  }\n";
-    json << "}\n";
-    return json.str();
+    json.end_array();
+    json.end_object();
+
+    json.key("alerts").begin_array();
+    for (const auto& alert : status.alerts) {
+        json.begin_object();
+        json.key("name").string(alert.name);
+        json.key("metric").string(alert.metric);
+        json.key("comparator").string(alert_comparator_symbol(alert.comparator));
+        json.key("threshold").number(alert.threshold, 2);
+        json.key("value").number(alert.value, 2);
+        json.key("since").string(format_iso_timestamp(alert.since));
+        json.end_object();
+    }
+    json.end_array();
+
+    json.end_object();
+    json.finish();
 }
 
+std::string system_status_to_json(const SystemStatusSnapshot& status, JsonStyle style) {
+    std::string json;
+    json.reserve(2048);
+    append_system_status_json(json, status, style);
+    return json;
+}
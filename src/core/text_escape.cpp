@@ -0,0 +1,282 @@
+#include "core/text_escape.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define BEAVER_ESCAPE_X86 1
+#include <immintrin.h>
+#else
+#define BEAVER_ESCAPE_X86 0
+#endif
+
+namespace {
+
+enum class EscapeSet { kHtml, kJson };
+
+using FindSpecial = std::size_t (*)(const char* data, std::size_t position, std::size_t size);
+
+struct EscapeKernels {
+    FindSpecial html = nullptr;
+    FindSpecial json = nullptr;
+    const char* name = "scalar";
+};
+
+template <EscapeSet Set>
+constexpr std::array<bool, 256> make_special_table() {
+    std::array<bool, 256> table{};
+    if constexpr (Set == EscapeSet::kHtml) {
+        for (unsigned char ch : {'&', '<', '>', '"', '\''}) {
+            table[ch] = true;
+        }
+    } else {
+        for (std::size_t ch = 0; ch < 0x20; ++ch) {
+            table[ch] = true;
+        }
+        table['"'] = true;
+        table['\\'] = true;
+    }
+    return table;
+}
+
+template <EscapeSet Set>
+constexpr std::array<bool, 256> kSpecial = make_special_table<Set>();
+
+// Each find_special_* returns the index of the first character at or after
+// `position` that needs escaping, or `size` when the rest of the text is clean.
+template <EscapeSet Set>
+std::size_t find_special_scalar(const char* data, std::size_t position, std::size_t size) {
+    while (position < size && !kSpecial<Set>[static_cast<unsigned char>(data[position])]) {
+        ++position;
+    }
+    return position;
+}
+
+#if BEAVER_ESCAPE_X86
+
+template <EscapeSet Set>
+inline __m128i special_bytes_sse2(__m128i chunk) {
+    if constexpr (Set == EscapeSet::kHtml) {
+        const __m128i amp = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&'));
+        const __m128i lt = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('<'));
+        const __m128i gt = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>'));
+        const __m128i quote = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+        const __m128i apostrophe = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\''));
+        return _mm_or_si128(_mm_or_si128(_mm_or_si128(amp, lt), _mm_or_si128(gt, quote)),
+                            apostrophe);
+    } else {
+        // Unsigned ch <= 0x1F is max(ch, 0x1F) == 0x1F.
+        const __m128i limit = _mm_set1_epi8(0x1F);
+        const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, limit), limit);
+        const __m128i quote = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+        const __m128i backslash = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+        return _mm_or_si128(control, _mm_or_si128(quote, backslash));
+    }
+}
+
+template <EscapeSet Set>
+std::size_t find_special_sse2(const char* data, std::size_t position, std::size_t size) {
+    while (position + 16 <= size) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        const unsigned mask =
+            static_cast<unsigned>(_mm_movemask_epi8(special_bytes_sse2<Set>(chunk)));
+        if (mask != 0) {
+            return position + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        position += 16;
+    }
+    return find_special_scalar<Set>(data, position, size);
+}
+
+template <EscapeSet Set>
+__attribute__((target("avx2"))) inline __m256i special_bytes_avx2(__m256i chunk) {
+    if constexpr (Set == EscapeSet::kHtml) {
+        const __m256i amp = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('&'));
+        const __m256i lt = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('<'));
+        const __m256i gt = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('>'));
+        const __m256i quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+        const __m256i apostrophe = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\''));
+        return _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(amp, lt), _mm256_or_si256(gt, quote)), apostrophe);
+    } else {
+        const __m256i limit = _mm256_set1_epi8(0x1F);
+        const __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, limit), limit);
+        const __m256i quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+        const __m256i backslash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+        return _mm256_or_si256(control, _mm256_or_si256(quote, backslash));
+    }
+}
+
+template <EscapeSet Set>
+__attribute__((target("avx2"))) std::size_t find_special_avx2(const char* data,
+                                                              std::size_t position,
+                                                              std::size_t size) {
+    while (position + 32 <= size) {
+        const __m256i chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        const unsigned mask =
+            static_cast<unsigned>(_mm256_movemask_epi8(special_bytes_avx2<Set>(chunk)));
+        if (mask != 0) {
+            return position + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        position += 32;
+    }
+    // Short labels never reach the 32-byte loop. The tail stays in this function
+    // so it is VEX-encoded too: jumping into the legacy-SSE kernel with dirty
+    // upper YMM state costs more than the whole scan.
+    if (position + 16 <= size) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        const unsigned mask =
+            static_cast<unsigned>(_mm_movemask_epi8(special_bytes_sse2<Set>(chunk)));
+        if (mask != 0) {
+            return position + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        position += 16;
+    }
+    while (position < size && !kSpecial<Set>[static_cast<unsigned char>(data[position])]) {
+        ++position;
+    }
+    return position;
+}
+
+#endif  // BEAVER_ESCAPE_X86
+
+EscapeKernels select_kernels() {
+    EscapeKernels scalar{find_special_scalar<EscapeSet::kHtml>,
+                         find_special_scalar<EscapeSet::kJson>, "scalar"};
+    // BEAVER_ESCAPE_KERNEL=scalar|sse2 pins a slower kernel, e.g. for benchmarks.
+    const char* forced = std::getenv("BEAVER_ESCAPE_KERNEL");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return scalar;
+    }
+#if BEAVER_ESCAPE_X86
+    const EscapeKernels sse2{find_special_sse2<EscapeSet::kHtml>,
+                             find_special_sse2<EscapeSet::kJson>, "sse2"};
+    if (forced && std::strcmp(forced, "sse2") == 0) {
+        return sse2;
+    }
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {find_special_avx2<EscapeSet::kHtml>, find_special_avx2<EscapeSet::kJson>,
+                "avx2"};
+    }
+    return sse2;
+#else
+    return scalar;
+#endif
+}
+
+const EscapeKernels& kernels() {
+    static const EscapeKernels selected = select_kernels();
+    return selected;
+}
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+void append_html_replacement(std::string& out, char ch) {
+    switch (ch) {
+        case '&':
+            out += "&amp;";
+            break;
+        case '<':
+            out += "&lt;";
+            break;
+        case '>':
+            out += "&gt;";
+            break;
+        case '"':
+            out += "&quot;";
+            break;
+        default:
+            out += "&#39;";
+            break;
+    }
+}
+
+void append_json_replacement(std::string& out, char ch) {
+    switch (ch) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default: {
+            const unsigned char code = static_cast<unsigned char>(ch);
+            const char escaped[] = {'\\', 'u', '0', '0', kHexDigits[code >> 4],
+                                    kHexDigits[code & 0x0f]};
+            out.append(escaped, sizeof(escaped));
+            break;
+        }
+    }
+}
+
+template <typename Replace>
+void append_escaped(std::string& out, std::string_view text, FindSpecial find_special,
+                    Replace&& replace) {
+    const char* data = text.data();
+    const std::size_t size = text.size();
+    std::size_t position = find_special(data, 0, size);
+    if (position == size) {
+        out.append(data, size);
+        return;
+    }
+    out.reserve(out.size() + size + size / 4 + 8);
+    std::size_t run_start = 0;
+    while (position < size) {
+        out.append(data + run_start, position - run_start);
+        replace(out, data[position]);
+        run_start = position + 1;
+        position = find_special(data, run_start, size);
+    }
+    out.append(data + run_start, size - run_start);
+}
+
+}  // namespace
+
+void append_html_escaped(std::string& out, std::string_view text) {
+    append_escaped(out, text, kernels().html, append_html_replacement);
+}
+
+void append_json_escaped(std::string& out, std::string_view text) {
+    append_escaped(out, text, kernels().json, append_json_replacement);
+}
+
+void append_json_for_script(std::string& out, std::string_view json) {
+    std::size_t run_start = 0;
+    for (std::size_t position = json.find_first_of("<>&"); position != std::string_view::npos;
+         position = json.find_first_of("<>&", run_start)) {
+        out.append(json.data() + run_start, position - run_start);
+        out += json[position] == '<' ? "\\u003c" : json[position] == '>' ? "\\u003e" : "\\u0026";
+        run_start = position + 1;
+    }
+    out.append(json.data() + run_start, json.size() - run_start);
+}
+
+std::string html_escape(std::string_view text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    append_html_escaped(escaped, text);
+    return escaped;
+}
+
+const char* text_escape_kernel_name() {
+    return kernels().name;
+}
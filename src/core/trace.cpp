@@ -0,0 +1,236 @@
+#include "core/trace.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/json_writer.h"
+#include "core/log.h"
+
+namespace {
+
+struct TraceEvent {
+    const char* name = nullptr;
+    std::int64_t start_ns = 0;
+    std::int64_t duration_ns = 0;
+    char detail[40] = {};
+};
+
+// Recent spans of one thread. The lock is only contended while a dump copies
+// the ring, so recording stays cheap.
+struct ThreadTraceBuffer {
+    static constexpr std::size_t kCapacity = 8192;
+
+    explicit ThreadTraceBuffer(int thread_id) : thread_id(thread_id) {}
+
+    const int thread_id;
+    std::mutex mutex;
+    std::array<TraceEvent, kCapacity> events;
+    std::uint64_t written = 0;
+};
+
+std::mutex g_buffers_mutex;
+std::vector<std::shared_ptr<ThreadTraceBuffer>> g_buffers;
+
+ThreadTraceBuffer& thread_buffer() {
+    thread_local std::shared_ptr<ThreadTraceBuffer> buffer;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(g_buffers_mutex);
+        buffer = std::make_shared<ThreadTraceBuffer>(static_cast<int>(g_buffers.size()) + 1);
+        g_buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+std::int64_t steady_nanoseconds(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::int64_t now_nanoseconds() {
+    return steady_nanoseconds(std::chrono::steady_clock::now());
+}
+
+// Signal-driven captures: the handler only pokes a pipe, the control thread
+// does the work.
+int g_signal_pipe[2] = {-1, -1};
+
+void on_trace_signal(int /*signal_number*/) {
+    const int saved_errno = errno;
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = write(g_signal_pipe[1], &byte, 1);
+    errno = saved_errno;
+}
+
+std::string trace_file_path() {
+    const std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    localtime_r(&now, &tm);
+    char name[64];
+    std::strftime(name, sizeof(name), "trace-%Y%m%d-%H%M%S.json", &tm);
+    return (std::filesystem::path("logs") / name).string();
+}
+
+void run_trace_controls() {
+    bool capturing = false;
+    auto capture_started = std::chrono::steady_clock::now();
+    for (;;) {
+        char byte = 0;
+        const ssize_t received = read(g_signal_pipe[0], &byte, 1);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return;
+        }
+        if (!capturing) {
+            capture_started = std::chrono::steady_clock::now();
+            start_tracing();
+            capturing = true;
+            log_message("Tracing started; send the signal again to write the trace");
+            continue;
+        }
+
+        const std::string json = trace_events_json(capture_started);
+        stop_tracing();
+        capturing = false;
+        const std::string path = trace_file_path();
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << json;
+        if (file) {
+            log_message("Trace written to %s", path.c_str());
+        } else {
+            log_warning("Could not write trace to %s", path.c_str());
+        }
+    }
+}
+
+}  // namespace
+
+void start_tracing() {
+    trace_internal::active_captures.fetch_add(1, std::memory_order_relaxed);
+}
+
+void stop_tracing() {
+    trace_internal::active_captures.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TraceSpan::begin(const char* name, std::string_view detail) {
+    name_ = name;
+    detail_ = detail;
+    start_ns_ = now_nanoseconds();
+}
+
+void TraceSpan::end() {
+    const std::int64_t end_ns = now_nanoseconds();
+    ThreadTraceBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceEvent& event = buffer.events[buffer.written % ThreadTraceBuffer::kCapacity];
+    event.name = name_;
+    event.start_ns = start_ns_;
+    event.duration_ns = end_ns - start_ns_;
+    std::size_t length = std::min(detail_.size(), sizeof(event.detail) - 1);
+    // Do not cut a UTF-8 sequence in half.
+    while (length < detail_.size() && length > 0 &&
+           (static_cast<unsigned char>(detail_[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    std::memcpy(event.detail, detail_.data(), length);
+    event.detail[length] = '\0';
+    ++buffer.written;
+}
+
+std::string trace_events_json(std::chrono::steady_clock::time_point since) {
+    const std::int64_t since_ns = steady_nanoseconds(since);
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_buffers_mutex);
+        buffers = g_buffers;
+    }
+
+    const int pid = static_cast<int>(getpid());
+    std::string out;
+    JsonWriter json(out, JsonStyle::kCompact);
+    json.begin_object();
+    json.key("displayTimeUnit").string("ms");
+    json.key("traceEvents").begin_array();
+    std::vector<TraceEvent> events;
+    for (const auto& buffer : buffers) {
+        events.clear();
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            const std::uint64_t count =
+                std::min<std::uint64_t>(buffer->written, ThreadTraceBuffer::kCapacity);
+            for (std::uint64_t i = buffer->written - count; i < buffer->written; ++i) {
+                const TraceEvent& event = buffer->events[i % ThreadTraceBuffer::kCapacity];
+                if (event.start_ns + event.duration_ns >= since_ns) {
+                    events.push_back(event);
+                }
+            }
+        }
+        if (events.empty()) {
+            continue;
+        }
+
+        json.begin_object();
+        json.key("name").string("thread_name");
+        json.key("ph").string("M");
+        json.key("pid").number(pid);
+        json.key("tid").number(buffer->thread_id);
+        json.key("args").begin_object();
+        json.key("name").string("thread " + std::to_string(buffer->thread_id));
+        json.end_object();
+        json.end_object();
+
+        for (const TraceEvent& event : events) {
+            const std::string_view name(event.name);
+            const std::size_t dot = name.find('.');
+            json.begin_object();
+            json.key("name").string(name);
+            json.key("cat").string(dot == std::string_view::npos ? name : name.substr(0, dot));
+            json.key("ph").string("X");
+            json.key("ts").number(static_cast<double>(event.start_ns) / 1000.0, 3);
+            json.key("dur").number(static_cast<double>(event.duration_ns) / 1000.0, 3);
+            json.key("pid").number(pid);
+            json.key("tid").number(buffer->thread_id);
+            if (event.detail[0] != '\0') {
+                json.key("args").begin_object();
+                json.key("detail").string(event.detail);
+                json.end_object();
+            }
+            json.end_object();
+        }
+    }
+    json.end_array();
+    json.end_object();
+    json.finish();
+    return out;
+}
+
+void install_trace_controls(int signal_number) {
+    if (const char* enabled = std::getenv("BEAVER_TRACE");
+        enabled != nullptr && std::strcmp(enabled, "1") == 0) {
+        start_tracing();
+    }
+
+    if (g_signal_pipe[0] >= 0 || pipe2(g_signal_pipe, O_CLOEXEC) != 0) {
+        return;
+    }
+    fcntl(g_signal_pipe[1], F_SETFL, O_NONBLOCK);
+    std::signal(signal_number, on_trace_signal);
+    std::thread(run_trace_controls).detach();
+}
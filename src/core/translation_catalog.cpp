@@ -1,15 +1,37 @@
 #include "core/translation_catalog.h"
 
 #include <cctype>
-#include <filesystem>
-#include <fstream>
 #include <utility>
 
-#include <glib.h>
+#include "core/log.h"
+#include "core/metrics.h"
+#include "core/resource_bundle.h"
 
-TranslationCatalog::TranslationCatalog(std::string locales_directory)
-    : translations_({{Language::English, load_language_file(locales_directory, "en")},
-                     {Language::French, load_language_file(locales_directory, "fr")}}) {}
+namespace {
+
+Counter& miss_counter(const char* language, const char* result) {
+    return metrics().counter("beaver_translation_misses",
+                             "Translation lookups not answered by the requested language.",
+                             {{"language", language}, {"result", result}});
+}
+
+enum class TranslationMiss { kFallback, kMissing };
+
+// Counts lookups the requested language could not answer: "fallback" when the
+// English text was used instead, "missing" when the key itself was returned.
+void record_translation_miss(Language language, TranslationMiss miss) {
+    static Counter* const counters[2][2] = {
+        {&miss_counter("fr", "fallback"), &miss_counter("fr", "missing")},
+        {&miss_counter("en", "fallback"), &miss_counter("en", "missing")},
+    };
+    counters[language == Language::French ? 0 : 1][static_cast<int>(miss)]->inc();
+}
+
+}  // namespace
+
+TranslationCatalog::TranslationCatalog(std::string locales_root)
+    : translations_({{Language::English, load_language_file(locales_root, "en")},
+                     {Language::French, load_language_file(locales_root, "fr")}}) {}
 
 std::string TranslationCatalog::translate(const std::string& key, Language language) const {
     const auto language_it = translations_.find(language);
@@ -26,28 +48,34 @@ std::string TranslationCatalog::translate(const std::string& key, Language langu
         const auto& english_map = english_it->second;
         const auto translation_it = english_map.find(key);
         if (translation_it != english_map.end()) {
+            record_translation_miss(language, TranslationMiss::kFallback);
             return translation_it->second;
         }
     }
 
+    record_translation_miss(language, TranslationMiss::kMissing);
     return key;
 }
 
 TranslationCatalog::TranslationMap TranslationCatalog::load_language_file(
-    const std::string& locales_directory, const std::string& language_code) {
+    const std::string& locales_root, const std::string& language_code) {
     TranslationMap translations;
 
-    namespace fs = std::filesystem;
-    const fs::path file_path = fs::path(locales_directory) / language_code / "strings.txt";
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        g_warning("TranslationCatalog could not open locale file: %s", file_path.string().c_str());
+    const std::string file_path = locales_root + "/" + language_code + "/strings.txt";
+    const std::shared_ptr<const Resource> file = find_resource(file_path);
+    if (!file) {
+        log_warning("TranslationCatalog could not open locale file: %s", file_path.c_str());
         return translations;
     }
 
-    std::string line;
+    std::string_view remaining = file->data;
     std::size_t inserted = 0;
-    while (std::getline(file, line)) {
+    while (!remaining.empty()) {
+        const std::size_t line_end = remaining.find('\n');
+        std::string line(remaining.substr(0, line_end));
+        remaining.remove_prefix(line_end == std::string_view::npos ? remaining.size()
+                                                                   : line_end + 1);
+
         const std::size_t comment_position = line.find('#');
         if (comment_position != std::string::npos) {
             line = line.substr(0, comment_position);
@@ -66,8 +94,8 @@ TranslationCatalog::TranslationMap TranslationCatalog::load_language_file(
         }
     }
 
-    g_message("TranslationCatalog loaded %zu entries for language '%s' from %s", inserted,
-              language_code.c_str(), file_path.string().c_str());
+    log_message("TranslationCatalog loaded %zu entries for language '%s' from %s (%s)",
+                inserted, language_code.c_str(), file_path.c_str(), resource_source());
 
     return translations;
 }
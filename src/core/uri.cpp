@@ -0,0 +1,75 @@
+#include "core/uri.h"
+
+#include <cctype>
+
+namespace {
+
+bool is_scheme_char(char ch) {
+    return std::isalnum(static_cast<unsigned char>(ch)) != 0 || ch == '+' || ch == '-' ||
+           ch == '.';
+}
+
+}  // namespace
+
+bool parse_uri(std::string_view uri, UriParts& parts) {
+    // scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." )
+    const std::size_t colon = uri.find(':');
+    if (colon == std::string_view::npos || colon == 0 ||
+        std::isalpha(static_cast<unsigned char>(uri[0])) == 0) {
+        return false;
+    }
+    parts = UriParts{};
+    for (std::size_t i = 0; i < colon; ++i) {
+        if (!is_scheme_char(uri[i])) {
+            return false;
+        }
+        parts.scheme.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(uri[i]))));
+    }
+
+    std::string_view rest = uri.substr(colon + 1);
+    if (rest.substr(0, 2) != "//") {
+        return true;
+    }
+    std::string_view authority = rest.substr(2, rest.find_first_of("/?#", 2) - 2);
+    if (const std::size_t at = authority.rfind('@'); at != std::string_view::npos) {
+        authority.remove_prefix(at + 1);
+    }
+
+    std::string_view port;
+    if (!authority.empty() && authority.front() == '[') {
+        // IP literal: "[::1]:8080"; the brackets are not part of the host.
+        const std::size_t close = authority.find(']');
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        parts.host = std::string(authority.substr(1, close - 1));
+        authority.remove_prefix(close + 1);
+        if (!authority.empty()) {
+            if (authority.front() != ':') {
+                return false;
+            }
+            port = authority.substr(1);
+        }
+    } else {
+        const std::size_t port_colon = authority.rfind(':');
+        parts.host = std::string(authority.substr(0, port_colon));
+        if (port_colon != std::string_view::npos) {
+            port = authority.substr(port_colon + 1);
+        }
+    }
+
+    if (!port.empty()) {
+        int value = 0;
+        for (const char ch : port) {
+            if (std::isdigit(static_cast<unsigned char>(ch)) == 0 || value > 65535) {
+                return false;
+            }
+            value = value * 10 + (ch - '0');
+        }
+        if (value > 65535) {
+            return false;
+        }
+        parts.port = value;
+    }
+    return true;
+}
@@ -0,0 +1,528 @@
+#include "core/websocket_probe.h"
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <random>
+#include <string_view>
+
+#include "core/websocket_protocol.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kMaxHandshakeBytes = 8192;
+constexpr std::uint64_t kMaxProbeFramePayload = 64 * 1024;
+constexpr std::string_view kPingPayload = "beaver-probe";
+// The probe thread stops probing when update() has not been called for this long.
+constexpr std::chrono::seconds kProbeIdleAfter{30};
+
+double elapsed_ms(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int remaining_ms(Clock::time_point deadline) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+bool wait_for(int fd, short events, Clock::time_point deadline) {
+    for (;;) {
+        const int timeout = remaining_ms(deadline);
+        if (timeout <= 0) {
+            return false;
+        }
+        pollfd descriptor{fd, events, 0};
+        const int ready = poll(&descriptor, 1, timeout);
+        if (ready > 0) {
+            return (descriptor.revents & (events | POLLERR | POLLHUP)) != 0;
+        }
+        if (ready == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+bool send_all(int fd, std::string_view data, Clock::time_point deadline) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            sent += static_cast<std::size_t>(written);
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (!wait_for(fd, POLLOUT, deadline)) {
+                return false;
+            }
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool receive_some(int fd, std::string& buffer, Clock::time_point deadline) {
+    for (;;) {
+        char chunk[4096];
+        const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            buffer.append(chunk, static_cast<std::size_t>(received));
+            return true;
+        }
+        if (received == 0) {
+            return false;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return false;
+        }
+        if (!wait_for(fd, POLLIN, deadline)) {
+            return false;
+        }
+    }
+}
+
+int connect_with_deadline(const WebSocketEndpoint& endpoint, Clock::time_point deadline,
+                          std::string& error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    const std::string port = std::to_string(endpoint.port);
+    if (getaddrinfo(endpoint.host.c_str(), port.c_str(), &hints, &addresses) != 0 ||
+        addresses == nullptr) {
+        error = "Unable to resolve host";
+        return -1;
+    }
+
+    int connected_fd = -1;
+    error = "Connection refused";
+    for (addrinfo* address = addresses; address != nullptr && connected_fd < 0;
+         address = address->ai_next) {
+        const int fd =
+            socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                   address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            connected_fd = fd;
+            break;
+        }
+        if (errno == EINPROGRESS) {
+            if (!wait_for(fd, POLLOUT, deadline)) {
+                error = "Connection timed out";
+                close(fd);
+                break;
+            }
+            int socket_error = 0;
+            socklen_t length = sizeof(socket_error);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &socket_error, &length) == 0 &&
+                socket_error == 0) {
+                connected_fd = fd;
+                break;
+            }
+        }
+        close(fd);
+    }
+    freeaddrinfo(addresses);
+    return connected_fd;
+}
+
+std::string lowercase(std::string_view text) {
+    std::string lowered(text);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return lowered;
+}
+
+std::string header_value(std::string_view response, std::string_view name) {
+    const std::string lowered = lowercase(response);
+    const std::string needle = "\r\n" + lowercase(name) + ":";
+    const std::size_t position = lowered.find(needle);
+    if (position == std::string::npos) {
+        return {};
+    }
+    std::size_t start = position + needle.size();
+    const std::size_t end = response.find("\r\n", start);
+    while (start < end && (response[start] == ' ' || response[start] == '\t')) {
+        ++start;
+    }
+    return std::string(response.substr(start, end - start));
+}
+
+std::string random_bytes_base64(std::size_t count) {
+    static thread_local std::mt19937 generator{std::random_device{}()};
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::array<unsigned char, 16> bytes{};
+    count = std::min(count, bytes.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        bytes[i] = static_cast<unsigned char>(distribution(generator));
+    }
+    return base64_encode(bytes.data(), count);
+}
+
+std::array<std::uint8_t, 4> random_mask() {
+    static thread_local std::mt19937 generator{std::random_device{}()};
+    const std::uint32_t value = generator();
+    return {static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8),
+            static_cast<std::uint8_t>(value >> 16), static_cast<std::uint8_t>(value >> 24)};
+}
+
+std::string format_host_header(const WebSocketEndpoint& endpoint) {
+    const bool ipv6_literal = endpoint.host.find(':') != std::string::npos;
+    std::string host = ipv6_literal ? "[" + endpoint.host + "]" : endpoint.host;
+    return host + ":" + std::to_string(endpoint.port);
+}
+
+// Sends the upgrade request on the connected `fd` and validates the 101
+// response. Bytes received after the response headers are left in `buffer`.
+bool perform_handshake(int fd, const WebSocketEndpoint& endpoint, Clock::time_point deadline,
+                       std::string_view user_agent, std::string& buffer, std::string& error) {
+    const std::string key = random_bytes_base64(16);
+    std::string request = "GET " + endpoint.path + " HTTP/1.1\r\n";
+    request += "Host: " + format_host_header(endpoint) + "\r\n";
+    request += "Upgrade: websocket\r\n";
+    request += "Connection: Upgrade\r\n";
+    request += "Sec-WebSocket-Key: " + key + "\r\n";
+    request += "Sec-WebSocket-Version: 13\r\n";
+    request += "User-Agent: ";
+    request += user_agent;
+    request += "\r\n\r\n";
+
+    if (!send_all(fd, request, deadline)) {
+        error = "Handshake send failed";
+        return false;
+    }
+
+    std::size_t header_end = std::string::npos;
+    while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (buffer.size() > kMaxHandshakeBytes || !receive_some(fd, buffer, deadline)) {
+            error = "Handshake timed out";
+            return false;
+        }
+    }
+
+    const std::string_view response(buffer.data(), header_end + 2);
+    if (response.substr(0, 12) != "HTTP/1.1 101") {
+        error = "Upgrade rejected: " +
+                std::string(response.substr(0, std::min<std::size_t>(response.find("\r\n"), 64)));
+        return false;
+    }
+    if (header_value(response, "Sec-WebSocket-Accept") != websocket_accept_key(key)) {
+        error = "Invalid Sec-WebSocket-Accept";
+        return false;
+    }
+    buffer.erase(0, header_end + 4);
+    return true;
+}
+
+void send_close_frame(int fd, const std::array<std::uint8_t, 4>& mask) {
+    std::string close_frame;
+    const char close_code[2] = {static_cast<char>(0x03), static_cast<char>(0xE8)};  // 1000
+    append_websocket_frame(close_frame, WebSocketOpcode::kClose,
+                           std::string_view(close_code, sizeof(close_code)), mask.data());
+    send(fd, close_frame.data(), close_frame.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+}  // namespace
+
+std::optional<WebSocketEndpoint> parse_websocket_address(const std::string& address) {
+    WebSocketEndpoint endpoint;
+    std::string_view rest(address);
+    if (rest.substr(0, 5) == "ws://") {
+        rest.remove_prefix(5);
+        endpoint.port = 80;
+    } else if (rest.substr(0, 6) == "wss://") {
+        rest.remove_prefix(6);
+        endpoint.secure = true;
+        endpoint.port = 443;
+    } else {
+        return std::nullopt;
+    }
+
+    const std::size_t path_start = rest.find('/');
+    std::string_view authority = rest.substr(0, path_start);
+    if (path_start != std::string_view::npos) {
+        endpoint.path = std::string(rest.substr(path_start));
+    }
+
+    std::string_view port_text;
+    if (!authority.empty() && authority.front() == '[') {
+        const std::size_t closing = authority.find(']');
+        if (closing == std::string_view::npos) {
+            return std::nullopt;
+        }
+        endpoint.host = std::string(authority.substr(1, closing - 1));
+        if (closing + 1 < authority.size() && authority[closing + 1] == ':') {
+            port_text = authority.substr(closing + 2);
+        }
+    } else {
+        const std::size_t colon = authority.rfind(':');
+        endpoint.host = std::string(authority.substr(0, colon));
+        if (colon != std::string_view::npos) {
+            port_text = authority.substr(colon + 1);
+        }
+    }
+
+    if (!port_text.empty()) {
+        int port = 0;
+        for (char ch : port_text) {
+            if (ch < '0' || ch > '9' || port > 65535) {
+                return std::nullopt;
+            }
+            port = port * 10 + (ch - '0');
+        }
+        if (port <= 0 || port > 65535) {
+            return std::nullopt;
+        }
+        endpoint.port = static_cast<std::uint16_t>(port);
+    }
+
+    if (endpoint.host.empty()) {
+        return std::nullopt;
+    }
+    return endpoint;
+}
+
+WebSocketProbeResult probe_websocket_endpoint(const WebSocketEndpoint& endpoint,
+                                              std::chrono::milliseconds timeout) {
+    WebSocketProbeResult result;
+    const auto start = Clock::now();
+    const auto deadline = start + timeout;
+
+    const int fd = connect_with_deadline(endpoint, deadline, result.error);
+    if (fd < 0) {
+        return result;
+    }
+    result.connected = true;
+    result.connect_ms = elapsed_ms(start, Clock::now());
+    result.error.clear();
+
+    std::string buffer;
+    if (!perform_handshake(fd, endpoint, deadline, kWebSocketProbeUserAgent, buffer,
+                           result.error)) {
+        close(fd);
+        return result;
+    }
+    result.handshake_ok = true;
+
+    const auto mask = random_mask();
+    std::string ping;
+    append_websocket_frame(ping, WebSocketOpcode::kPing, kPingPayload, mask.data());
+    const auto ping_sent = Clock::now();
+    if (!send_all(fd, ping, deadline)) {
+        result.error = "Ping send failed";
+        close(fd);
+        return result;
+    }
+
+    while (!result.pong_received) {
+        const auto header = parse_websocket_frame_header(buffer.data(), buffer.size());
+        if (header && header->payload_length > kMaxProbeFramePayload) {
+            result.error = "Oversized frame";
+            break;
+        }
+        if (!header || buffer.size() < header->header_length + header->payload_length) {
+            if (!receive_some(fd, buffer, deadline)) {
+                result.error = "No pong before timeout";
+                break;
+            }
+            continue;
+        }
+
+        char* payload = buffer.data() + header->header_length;
+        const std::size_t payload_length = static_cast<std::size_t>(header->payload_length);
+        if (header->masked) {
+            unmask_websocket_payload(payload, payload_length, header->mask);
+        }
+        const std::string_view payload_view(payload, payload_length);
+        if (header->opcode == WebSocketOpcode::kPong && payload_view == kPingPayload) {
+            result.pong_received = true;
+            result.round_trip_ms = elapsed_ms(ping_sent, Clock::now());
+        } else if (header->opcode == WebSocketOpcode::kText) {
+            result.message = std::string(payload_view);
+        } else if (header->opcode == WebSocketOpcode::kClose) {
+            result.error = "Closed by server";
+            break;
+        }
+        buffer.erase(0, header->header_length + payload_length);
+    }
+
+    send_close_frame(fd, mask);
+    close(fd);
+    return result;
+}
+
+std::string send_websocket_text(const WebSocketEndpoint& endpoint, std::string_view text,
+                                std::chrono::milliseconds timeout) {
+    const auto deadline = Clock::now() + timeout;
+    std::string error;
+    const int fd = connect_with_deadline(endpoint, deadline, error);
+    if (fd < 0) {
+        return error;
+    }
+    std::string buffer;
+    if (!perform_handshake(fd, endpoint, deadline, "BeaverKiosk", buffer, error)) {
+        close(fd);
+        return error;
+    }
+    const auto mask = random_mask();
+    std::string frame;
+    append_websocket_frame(frame, WebSocketOpcode::kText, text, mask.data());
+    if (!send_all(fd, frame, deadline)) {
+        close(fd);
+        return "Send failed";
+    }
+    send_close_frame(fd, mask);
+    close(fd);
+    return {};
+}
+
+WebSocketProbeHistory::WebSocketProbeHistory(std::size_t history_size)
+    : history_size_(std::max<std::size_t>(history_size, 1)) {}
+
+void WebSocketProbeHistory::record(const WebSocketProbeResult& result, Clock::time_point now) {
+    ++probes_;
+    if (result.handshake_ok) {
+        if (!up_since_) {
+            up_since_ = now;
+            up_since_wall_ = std::chrono::system_clock::now();
+        }
+    } else {
+        ++failures_;
+        up_since_.reset();
+    }
+
+    const auto push_sample = [this](std::vector<double>& samples, std::size_t& next, double value) {
+        if (samples.size() < history_size_) {
+            samples.push_back(value);
+        } else {
+            samples[next] = value;
+        }
+        next = (next + 1) % history_size_;
+    };
+    if (result.connect_ms >= 0.0) {
+        push_sample(connect_samples_, next_connect_sample_, result.connect_ms);
+    }
+    if (result.round_trip_ms >= 0.0) {
+        push_sample(round_trip_samples_, next_round_trip_sample_, result.round_trip_ms);
+    }
+    if (!result.message.empty()) {
+        last_message_ = result.message;
+    }
+    last_result_ = result;
+}
+
+void WebSocketProbeHistory::fill(WebSocketStatus& status, Clock::time_point now) const {
+    status.reachable = last_result_.handshake_ok;
+    status.probe_error = probes_ == 0 ? "Not probed yet" : last_result_.error;
+    status.connect_ms = last_result_.connect_ms;
+    status.round_trip_ms = last_result_.round_trip_ms;
+    status.connect_latency = summarize(connect_samples_);
+    status.round_trip_latency = summarize(round_trip_samples_);
+    status.last_message = last_message_;
+    status.uptime_seconds =
+        up_since_ ? std::chrono::duration<double>(now - *up_since_).count() : -1.0;
+    status.up_since_epoch_seconds =
+        up_since_ ? std::chrono::duration<double>(up_since_wall_.time_since_epoch()).count()
+                  : -1.0;
+    status.probes = probes_;
+    status.probe_failures = failures_;
+}
+
+LatencySummary WebSocketProbeHistory::summarize(const std::vector<double>& samples) {
+    LatencySummary summary;
+    summary.samples = samples.size();
+    if (samples.empty()) {
+        return summary;
+    }
+    std::vector<double> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    const auto percentile = [&sorted](double fraction) {
+        const auto rank = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    };
+    summary.p50_ms = percentile(0.50);
+    summary.p90_ms = percentile(0.90);
+    summary.p99_ms = percentile(0.99);
+    return summary;
+}
+
+WebSocketProbe::WebSocketProbe(std::size_t history_size, std::chrono::milliseconds interval,
+                               std::chrono::milliseconds timeout)
+    : history_size_(history_size),
+      interval_(interval),
+      timeout_(timeout),
+      history_(history_size) {}
+
+WebSocketProbe::~WebSocketProbe() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void WebSocketProbe::update(const std::string& address, WebSocketStatus& status) {
+    const auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool was_idle = now - last_update_ > kProbeIdleAfter;
+    last_update_ = now;
+    if (address != address_) {
+        address_ = address;
+        history_ = WebSocketProbeHistory(history_size_);
+        wake_.notify_all();
+    } else if (was_idle) {
+        wake_.notify_all();
+    }
+    if (!worker_.joinable()) {
+        worker_ = std::thread(&WebSocketProbe::run, this);
+    }
+    history_.fill(status, now);
+}
+
+void WebSocketProbe::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Nobody has asked for a while: sleep until the next update().
+        if (Clock::now() - last_update_ > kProbeIdleAfter) {
+            wake_.wait(lock);
+            continue;
+        }
+
+        const std::string address = address_;
+        lock.unlock();
+        WebSocketProbeResult result;
+        const auto endpoint = parse_websocket_address(address);
+        if (!endpoint) {
+            result.error = "Invalid address";
+        } else if (endpoint->secure) {
+            result.error = "wss:// endpoints cannot be probed";
+        } else {
+            result = probe_websocket_endpoint(*endpoint, timeout_);
+        }
+        const auto probed_at = Clock::now();
+        lock.lock();
+
+        // Results for an address that has since been replaced are dropped.
+        if (address == address_) {
+            history_.record(result, probed_at);
+        }
+        wake_.wait_until(lock, probed_at + interval_,
+                         [this, &address] { return stopping_ || address != address_; });
+    }
+}
@@ -0,0 +1,220 @@
+#include "core/websocket_protocol.h"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr char kWebSocketGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+std::uint32_t rotate_left(std::uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Minimal SHA-1, only used to derive Sec-WebSocket-Accept.
+std::array<unsigned char, 20> sha1(std::string_view input) {
+    std::uint32_t h0 = 0x67452301;
+    std::uint32_t h1 = 0xEFCDAB89;
+    std::uint32_t h2 = 0x98BADCFE;
+    std::uint32_t h3 = 0x10325476;
+    std::uint32_t h4 = 0xC3D2E1F0;
+
+    std::string message(input);
+    const std::uint64_t bit_length = static_cast<std::uint64_t>(input.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) {
+        message.push_back('\0');
+    }
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        message.push_back(static_cast<char>((bit_length >> shift) & 0xFF));
+    }
+
+    for (std::size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        std::uint32_t words[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(message.data() + chunk + i * 4);
+            words[i] = (static_cast<std::uint32_t>(bytes[0]) << 24) |
+                       (static_cast<std::uint32_t>(bytes[1]) << 16) |
+                       (static_cast<std::uint32_t>(bytes[2]) << 8) |
+                       static_cast<std::uint32_t>(bytes[3]);
+        }
+        for (int i = 16; i < 80; ++i) {
+            words[i] = rotate_left(words[i - 3] ^ words[i - 8] ^ words[i - 14] ^ words[i - 16], 1);
+        }
+
+        std::uint32_t a = h0;
+        std::uint32_t b = h1;
+        std::uint32_t c = h2;
+        std::uint32_t d = h3;
+        std::uint32_t e = h4;
+        for (int i = 0; i < 80; ++i) {
+            std::uint32_t f = 0;
+            std::uint32_t k = 0;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const std::uint32_t temp = rotate_left(a, 5) + f + e + k + words[i];
+            e = d;
+            d = c;
+            c = rotate_left(b, 30);
+            b = a;
+            a = temp;
+        }
+        h0 += a;
+        h1 += b;
+        h2 += c;
+        h3 += d;
+        h4 += e;
+    }
+
+    std::array<unsigned char, 20> digest{};
+    const std::uint32_t parts[5] = {h0, h1, h2, h3, h4};
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<unsigned char>(parts[i] >> 24);
+        digest[i * 4 + 1] = static_cast<unsigned char>(parts[i] >> 16);
+        digest[i * 4 + 2] = static_cast<unsigned char>(parts[i] >> 8);
+        digest[i * 4 + 3] = static_cast<unsigned char>(parts[i]);
+    }
+    return digest;
+}
+
+}  // namespace
+
+std::optional<WebSocketFrameHeader> parse_websocket_frame_header(const char* data,
+                                                                 std::size_t size) {
+    if (size < 2) {
+        return std::nullopt;
+    }
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+    WebSocketFrameHeader header;
+    header.fin = (bytes[0] & 0x80) != 0;
+    header.opcode = static_cast<WebSocketOpcode>(bytes[0] & 0x0F);
+    header.masked = (bytes[1] & 0x80) != 0;
+
+    std::size_t offset = 2;
+    const std::uint8_t length_code = bytes[1] & 0x7F;
+    if (length_code == 126) {
+        if (size < offset + 2) {
+            return std::nullopt;
+        }
+        header.payload_length = (static_cast<std::uint64_t>(bytes[2]) << 8) | bytes[3];
+        offset += 2;
+    } else if (length_code == 127) {
+        if (size < offset + 8) {
+            return std::nullopt;
+        }
+        header.payload_length = 0;
+        for (int i = 0; i < 8; ++i) {
+            header.payload_length = (header.payload_length << 8) | bytes[2 + i];
+        }
+        offset += 8;
+    } else {
+        header.payload_length = length_code;
+    }
+
+    if (header.masked) {
+        if (size < offset + 4) {
+            return std::nullopt;
+        }
+        std::memcpy(header.mask, bytes + offset, 4);
+        offset += 4;
+    }
+    header.header_length = offset;
+    return header;
+}
+
+void append_websocket_frame(std::string& out, WebSocketOpcode opcode, std::string_view payload,
+                            const std::uint8_t* mask) {
+    out.push_back(static_cast<char>(0x80 | static_cast<std::uint8_t>(opcode)));
+    const std::uint8_t mask_bit = mask != nullptr ? 0x80 : 0x00;
+    if (payload.size() < 126) {
+        out.push_back(static_cast<char>(mask_bit | payload.size()));
+    } else if (payload.size() <= 0xFFFF) {
+        out.push_back(static_cast<char>(mask_bit | 126));
+        out.push_back(static_cast<char>((payload.size() >> 8) & 0xFF));
+        out.push_back(static_cast<char>(payload.size() & 0xFF));
+    } else {
+        out.push_back(static_cast<char>(mask_bit | 127));
+        const std::uint64_t length = payload.size();
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>((length >> shift) & 0xFF));
+        }
+    }
+
+    if (mask == nullptr) {
+        out.append(payload.data(), payload.size());
+        return;
+    }
+    out.append(reinterpret_cast<const char*>(mask), 4);
+    const std::size_t payload_start = out.size();
+    out.append(payload.data(), payload.size());
+    unmask_websocket_payload(out.data() + payload_start, payload.size(), mask);
+}
+
+void unmask_websocket_payload(char* data, std::size_t size, const std::uint8_t mask[4],
+                              std::size_t offset) {
+    std::size_t i = 0;
+    // Process eight bytes at a time once the mask phase is aligned to zero.
+    if (offset % 4 == 0 && size >= 8) {
+        std::uint64_t wide_mask = 0;
+        unsigned char mask_bytes[8];
+        for (int j = 0; j < 8; ++j) {
+            mask_bytes[j] = mask[j % 4];
+        }
+        std::memcpy(&wide_mask, mask_bytes, sizeof(wide_mask));
+        for (; i + 8 <= size; i += 8) {
+            std::uint64_t chunk = 0;
+            std::memcpy(&chunk, data + i, sizeof(chunk));
+            chunk ^= wide_mask;
+            std::memcpy(data + i, &chunk, sizeof(chunk));
+        }
+    }
+    for (; i < size; ++i) {
+        data[i] = static_cast<char>(data[i] ^ mask[(offset + i) % 4]);
+    }
+}
+
+std::string websocket_accept_key(std::string_view client_key) {
+    std::string material(client_key);
+    material += kWebSocketGuid;
+    const auto digest = sha1(material);
+    return base64_encode(digest.data(), digest.size());
+}
+
+std::string base64_encode(const unsigned char* data, std::size_t size) {
+    static constexpr char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve(((size + 2) / 3) * 4);
+    std::size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        const std::uint32_t triple = (static_cast<std::uint32_t>(data[i]) << 16) |
+                                     (static_cast<std::uint32_t>(data[i + 1]) << 8) | data[i + 2];
+        encoded.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 6) & 0x3F]);
+        encoded.push_back(kAlphabet[triple & 0x3F]);
+    }
+    const std::size_t remaining = size - i;
+    if (remaining > 0) {
+        std::uint32_t triple = static_cast<std::uint32_t>(data[i]) << 16;
+        if (remaining == 2) {
+            triple |= static_cast<std::uint32_t>(data[i + 1]) << 8;
+        }
+        encoded.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        encoded.push_back(remaining == 2 ? kAlphabet[(triple >> 6) & 0x3F] : '=');
+        encoded.push_back('=');
+    }
+    return encoded;
+}
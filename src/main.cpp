@@ -1,21 +1,49 @@
+#include <chrono>
+#include <csignal>
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "core/access_log.h"
+#include "core/alloc_stats.h"
 #include "core/app_manager.h"
-#include "ui/gtk/gtk_app.h"
+#include "core/profiler.h"
+#include "core/trace.h"
 #include "ui/http/http_server.h"
+#include "ui/http/self_bench.h"
+#include "ui/http/soak_runner.h"
+#include "ui/http/static_export.h"
+
+// Built a second time with -DBEAVER_HEADLESS=1 as beaver_kiosk_http, which
+// links libbeavercore only and has no GTK shell.
+#ifndef BEAVER_HEADLESS
+#define BEAVER_HEADLESS 0
+#endif
+
+#if !BEAVER_HEADLESS
+#include "ui/gtk/gtk_app.h"
+#endif
 
 namespace {
 void print_usage(const char* executable_name) {
     std::cout << "Usage: " << executable_name
-              << " [--http|--gtk] [--port=NUMBER] [URL options]\n";
+              << (BEAVER_HEADLESS ? " [--http]" : " [--http|--gtk]")
+              << " [--port=NUMBER] [URL options]\n";
     std::cout << "\n";
     std::cout << "Options:\n";
     std::cout << "  --http           Run the built-in HTTP server (default).\n";
+#if !BEAVER_HEADLESS
     std::cout << "  --gtk            Launch the GTK 4 desktop application.\n";
+#endif
     std::cout << "  --port=NUMBER    Override the HTTP server port (default: 5000).\n";
+    std::cout << "  --soak[=DURATION] Drive the HTTP server and navigation headlessly for\n"
+                 "                   DURATION (e.g. 90s, 45m, 8h; default 1h) and fail on\n"
+                 "                   resource growth over the BEAVER_SOAK_* budgets.\n";
+    std::cout << "  --self-bench     Run the standard workload on this device and print a\n"
+                 "                   per-subsystem score (JSON in logs/self-bench.json).\n";
+    std::cout << "  --export=DIR     Write every static page, the menu JSON and the assets,\n"
+                 "                   with gzip copies and a manifest, to DIR and exit.\n";
     std::cout << "  --beaverdoc-local-url=URL     Override the BeaverDoc URL in kiosk mode.\n";
     std::cout << "  --beaverdoc-remote-url=URL    Override the BeaverDoc URL for the HTTP menu.\n";
     std::cout << "  --beaverdebian-local-url=URL  Override the BeaverDebian URL in kiosk mode.\n";
@@ -25,10 +53,15 @@ void print_usage(const char* executable_name) {
 }
 
 int main(int argc, char* argv[]) {
+    allocation_accounting_from_environment();
     AppManager manager;
 
     bool http_requested = false;
     bool gtk_requested = false;
+    bool soak_requested = false;
+    bool self_bench_requested = false;
+    std::string export_directory;
+    std::chrono::seconds soak_duration = SoakConfig{}.duration;
     int port = 5000;
     std::string beaverdoc_local_url = "http://localhost:8000";
     std::string beaverdoc_remote_url = "http://192.168.1.76:8000";
@@ -45,6 +78,21 @@ int main(int argc, char* argv[]) {
             http_requested = true;
         } else if (arg == "--gtk") {
             gtk_requested = true;
+        } else if (arg == "--self-bench") {
+            self_bench_requested = true;
+        } else if (arg.rfind("--export=", 0) == 0) {
+            export_directory = arg.substr(9);
+            if (export_directory.empty()) {
+                std::cerr << "--export needs a directory, e.g. --export=dist." << std::endl;
+                return 1;
+            }
+        } else if (arg == "--soak" || arg.rfind("--soak=", 0) == 0) {
+            soak_requested = true;
+            if (arg.size() > 6 && !parse_soak_duration(arg.substr(7), soak_duration)) {
+                std::cerr << "Invalid duration supplied to --soak, e.g. --soak=90s, 45m or 8h."
+                          << std::endl;
+                return 1;
+            }
         } else if (arg.rfind("--port=", 0) == 0) {
             try {
                 port = std::stoi(arg.substr(7));
@@ -76,12 +124,17 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (BEAVER_HEADLESS && gtk_requested) {
+        std::cerr << "This build has no GTK shell; run beaver_kiosk --gtk instead." << std::endl;
+        return 1;
+    }
+
     if (!http_requested && !gtk_requested) {
         http_requested = true;
     }
 
     gtk_args.push_back(nullptr);
-    int gtk_argc = static_cast<int>(gtk_args.size()) - 1;
+    [[maybe_unused]] int gtk_argc = static_cast<int>(gtk_args.size()) - 1;
 
     manager.set_app_routes(
         "BeaverDoc",
@@ -90,11 +143,34 @@ int main(int argc, char* argv[]) {
                            {RouteEntry{beaverdebian_local_url, false, ""},
                             RouteEntry{beaverdebian_remote_url, false, ""}});
 
-    if (http_requested) {
+    if (!export_directory.empty()) {
+        return run_static_export(manager, export_directory);
+    }
+
+    access_log().start(access_log_config_from_environment());
+    install_trace_controls(SIGUSR2);
+    install_profile_controls(SIGUSR1);
+
+    int exit_code = 0;
+    if (self_bench_requested) {
+        SelfBenchConfig config = self_bench_config_from_environment();
+        config.port = port;
+        exit_code = run_self_bench(manager, config);
+    } else if (soak_requested) {
+        SoakConfig config = soak_config_from_environment();
+        config.duration = soak_duration;
+        config.port = port;
+        exit_code = run_soak(manager, config);
+    } else if (http_requested) {
         HttpServerApp server(manager, port);
-        return server.run();
+        exit_code = server.run();
+    } else {
+#if !BEAVER_HEADLESS
+        GtkApp app(manager);
+        exit_code = app.run(gtk_argc, gtk_args.data());
+#endif
     }
 
-    GtkApp app(manager);
-    return app.run(gtk_argc, gtk_args.data());
+    access_log().stop();
+    return exit_code;
 }
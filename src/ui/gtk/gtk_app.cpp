@@ -17,7 +17,13 @@
 #include <gio/gio.h>
 #include <glib.h>
 
-GtkApp::GtkApp(AppManager& manager) : manager_(manager) {}
+#include "core/trace.h"
+
+GtkApp::GtkApp(AppManager& manager) : manager_(manager) {
+    for (const AppPageRoute& route : app_page_routes()) {
+        page_router_.add(route.path, route.page);
+    }
+}
 
 int GtkApp::run(int argc, char** argv) {
     GtkApplication* application =
@@ -505,6 +511,7 @@ void GtkApp::build_ui(GtkApplication* application) {
 
 gboolean GtkApp::on_decide_policy(WebKitWebView* web_view, WebKitPolicyDecision* decision,
                                   WebKitPolicyDecisionType decision_type, gpointer user_data) {
+    TraceSpan span("gtk.decide_policy");
     g_message("GtkApp policy decision received. type=%s (%d)",
               policy_decision_type_to_string(decision_type), static_cast<int>(decision_type));
 
@@ -572,55 +579,18 @@ gboolean GtkApp::on_decide_policy(WebKitWebView* web_view, WebKitPolicyDecision*
 
     Language language = language_from_query(query_string, self->manager_.get_default_language());
 
-    const bool navigating_to_menu =
-        (normalized_path == "/" || normalized_path == "/index.html");
-    const bool navigating_to_beaverphone = (normalized_path == "/apps/beaverphone");
-    const bool navigating_to_beavertask = (normalized_path == "/apps/beavertask");
-    const bool navigating_to_beaveralarm = (normalized_path == "/apps/beaveralarm");
-    const bool navigating_to_beaversystem = (normalized_path == "/apps/beaversystem");
-
-    if (!navigating_to_menu && !navigating_to_beaverphone && !navigating_to_beavertask &&
-        !navigating_to_beaveralarm && !navigating_to_beaversystem) {
+    RouteParams params;
+    const auto* route = self->page_router_.match(normalized_path, params);
+    if (route == nullptr) {
         return FALSE;
     }
 
     self->manager_.set_default_language(language);
 
-    bool handled_navigation = false;
-
-    if (navigating_to_menu) {
+    if (route->handler == AppPage::kMenu) {
         self->load_language(web_view, language);
-        handled_navigation = true;
-    } else if (navigating_to_beaverphone) {
-        std::string html = self->manager_.beaverphone_page_html(
-            language, BeaverphoneMenuLinkMode::kRelativeIndex);
-        std::string base_uri = build_base_uri();
-        if (html.empty()) {
-            g_warning("GtkApp received empty BeaverPhone HTML for language: %s",
-                      language_to_string(language));
-        }
-        webkit_web_view_load_html(web_view, html.c_str(), base_uri.c_str());
-        handled_navigation = true;
-    } else if (navigating_to_beavertask) {
-        self->load_beavertask_page(web_view, language);
-        handled_navigation = true;
-    } else if (navigating_to_beaveralarm) {
-        self->load_beaveralarm_page(web_view, language);
-        handled_navigation = true;
-    } else if (navigating_to_beaversystem) {
-        std::string html = self->manager_.beaversystem_page_html(
-            language, BeaverSystemMenuLinkMode::kRelativeIndex);
-        std::string base_uri = build_base_uri();
-        if (html.empty()) {
-            g_warning("GtkApp received empty BeaverSystem HTML for language: %s",
-                      language_to_string(language));
-        }
-        webkit_web_view_load_html(web_view, html.c_str(), base_uri.c_str());
-        handled_navigation = true;
-    }
-
-    if (!handled_navigation) {
-        return FALSE;
+    } else {
+        self->load_app_page(web_view, route->handler, language);
     }
 
     webkit_policy_decision_ignore(decision);
@@ -801,6 +771,7 @@ GtkWindow* GtkApp::resolve_parent_window() const {
 }
 
 void GtkApp::load_language(WebKitWebView* web_view, Language language) {
+    TraceSpan span("gtk.load_language", language_to_string(language));
     std::string html = manager_.to_html(language, MenuRouteMode::kKiosk);
     std::string base_uri = build_base_uri();
     if (html.empty()) {
@@ -812,32 +783,17 @@ void GtkApp::load_language(WebKitWebView* web_view, Language language) {
     webkit_web_view_load_html(web_view, html.c_str(), base_uri.c_str());
 }
 
-void GtkApp::load_beavertask_page(WebKitWebView* web_view, Language language) {
-    if (web_view == nullptr) {
-        g_warning("GtkApp cannot load BeaverTask page without an active web view.");
-        return;
-    }
-
-    std::string html = manager_.beavertask_page_html(language, BeaverTaskMenuLinkMode::kRelativeIndex);
-    std::string base_uri = build_base_uri();
-    if (html.empty()) {
-        g_warning("GtkApp received empty BeaverTask HTML for language: %s",
-                  language_to_string(language));
-    }
-    webkit_web_view_load_html(web_view, html.c_str(), base_uri.c_str());
-}
-
-void GtkApp::load_beaveralarm_page(WebKitWebView* web_view, Language language) {
+void GtkApp::load_app_page(WebKitWebView* web_view, AppPage page, Language language) {
     if (web_view == nullptr) {
-        g_warning("GtkApp cannot load BeaverAlarm page without an active web view.");
+        g_warning("GtkApp cannot load an app page without an active web view.");
         return;
     }
+    TraceSpan span("gtk.load_app_page");
 
-    std::string html = manager_.beaveralarm_page_html(
-        language, "", BeaverAlarmMenuLinkMode::kRelativeIndex);
+    std::string html = manager_.page_html(page, language, MenuRouteMode::kKiosk);
     std::string base_uri = build_base_uri();
     if (html.empty()) {
-        g_warning("GtkApp received empty BeaverAlarm HTML for language: %s",
+        g_warning("GtkApp received empty app page HTML for language: %s",
                   language_to_string(language));
     }
     webkit_web_view_load_html(web_view, html.c_str(), base_uri.c_str());
@@ -6,10 +6,15 @@
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "core/asset_manifest.h"
+#include "core/text_escape.h"
+#include "core/trace.h"
 #include "core/translation_catalog.h"
-#include <glib.h>
+#include "core/uri.h"
 
 namespace {
 const char* html_lang_code(Language language) {
@@ -34,88 +39,9 @@ std::string language_toggle_button(const std::string& label, const std::string&
     return html.str();
 }
 
-std::string html_escape(const std::string& text) {
-    std::string escaped;
-    escaped.reserve(text.size());
-    for (char ch : text) {
-        switch (ch) {
-            case '&':
-                escaped += "&amp;";
-                break;
-            case '<':
-                escaped += "&lt;";
-                break;
-            case '>':
-                escaped += "&gt;";
-                break;
-            case '\"':
-                escaped += "&quot;";
-                break;
-            case '\'':
-                escaped += "&#39;";
-                break;
-            default:
-                escaped.push_back(ch);
-                break;
-        }
-    }
-    return escaped;
-}
-
-std::string json_escape(const std::string& text) {
-    std::string escaped;
-    escaped.reserve(text.size());
-    for (unsigned char ch : text) {
-        switch (ch) {
-            case '\\':
-                escaped += "\\\\";
-                break;
-            case '\"':
-                escaped += "\\\"";
-                break;
-            case '\b':
-                escaped += "\\b";
-                break;
-            case '\f':
-                escaped += "\\f";
-                break;
-            case '\n':
-                escaped += "\\n";
-                break;
-            case '\r':
-                escaped += "\\r";
-                break;
-            case '\t':
-                escaped += "\\t";
-                break;
-            default:
-                if (ch < 0x20) {
-                    std::ostringstream hex_stream;
-                    hex_stream << "\\u" << std::uppercase << std::setfill('0') << std::setw(4)
-                               << static_cast<int>(ch);
-                    escaped += hex_stream.str();
-                } else {
-                    escaped.push_back(static_cast<char>(ch));
-                }
-                break;
-        }
-    }
-    return escaped;
-}
-
-std::string json_array(const std::vector<std::string>& values) {
-    std::ostringstream out;
-    out << "[";
-    for (std::size_t i = 0; i < values.size(); ++i) {
-        out << '\"' << json_escape(values[i]) << '\"';
-        if (i + 1 < values.size()) {
-            out << ", ";
-        }
-    }
-    out << "]";
-    return out.str();
-}
-
+// Absolute prefixes are served by HttpServerApp, which also answers the
+// fingerprinted names from asset_manifest(). The GTK shell resolves relative
+// ones against file://.../public/, where only the plain names exist.
 std::string resolve_asset_path(const std::string& asset_prefix, const std::string& relative_path) {
     if (relative_path.empty()) {
         return relative_path;
@@ -125,18 +51,14 @@ std::string resolve_asset_path(const std::string& asset_prefix, const std::strin
         return relative_path;
     }
 
+    const std::string_view unprefixed =
+        relative_path.front() == '/' ? std::string_view(relative_path).substr(1) : relative_path;
+    const std::string_view asset =
+        asset_prefix.front() == '/' ? asset_manifest().fingerprinted(unprefixed) : unprefixed;
     if (asset_prefix.back() == '/') {
-        if (!relative_path.empty() && relative_path.front() == '/') {
-            return asset_prefix + relative_path.substr(1);
-        }
-        return asset_prefix + relative_path;
-    }
-
-    if (!relative_path.empty() && relative_path.front() == '/') {
-        return asset_prefix + relative_path;
+        return asset_prefix + std::string(asset);
     }
-
-    return asset_prefix + "/" + relative_path;
+    return asset_prefix + "/" + std::string(asset);
 }
 
 struct DialpadKey {
@@ -238,6 +160,21 @@ constexpr std::array<ExtensionContact, 4> kExtensionContacts = {{
      "contact/ontario.svg"}
 }};
 
+// Basename of the executable in a command line, e.g. "/usr/bin/node server.js" -> "node".
+std::string short_command_name(const std::string& command) {
+    const std::string executable = command.substr(0, command.find(' '));
+    const std::size_t slash = executable.rfind('/');
+    return slash == std::string::npos ? executable : executable.substr(slash + 1);
+}
+
+// Human-readable rule condition, e.g. "battery.percent 12 < 15".
+std::string format_alert_condition(const ActiveAlert& alert) {
+    std::ostringstream stream;
+    stream << alert.metric << ' ' << std::setprecision(4) << alert.value << ' '
+           << alert_comparator_symbol(alert.comparator) << ' ' << alert.threshold;
+    return stream.str();
+}
+
 std::string contact_initial(const ExtensionContact& contact, Language language) {
     const char* name = language == Language::French ? contact.name_fr : contact.name_en;
     if (!name || name[0] == '\0') {
@@ -301,6 +238,7 @@ std::string generate_menu_page_html(const std::vector<AppTile>& apps,
                                     const TranslationCatalog& translations, Language language,
                                     MenuRouteMode route_mode,
                                     const std::string& asset_prefix) {
+    TraceSpan span("render.menu");
     std::ostringstream html;
 
     const char* lang_code = html_lang_code(language);
@@ -389,6 +327,7 @@ std::string generate_beavertask_board_html(const TranslationCatalog& translation
                                            Language language,
                                            const std::string& asset_prefix,
                                            BeaverTaskMenuLinkMode menu_link_mode) {
+    TraceSpan span("render.beavertask");
     struct LocalizedText {
         const char* en;
         const char* fr;
@@ -546,21 +485,15 @@ std::string generate_beavertask_board_html(const TranslationCatalog& translation
             return TaskLinkType::kLocal;
         }
 
-        GUri* parsed_uri = g_uri_parse(href.c_str(), G_URI_FLAGS_NONE, nullptr);
-        if (parsed_uri == nullptr) {
+        UriParts parts;
+        if (!parse_uri(href, parts)) {
             if (href.rfind("http://", 0) == 0 || href.rfind("https://", 0) == 0) {
                 return TaskLinkType::kWeb;
             }
             return TaskLinkType::kLocal;
         }
 
-        const gchar* scheme = g_uri_get_scheme(parsed_uri);
-        std::string scheme_string = scheme != nullptr ? scheme : "";
-        g_uri_unref(parsed_uri);
-        std::transform(scheme_string.begin(), scheme_string.end(), scheme_string.begin(),
-                       [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
-
-        if (scheme_string == "http" || scheme_string == "https") {
+        if (parts.scheme == "http" || parts.scheme == "https") {
             return TaskLinkType::kWeb;
         }
 
@@ -832,6 +765,7 @@ std::string generate_beaverphone_dialpad_html(const TranslationCatalog& translat
                                               Language language,
                                               const std::string& asset_prefix,
                                               BeaverphoneMenuLinkMode menu_link_mode) {
+    TraceSpan span("render.beaverphone");
     std::ostringstream html;
 
     const char* lang_code = html_lang_code(language);
@@ -1010,7 +944,12 @@ std::string generate_beaverphone_dialpad_html(const TranslationCatalog& translat
           : null;
         const wsScheme = window.location.protocol === 'https:' ? 'wss' : 'ws';
         const wsHost = window.location.hostname || '192.168.1.60';
-        const wsUrl = `${wsScheme}://${wsHost}:5001`;
+        // Served by HttpServerApp: use its built-in /ws endpoint on the same origin.
+        // Otherwise (GTK file:// pages) fall back to the standalone dial service.
+        const servedOverHttp =
+          window.location.protocol === 'http:' || window.location.protocol === 'https:';
+        const wsUrl = servedOverHttp ? `${wsScheme}://${window.location.host}/ws`
+                                     : `${wsScheme}://${wsHost}:5001`;
         console.info('[BeaverPhone] WebSocket endpoint:', wsUrl);
         const reconnectDelayMs = 5000;
         let socket = null;
@@ -1336,6 +1275,7 @@ std::string generate_beaveralarm_console_html(const TranslationCatalog& translat
                                               Language language,
                                               const std::string& asset_prefix,
                                               BeaverAlarmMenuLinkMode menu_link_mode) {
+    TraceSpan span("render.beaveralarm");
     std::ostringstream html;
 
     const char* lang_code = html_lang_code(language);
@@ -1679,6 +1619,7 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
                                                  const std::string& asset_prefix,
                                                  BeaverSystemMenuLinkMode menu_link_mode,
                                                  const SystemStatusSnapshot& snapshot) {
+    TraceSpan span("render.beaversystem");
     std::ostringstream html;
     auto append = [&](const std::string& text) { html << text << "\n"; };
 
@@ -1703,8 +1644,11 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     const std::string load_label = translations.translate("Load", language);
     const std::string websocket_channel_label = translations.translate("WebSocket channel", language);
     const std::string raw_uptime_label = translations.translate("Raw uptime", language);
+    const std::string latency_label = translations.translate("Latency", language);
+    const std::string handshake_failed_label = translations.translate("Handshake failed", language);
     const std::string network_ports_label = translations.translate("Network ports", language);
     const std::string list_open_ports_label = translations.translate("List of open ports", language);
+    const std::string unknown_owner_label = translations.translate("Unknown owner", language);
     const std::string no_ports_label = translations.translate("No listening ports detected.", language);
     const std::string no_telemetry_label = translations.translate("No telemetry received yet.", language);
     const std::string unavailable_label = translations.translate("Unavailable", language);
@@ -1716,6 +1660,17 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     const std::string discharging_label = translations.translate("Discharging", language);
     const std::string full_label = translations.translate("Full", language);
     const std::string not_charging_label = translations.translate("Not charging", language);
+    const std::string processes_label = translations.translate("Processes", language);
+    const std::string alerts_label = translations.translate("Alerts", language);
+    const std::string no_alerts_label = translations.translate("No active alerts.", language);
+    const std::string since_label = translations.translate("Since", language);
+    const std::string top_cpu_label = translations.translate("Top CPU", language);
+    const std::string top_memory_label = translations.translate("Top memory", language);
+    const std::string pid_label = translations.translate("PID", language);
+    const std::string command_label = translations.translate("Command", language);
+    const std::string cpu_label = translations.translate("CPU", language);
+    const std::string memory_label = translations.translate("Memory", language);
+    const std::string no_processes_label = translations.translate("No process data available.", language);
 
     const std::string menu_href = build_menu_href(language, menu_link_mode);
     const bool use_absolute_links = (menu_link_mode == BeaverSystemMenuLinkMode::kAbsoluteRoot);
@@ -1732,7 +1687,7 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
                 << snapshot.debian.load_average[1] << " / " << snapshot.debian.load_average[2];
     const std::string load_average_text = load_stream.str();
 
-    const std::string initial_json = system_status_to_json(snapshot);
+    const std::string initial_json = system_status_to_json(snapshot, JsonStyle::kCompact);
 
     append("<!DOCTYPE html>");
     append(std::string("<html lang=\"") + lang_code + "\">");
@@ -1759,7 +1714,9 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("            data-label-unavailable=\"" + html_escape(unavailable_label) + "\"");
     append("            data-label-connected=\"" + html_escape(connected_label) + "\"");
     append("            data-label-not-connected=\"" + html_escape(not_connected_label) + "\"");
+    append("            data-label-handshake-failed=\"" + html_escape(handshake_failed_label) + "\"");
     append("            data-label-no-ports=\"" + html_escape(no_ports_label) + "\"");
+    append("            data-label-unknown-owner=\"" + html_escape(unknown_owner_label) + "\"");
     append("            data-label-no-telemetry=\"" + html_escape(no_telemetry_label) + "\"");
     append("            data-label-updated=\"" + html_escape(updated_label) + "\"");
     append("            data-label-interface=\"" + html_escape(interface_label) + "\"");
@@ -1769,13 +1726,30 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("            data-battery-label-full=\"" + html_escape(full_label) + "\"");
     append("            data-battery-label-not-charging=\"" + html_escape(not_charging_label) + "\"");
     append("            data-battery-label-unavailable=\"" + html_escape(unavailable_label) + "\"");
-    append("            data-battery-label-unknown=\"" + html_escape(unknown_label) + "\">");
+    append("            data-battery-label-unknown=\"" + html_escape(unknown_label) + "\"");
+    append("            data-label-no-alerts=\"" + html_escape(no_alerts_label) + "\"");
+    append("            data-label-since=\"" + html_escape(since_label) + "\"");
+    append("            data-label-no-processes=\"" + html_escape(no_processes_label) + "\">");
     append("        <section class=\"system-section\">");
     append("          <div class=\"system-section__header\">");
     append("            <h2 class=\"system-section__title\">" + html_escape(system_status_title) + "</h2>");
     append("            <p class=\"system-section__meta\">" + html_escape(updated_label) + ": <span data-role=\"updated-value\">" + html_escape(last_updated_value) + "</span></p>");
     append("          </div>");
     append("          <div class=\"system-section__grid\">");
+    append("            <article class=\"system-card system-card--wide\">");
+    append("              <h3 class=\"system-card__title\">" + html_escape(alerts_label) + "</h3>");
+    append("              <ul class=\"system-alerts\" data-role=\"alerts-list\">");
+    if (snapshot.alerts.empty()) {
+        append("                <li class=\"system-alerts__empty\">" + html_escape(no_alerts_label) + "</li>");
+    } else {
+        for (const auto& alert : snapshot.alerts) {
+            append("                <li class=\"system-alerts__item\"><span class=\"system-alerts__name\">" +
+                   html_escape(alert.name) + "</span><span class=\"system-alerts__condition\">" +
+                   html_escape(format_alert_condition(alert)) + "</span></li>");
+        }
+    }
+    append("              </ul>");
+    append("            </article>");
     append("            <article class=\"system-card\">");
     append("              <h3 class=\"system-card__title\">" + html_escape(home_wifi_label) + "</h3>");
     append("              <dl class=\"system-card__metrics\">");
@@ -1846,6 +1820,10 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("                  <dt class=\"system-card__label\">" + html_escape(raw_uptime_label) + "</dt>");
     append("                  <dd class=\"system-card__value\" data-role=\"ws-uptime\">" + html_escape(unknown_label) + "</dd>");
     append("                </div>");
+    append("                <div class=\"system-card__metric\">");
+    append("                  <dt class=\"system-card__label\">" + html_escape(latency_label) + "</dt>");
+    append("                  <dd class=\"system-card__value\" data-role=\"ws-latency\">" + html_escape(unknown_label) + "</dd>");
+    append("                </div>");
     append("              </dl>");
     append("            </article>");
     append("            <article class=\"system-card system-card--ports\">");
@@ -1853,23 +1831,60 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("              <div class=\"system-card__body\">");
     append("                <p class=\"system-card__hint\">" + html_escape(list_open_ports_label) + "</p>");
     append("                <div class=\"system-ports\" data-role=\"ports-list\">");
-    if (snapshot.network.listening_ports.empty()) {
+    if (snapshot.network.listening_sockets.empty() && snapshot.network.listening_ports.empty()) {
         append("                  <p class=\"system-ports__empty\">" + html_escape(no_ports_label) + "</p>");
-    } else {
+    } else if (snapshot.network.listening_sockets.empty()) {
         for (std::size_t i = 0; i < snapshot.network.listening_ports.size(); ++i) {
             append("                  <span class=\"system-port-pill\">" + std::to_string(snapshot.network.listening_ports[i]) + "</span>");
         }
+    } else {
+        for (const auto& socket : snapshot.network.listening_sockets) {
+            const std::string owner =
+                socket.pid > 0 ? short_command_name(socket.command) + " (" + std::to_string(socket.pid) + ")"
+                               : unknown_owner_label;
+            const std::string title = socket.command.empty() ? owner : socket.command;
+            append("                  <span class=\"system-port-pill\" title=\"" + html_escape(title) + "\">" +
+                   "<span class=\"system-port-pill__port\">" + std::to_string(socket.port) + "</span>" +
+                   "<span class=\"system-port-pill__owner\">" + html_escape(owner) + "</span></span>");
+        }
     }
     append("                </div>");
     append("              </div>");
     append("            </article>");
+    append("            <article class=\"system-card system-card--wide\">");
+    append("              <h3 class=\"system-card__title\">" + html_escape(processes_label) + "</h3>");
+    append("              <div class=\"system-processes\">");
+    const std::pair<const std::string*, const char*> process_tables[] = {
+        {&top_cpu_label, "processes-cpu"}, {&top_memory_label, "processes-memory"}};
+    for (const auto& [title, role] : process_tables) {
+        append("                <div class=\"system-processes__group\">");
+        append("                  <p class=\"system-card__hint\">" + html_escape(*title) + "</p>");
+        append("                  <table class=\"system-processes__table\">");
+        append("                    <thead>");
+        append("                      <tr>");
+        append("                        <th scope=\"col\">" + html_escape(pid_label) + "</th>");
+        append("                        <th scope=\"col\">" + html_escape(command_label) + "</th>");
+        append("                        <th scope=\"col\" class=\"system-processes__numeric\">" + html_escape(cpu_label) + "</th>");
+        append("                        <th scope=\"col\" class=\"system-processes__numeric\">" + html_escape(memory_label) + "</th>");
+        append("                      </tr>");
+        append("                    </thead>");
+        append(std::string("                    <tbody data-role=\"") + role + "\">");
+        append("                      <tr><td class=\"system-processes__empty\" colspan=\"4\">" + html_escape(no_processes_label) + "</td></tr>");
+        append("                    </tbody>");
+        append("                  </table>");
+        append("                </div>");
+    }
+    append("              </div>");
+    append("            </article>");
     append("          </div>");
     append("        </section>");
     append("      </main>");
     append("    </div>");
     append("  </div>");
     append("  <script id=\"initial-system-status\" type=\"application/json\">");
-    append(initial_json);
+    std::string script_json;
+    append_json_for_script(script_json, initial_json);
+    append(script_json);
     append("  </script>");
     append("  <script>");
     append("    (function() {");
@@ -1883,11 +1898,16 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("        unavailable: dataset.labelUnavailable || 'Unavailable',");
     append("        connected: dataset.labelConnected || 'Connected',");
     append("        notConnected: dataset.labelNotConnected || 'Not connected',");
+    append("        handshakeFailed: dataset.labelHandshakeFailed || 'Handshake failed',");
     append("        noPorts: dataset.labelNoPorts || 'No listening ports detected.',");
+    append("        unknownOwner: dataset.labelUnknownOwner || 'Unknown owner',");
     append("        noTelemetry: dataset.labelNoTelemetry || 'No telemetry received yet.',");
     append("        updated: dataset.labelUpdated || 'Updated',");
     append("        interface: dataset.labelInterface || 'Interface',");
     append("        unknown: dataset.labelUnknown || 'Unknown',");
+    append("        noProcesses: dataset.labelNoProcesses || 'No process data available.',");
+    append("        noAlerts: dataset.labelNoAlerts || 'No active alerts.',");
+    append("        since: dataset.labelSince || 'Since',");
     append("        battery: {");
     append("          charging: dataset.batteryLabelCharging || 'Charging',");
     append("          discharging: dataset.batteryLabelDischarging || 'Discharging',");
@@ -1908,8 +1928,12 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("      const debianBootEl = doc.querySelector('[data-role=\"debian-boot\"]');");
     append("      const debianLoadEl = doc.querySelector('[data-role=\"debian-load\"]');");
     append("      const wsUptimeEl = doc.querySelector('[data-role=\"ws-uptime\"]');");
+    append("      const wsLatencyEl = doc.querySelector('[data-role=\"ws-latency\"]');");
     append("      const portsContainer = doc.querySelector('[data-role=\"ports-list\"]');");
     append("      const updatedValueEl = doc.querySelector('[data-role=\"updated-value\"]');");
+    append("      const processesCpuEl = doc.querySelector('[data-role=\"processes-cpu\"]');");
+    append("      const alertsListEl = doc.querySelector('[data-role=\"alerts-list\"]');");
+    append("      const processesMemoryEl = doc.querySelector('[data-role=\"processes-memory\"]');");
     append("      const statusClasses = ['status-indicator--ok', 'status-indicator--warn', 'status-indicator--idle'];");
     append("      const setStatus = (el, text, tone) => {");
     append("        if (!el) {");
@@ -1959,11 +1983,36 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("        parts.push(`${pad(secs)}s`);");
     append("        return parts.join(' ');");
     append("      };");
-    append("      const renderPorts = (ports) => {");
+    append("      const shortCommandName = (command) => {");
+    append("        const first = (command || '').toString().trim().split(' ')[0] || '';");
+    append("        const slash = first.lastIndexOf('/');");
+    append("        return slash >= 0 ? first.slice(slash + 1) : first;");
+    append("      };");
+    append("      const renderPorts = (network) => {");
     append("        if (!portsContainer) {");
     append("          return;");
     append("        }");
     append("        portsContainer.textContent = '';");
+    append("        const sockets = network && Array.isArray(network.listeningSockets) ? network.listeningSockets : [];");
+    append("        if (sockets.length > 0) {");
+    append("          sockets.forEach((socket) => {");
+    append("            const owner = typeof socket.pid === 'number' ? `${shortCommandName(socket.command)} (${socket.pid})` : strings.unknownOwner;");
+    append("            const pill = doc.createElement('span');");
+    append("            pill.className = 'system-port-pill';");
+    append("            pill.title = socket.command || owner;");
+    append("            const portEl = doc.createElement('span');");
+    append("            portEl.className = 'system-port-pill__port';");
+    append("            portEl.textContent = socket.port;");
+    append("            const ownerEl = doc.createElement('span');");
+    append("            ownerEl.className = 'system-port-pill__owner';");
+    append("            ownerEl.textContent = owner;");
+    append("            pill.appendChild(portEl);");
+    append("            pill.appendChild(ownerEl);");
+    append("            portsContainer.appendChild(pill);");
+    append("          });");
+    append("          return;");
+    append("        }");
+    append("        const ports = network ? network.listeningPorts : null;");
     append("        if (!Array.isArray(ports) || ports.length === 0) {");
     append("          const message = doc.createElement('p');");
     append("          message.className = 'system-ports__empty';");
@@ -1979,6 +2028,80 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("          portsContainer.appendChild(pill);");
     append("        });");
     append("      };");
+    append("      const renderAlerts = (alerts) => {");
+    append("        if (!alertsListEl) {");
+    append("          return;");
+    append("        }");
+    append("        alertsListEl.textContent = '';");
+    append("        if (!Array.isArray(alerts) || alerts.length === 0) {");
+    append("          const empty = doc.createElement('li');");
+    append("          empty.className = 'system-alerts__empty';");
+    append("          empty.textContent = strings.noAlerts;");
+    append("          alertsListEl.appendChild(empty);");
+    append("          return;");
+    append("        }");
+    append("        alerts.forEach((alert) => {");
+    append("          const item = doc.createElement('li');");
+    append("          item.className = 'system-alerts__item';");
+    append("          const nameEl = doc.createElement('span');");
+    append("          nameEl.className = 'system-alerts__name';");
+    append("          nameEl.textContent = alert.name || '';");
+    append("          const conditionEl = doc.createElement('span');");
+    append("          conditionEl.className = 'system-alerts__condition';");
+    append("          conditionEl.textContent = `${alert.metric} ${alert.value} ${alert.comparator} ${alert.threshold}`;");
+    append("          item.appendChild(nameEl);");
+    append("          item.appendChild(conditionEl);");
+    append("          if (alert.since) {");
+    append("            const sinceEl = doc.createElement('span');");
+    append("            sinceEl.className = 'system-alerts__since';");
+    append("            sinceEl.textContent = `${strings.since} ${alert.since}`;");
+    append("            item.appendChild(sinceEl);");
+    append("          }");
+    append("          alertsListEl.appendChild(item);");
+    append("        });");
+    append("      };");
+    append("      const formatBytes = (bytes) => {");
+    append("        if (!isFiniteNumber(bytes) || bytes < 0) {");
+    append("          return strings.unknown;");
+    append("        }");
+    append("        const units = ['B', 'KiB', 'MiB', 'GiB'];");
+    append("        let value = bytes;");
+    append("        let unit = 0;");
+    append("        while (value >= 1024 && unit < units.length - 1) {");
+    append("          value /= 1024;");
+    append("          unit += 1;");
+    append("        }");
+    append("        return `${value.toFixed(unit === 0 ? 0 : 1)} ${units[unit]}`;");
+    append("      };");
+    append("      const renderProcessRows = (tbody, rows) => {");
+    append("        if (!tbody) {");
+    append("          return;");
+    append("        }");
+    append("        tbody.textContent = '';");
+    append("        if (!Array.isArray(rows) || rows.length === 0) {");
+    append("          const row = doc.createElement('tr');");
+    append("          const cell = doc.createElement('td');");
+    append("          cell.className = 'system-processes__empty';");
+    append("          cell.colSpan = 4;");
+    append("          cell.textContent = strings.noProcesses;");
+    append("          row.appendChild(cell);");
+    append("          tbody.appendChild(row);");
+    append("          return;");
+    append("        }");
+    append("        rows.forEach((process) => {");
+    append("          const row = doc.createElement('tr');");
+    append("          const cpu = isFiniteNumber(process.cpuPercent) ? `${Number(process.cpuPercent).toFixed(1)}%` : strings.unknown;");
+    append("          [String(process.pid), process.command || strings.unknown, cpu, formatBytes(process.rssBytes)].forEach((text, index) => {");
+    append("            const cell = doc.createElement('td');");
+    append("            if (index >= 2) {");
+    append("              cell.className = 'system-processes__numeric';");
+    append("            }");
+    append("            cell.textContent = text;");
+    append("            row.appendChild(cell);");
+    append("          });");
+    append("          tbody.appendChild(row);");
+    append("        });");
+    append("      };");
     append("      const renderBattery = (battery) => {");
     append("        if (!batteryStatusEl) {");
     append("          return;");
@@ -2011,6 +2134,27 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("          batteryStatusEl.textContent = mapped || strings.battery.unavailable;");
     append("        }");
     append("      };");
+    append("      // Uptimes do not make a new status version; they are counted on here from");
+    append("      // bootEpoch and upSinceEpoch, or shown as sampled when those are missing.");
+    append("      let uptimeSource = null;");
+    append("      const renderUptimes = () => {");
+    append("        if (!uptimeSource) {");
+    append("          return;");
+    append("        }");
+    append("        const now = Date.now() / 1000;");
+    append("        const debian = uptimeSource.debian || {};");
+    append("        if (isFiniteNumber(debian.bootEpoch)) {");
+    append("          setText(debianUptimeEl, formatDuration(now - debian.bootEpoch));");
+    append("        } else {");
+    append("          setText(debianUptimeEl, debian.uptimeHuman || strings.unknown);");
+    append("        }");
+    append("        const websocket = uptimeSource.websocket || {};");
+    append("        if (isFiniteNumber(websocket.upSinceEpoch)) {");
+    append("          setText(wsUptimeEl, formatDuration(now - websocket.upSinceEpoch));");
+    append("        } else {");
+    append("          setText(wsUptimeEl, formatDuration(isFiniteNumber(websocket.uptimeSeconds) ? websocket.uptimeSeconds : -1));");
+    append("        }");
+    append("      };");
     append("      const renderData = (data) => {");
     append("        if (!data || typeof data !== 'object') {");
     append("          return;");
@@ -2038,8 +2182,10 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("        }");
     append("        const websocket = data.websocket || {};");
     append("        if (wsStatusEl) {");
-    append("          if (websocket.listening) {");
+    append("          if (websocket.reachable) {");
     append("            setStatus(wsStatusEl, strings.connected, 'ok');");
+    append("          } else if (websocket.listening) {");
+    append("            setStatus(wsStatusEl, strings.handshakeFailed, 'warn');");
     append("          } else if (websocket.address) {");
     append("            setStatus(wsStatusEl, strings.notConnected, 'warn');");
     append("          } else {");
@@ -2048,15 +2194,16 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("        }");
     append("        const lastMessage = (websocket.lastMessage || '').toString().trim();");
     append("        let fallbackMessage = strings.noTelemetry;");
-    append("        if (websocket.listening) {");
+    append("        if (websocket.reachable) {");
     append("          fallbackMessage = strings.connected;");
+    append("        } else if (websocket.probeError) {");
+    append("          fallbackMessage = websocket.probeError;");
     append("        } else if (websocket.address) {");
     append("          fallbackMessage = strings.notConnected;");
     append("        }");
     append("        setText(wsLastMessageEl, lastMessage ? lastMessage : fallbackMessage);");
     append("        renderBattery(data.battery);");
     append("        if (debianUptimeEl && data.debian) {");
-    append("          setText(debianUptimeEl, data.debian.uptimeHuman || strings.unknown);");
     append("          setText(debianBootEl, data.debian.bootTime || strings.unknown);");
     append("          if (Array.isArray(data.debian.loadAverage) && data.debian.loadAverage.length >= 3) {");
     append("            const formatted = data.debian.loadAverage.slice(0, 3).map((value) => {");
@@ -2067,11 +2214,22 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("            setText(debianLoadEl, strings.unknown);");
     append("          }");
     append("        }");
-    append("        if (wsUptimeEl) {");
-    append("          const uptimeSeconds = websocket.uptimeSeconds;");
-    append("          setText(wsUptimeEl, formatDuration(typeof uptimeSeconds === 'number' ? uptimeSeconds : -1));");
+    append("        uptimeSource = data;");
+    append("        renderUptimes();");
+    append("        if (wsLatencyEl) {");
+    append("          const roundTrip = websocket.roundTripLatency || {};");
+    append("          const connect = websocket.connectLatency || {};");
+    append("          const formatMs = (value) => (isFiniteNumber(value) ? `${Number(value).toFixed(1)} ms` : '–');");
+    append("          if (roundTrip.samples > 0) {");
+    append("            setText(wsLatencyEl, `p50 ${formatMs(roundTrip.p50Ms)} · p90 ${formatMs(roundTrip.p90Ms)} · p99 ${formatMs(roundTrip.p99Ms)}`);");
+    append("            wsLatencyEl.title = `connect p50 ${formatMs(connect.p50Ms)} · p99 ${formatMs(connect.p99Ms)} (${roundTrip.samples})`;");
+    append("          } else {");
+    append("            setText(wsLatencyEl, strings.unknown);");
+    append("            wsLatencyEl.title = '';");
+    append("          }");
     append("        }");
-    append("        renderPorts(data.network ? data.network.listeningPorts : null);");
+    append("        renderPorts(data.network || null);");
+    append("        renderAlerts(data.alerts);");
     append("        if (updatedValueEl) {");
     append("          setText(updatedValueEl, data.generatedAt || strings.unknown);");
     append("        }");
@@ -2088,31 +2246,141 @@ std::string generate_beaversystem_dashboard_html(const TranslationCatalog& trans
     append("          return null;");
     append("        }");
     append("      };");
-    append("      const fetchLatest = () => {");
+    append("      let currentStatus = null;");
+    append("      let currentVersion = 0;");
+    append("      // Versions restart with the server; the epoch tells two runs apart.");
+    append("      let currentEpoch = '';");
+    append("      const setPath = (target, path, value, remove) => {");
+    append("        const keys = path.split('.');");
+    append("        let node = target;");
+    append("        for (let i = 0; i < keys.length - 1; i += 1) {");
+    append("          if (!node[keys[i]] || typeof node[keys[i]] !== 'object') {");
+    append("            node[keys[i]] = {};");
+    append("          }");
+    append("          node = node[keys[i]];");
+    append("        }");
+    append("        if (remove) {");
+    append("          delete node[keys[keys.length - 1]];");
+    append("        } else {");
+    append("          node[keys[keys.length - 1]] = value;");
+    append("        }");
+    append("      };");
+    append("      // Applies a {type:'status'} update; returns false when a delta does not");
+    append("      // start from the version and epoch we hold and a full resync is needed.");
+    append("      const applyUpdate = (update) => {");
+    append("        if (!update || update.type !== 'status') {");
+    append("          return false;");
+    append("        }");
+    append("        if (update.mode === 'full' && update.status) {");
+    append("          currentStatus = update.status;");
+    append("          currentEpoch = update.epoch || '';");
+    append("        } else if (update.mode === 'delta' && currentStatus && update.epoch === currentEpoch &&");
+    append("                   update.since === currentVersion) {");
+    append("          const changes = update.changes || {};");
+    append("          Object.keys(changes).forEach((path) => setPath(currentStatus, path, changes[path], false));");
+    append("          (update.removed || []).forEach((path) => setPath(currentStatus, path, null, true));");
+    append("        } else {");
+    append("          return false;");
+    append("        }");
+    append("        currentVersion = update.version;");
+    append("        renderData(currentStatus);");
+    append("        return true;");
+    append("      };");
+    append("      const fetchLatest = (forceFull) => {");
     append("        if (typeof fetch !== 'function') {");
     append("          return;");
     append("        }");
-    append("        fetch('/api/system/status', { cache: 'no-cache' })");
+    append("        const since = forceFull || !currentEpoch ? '0' : `${currentEpoch}-${currentVersion}`;");
+    append("        fetch(`/api/system/status?since=${since}`, { cache: 'no-cache' })");
     append("          .then((response) => {");
+    append("            if (response.status === 304) {");
+    append("              return null;");
+    append("            }");
     append("            if (!response.ok) {");
     append("              throw new Error(`HTTP ${response.status}`);");
     append("            }");
     append("            return response.json();");
     append("          })");
     append("          .then((payload) => {");
-    append("            renderData(payload);");
+    append("            if (payload && !applyUpdate(payload) && !forceFull) {");
+    append("              fetchLatest(true);");
+    append("            }");
     append("          })");
     append("          .catch((error) => {");
     append("            console.warn('[BeaverSystem] Failed to refresh system status.', error);");
     append("          });");
     append("      };");
+    append("      const fetchProcesses = () => {");
+    append("        if (typeof fetch !== 'function') {");
+    append("          return;");
+    append("        }");
+    append("        fetch('/api/system/processes?limit=8', { cache: 'no-cache' })");
+    append("          .then((response) => {");
+    append("            if (!response.ok) {");
+    append("              throw new Error(`HTTP ${response.status}`);");
+    append("            }");
+    append("            return response.json();");
+    append("          })");
+    append("          .then((payload) => {");
+    append("            renderProcessRows(processesCpuEl, payload ? payload.topCpu : null);");
+    append("            renderProcessRows(processesMemoryEl, payload ? payload.topMemory : null);");
+    append("          })");
+    append("          .catch((error) => {");
+    append("            console.warn('[BeaverSystem] Failed to refresh process table.', error);");
+    append("          });");
+    append("      };");
     append("      const initial = parseInitial();");
     append("      if (initial) {");
+    append("        currentStatus = initial;");
     append("        renderData(initial);");
     append("      }");
+    append("      window.setInterval(renderUptimes, 1000);");
+    append("      let pollTimer = null;");
+    append("      const startPolling = () => {");
+    append("        if (pollTimer !== null) {");
+    append("          return;");
+    append("        }");
+    append("        fetchLatest(false);");
+    append("        pollTimer = window.setInterval(() => fetchLatest(false), 15000);");
+    append("      };");
+    append("      const stopPolling = () => {");
+    append("        if (pollTimer !== null) {");
+    append("          window.clearInterval(pollTimer);");
+    append("          pollTimer = null;");
+    append("        }");
+    append("      };");
+    append("      const connectStream = () => {");
+    append("        if (typeof window.EventSource !== 'function') {");
+    append("          startPolling();");
+    append("          return;");
+    append("        }");
+    append("        const source = new window.EventSource('/api/system/stream');");
+    append("        source.addEventListener('status', (event) => {");
+    append("          stopPolling();");
+    append("          let applied = false;");
+    append("          try {");
+    append("            applied = applyUpdate(JSON.parse(event.data));");
+    append("          } catch (error) {");
+    append("            console.warn('[BeaverSystem] Unable to parse streamed system status.', error);");
+    append("          }");
+    append("          if (!applied) {");
+    append("            // Out of sync: a fresh connection carries no Last-Event-ID and starts with a full update.");
+    append("            source.close();");
+    append("            connectStream();");
+    append("          }");
+    append("        });");
+    append("        source.addEventListener('error', () => {");
+    append("          // EventSource retries on its own; poll meanwhile so values keep moving.");
+    append("          startPolling();");
+    append("          if (source.readyState === window.EventSource.CLOSED) {");
+    append("            window.setTimeout(connectStream, 30000);");
+    append("          }");
+    append("        });");
+    append("      };");
     append("      if (window.location && (window.location.protocol === 'http:' || window.location.protocol === 'https:')) {");
-    append("        fetchLatest();");
-    append("        window.setInterval(fetchLatest, 15000);");
+    append("        connectStream();");
+    append("        fetchProcesses();");
+    append("        window.setInterval(fetchProcesses, 1000);");
     append("      }");
     append("    })();");
     append("  </script>");
@@ -2,27 +2,145 @@
 
 #include <arpa/inet.h>
 #include <algorithm>
+#include <chrono>
 #include <csignal>
+#include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <iostream>
+#include <utility>
 #include <cctype>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <thread>
 #include <unistd.h>
 
+#include "core/access_log.h"
+#include "core/asset_manifest.h"
+#include "core/json_writer.h"
+#include "core/log.h"
+#include "core/profiler.h"
+#include "core/resource_bundle.h"
 #include "core/system_status.h"
+#include "core/trace.h"
+#include "core/websocket_probe.h"
+
+namespace {
+
+void set_content_language(HttpResponse& response, Language language) {
+    response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
+}
+
+constexpr std::chrono::seconds kDialForwardTimeout{3};
+
+bool is_loopback_host(const std::string& host) {
+    return host == "localhost" || host == "127.0.0.1" || host == "::1";
+}
+
+// Default dial handler: hands the dial to the dial service in the message
+// format the pages used to send it directly. Only a frame the service took
+// counts as accepted.
+DialResult forward_dial(const DialRequest& request, int http_port) {
+    const std::string address = dial_service_address();
+    const auto endpoint = parse_websocket_address(address);
+    if (!endpoint || endpoint->secure) {
+        log_warning("Dial request: %s not placed, unusable dial service address %s",
+                    request.number.c_str(), address.c_str());
+        return {false, "Dial service address is not usable"};
+    }
+    // Our own /ws would hand the dial straight back to this handler.
+    if (endpoint->port == http_port && is_loopback_host(endpoint->host)) {
+        log_warning("Dial request: %s not placed, %s is this server", request.number.c_str(),
+                    address.c_str());
+        return {false, "No dial service configured"};
+    }
+
+    std::string message;
+    JsonWriter json(message, JsonStyle::kCompact);
+    json.begin_object();
+    json.key("type").string("dial");
+    json.key("action").string("dial");
+    json.key("number").string(request.number);
+    if (!request.source.empty()) {
+        json.key("source").string(request.source);
+    }
+    json.end_object();
+    json.finish();
+
+    const std::string error = send_websocket_text(*endpoint, message, kDialForwardTimeout);
+    if (!error.empty()) {
+        log_warning("Dial request: %s not placed, %s: %s", request.number.c_str(),
+                    address.c_str(), error.c_str());
+        return {false, "Dial service unreachable: " + error};
+    }
+    log_message("Dial request: %s sent to %s", request.number.c_str(), address.c_str());
+    return {true, "Sent to dial service"};
+}
+
+// /debug/trace and /debug/profile are served only with BEAVER_DEBUG_ENDPOINTS=1.
+bool debug_endpoints_enabled() {
+    const char* enabled = std::getenv("BEAVER_DEBUG_ENDPOINTS");
+    return enabled != nullptr && std::strcmp(enabled, "1") == 0;
+}
+
+// Only one /debug/trace capture runs at a time.
+std::atomic<bool> g_trace_capture_running{false};
+
+// True unless Accept-Encoding leaves gzip out or refuses it with q=0.
+bool accepts_gzip(std::string_view accept_encoding) {
+    while (!accept_encoding.empty()) {
+        const std::size_t comma = accept_encoding.find(',');
+        std::string_view coding = accept_encoding.substr(0, comma);
+        accept_encoding.remove_prefix(comma == std::string_view::npos ? accept_encoding.size()
+                                                                      : comma + 1);
+        std::string_view parameters;
+        if (const std::size_t semicolon = coding.find(';');
+            semicolon != std::string_view::npos) {
+            parameters = coding.substr(semicolon + 1);
+            coding = coding.substr(0, semicolon);
+        }
+        while (!coding.empty() && std::isspace(static_cast<unsigned char>(coding.front()))) {
+            coding.remove_prefix(1);
+        }
+        while (!coding.empty() && std::isspace(static_cast<unsigned char>(coding.back()))) {
+            coding.remove_suffix(1);
+        }
+        if (coding != "gzip" && coding != "x-gzip" && coding != "*") {
+            continue;
+        }
+        const std::size_t quality = parameters.find("q=");
+        return quality == std::string_view::npos ||
+               std::strtod(std::string(parameters.substr(quality + 2)).c_str(), nullptr) > 0.0;
+    }
+    return false;
+}
+
+}  // namespace
 
 HttpServerApp* HttpServerApp::active_instance_ = nullptr;
 
 HttpServerApp::HttpServerApp(AppManager& manager, int port)
     : manager_(manager),
+      sse_broadcaster_(status_sampler_),
+      websocket_hub_(status_sampler_),
+      active_requests_(metrics().gauge("beaver_active_connections",
+                                       "Open client connections by kind.", {{"kind", "http"}})),
+      status_cache_("status_conditional"),
       port_(port),
       server_socket_(-1),
-      running_(false) {}
+      running_(false) {
+    // Hash every public/ file now rather than on the first page request.
+    asset_manifest();
+    register_routes();
+    websocket_hub_.set_dial_handler(
+        [port](const DialRequest& request) { return forward_dial(request, port); });
+}
 
 HttpServerApp::~HttpServerApp() {
     stop();
+    websocket_hub_.stop();
+    sse_broadcaster_.stop();
+    status_sampler_.stop();
+    set_status_http_port(0);
     if (active_instance_ == this) {
         active_instance_ = nullptr;
     }
@@ -82,12 +200,27 @@ int HttpServerApp::run() {
         return 1;
     }
 
+    if (const std::string capture_path = traffic_capture_path_from_environment();
+        !capture_path.empty()) {
+        if (traffic_capture_.start(capture_path)) {
+            std::cout << "Capturing HTTP traffic to " << capture_path << std::endl;
+        } else {
+            std::cerr << "Could not open capture file " << capture_path << std::endl;
+        }
+    }
+
     running_ = true;
+    set_status_http_port(static_cast<std::uint16_t>(port_));
+    status_sampler_.start();
+    sse_broadcaster_.start();
+    websocket_hub_.start();
 
     std::cout << "==================================================" << std::endl;
     std::cout << "BeaverKiosk C++ HTTP Server" << std::endl;
     std::cout << "==================================================" << std::endl;
     std::cout << "Server running on http://0.0.0.0:" << port_ << std::endl;
+    std::cout << "Assets: " << resource_source() << ", " << asset_manifest().size()
+              << " fingerprinted" << std::endl;
     std::cout << "Press Ctrl+C to stop" << std::endl;
     std::cout << "==================================================" << std::endl;
 
@@ -108,23 +241,358 @@ int HttpServerApp::run() {
     }
 
     stop();
+    websocket_hub_.stop();
+    sse_broadcaster_.stop();
+    status_sampler_.stop();
+    if (traffic_capture_.running()) {
+        traffic_capture_.stop();
+        std::cout << "Captured " << traffic_capture_.recorded() << " requests ("
+                  << traffic_capture_.dropped() << " dropped)" << std::endl;
+    }
     return 0;
 }
 
+void HttpServerApp::set_dial_handler(DialHandler handler) {
+    websocket_hub_.set_dial_handler(std::move(handler));
+}
+
 void HttpServerApp::stop() {
     running_ = false;
     if (server_socket_ >= 0) {
+        // Wakes an accept() blocked on another thread; close() alone does not.
+        shutdown(server_socket_, SHUT_RDWR);
         close(server_socket_);
         server_socket_ = -1;
     }
 }
 
-std::string HttpServerApp::read_file(const std::string& filepath) const {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        return {};
+void HttpServerApp::register_routes() {
+    constexpr const char* kHtml = "text/html; charset=utf-8";
+    constexpr const char* kJson = "application/json; charset=utf-8";
+
+    for (const AppPageRoute& page_route : app_page_routes()) {
+        const AppPage page = page_route.page;
+        router_.add(
+            page_route.path,
+            [this, page](HttpRouteContext& context) {
+                context.response.body =
+                    manager_.page_html(page, context.language, MenuRouteMode::kHttpServer);
+                set_content_language(context.response, context.language);
+            },
+            {RouteKind::kExact, RouteCaching::kNoStore, kHtml});
+    }
+
+    router_.add(
+        "/api/menu",
+        [this](HttpRouteContext& context) {
+            context.response.body = manager_.to_json(context.language);
+            context.response.headers["Access-Control-Allow-Origin"] = "*";
+            set_content_language(context.response, context.language);
+        },
+        {RouteKind::kExact, RouteCaching::kUnspecified, kJson});
+
+    router_.add(
+        "/api/system/status",
+        [this](HttpRouteContext& context) {
+            // ?since=<epoch>-N answers with a delta relative to version N, or a full
+            // resync when N is unknown or from another epoch. Without it the plain
+            // status document is returned, tagged with its version token.
+            HttpResponse& response = context.response;
+            const auto status = status_sampler_.latest();
+            const auto since_it = context.query.find("since");
+            if (!status) {
+                response.body = system_status_to_json(collect_system_status());
+            } else if (since_it != context.query.end()) {
+                const StatusUpdate update =
+                    status_sampler_.update_since(
+                        status_sampler_.parse_version_token(since_it->second));
+                status_cache_.record(update.kind == StatusUpdateKind::kUnchanged);
+                if (update.kind == StatusUpdateKind::kUnchanged) {
+                    response.status_code = 304;
+                    response.status_text = "Not Modified";
+                } else {
+                    response.body = update.payload;
+                }
+            } else {
+                const std::string etag =
+                    "\"" + status_sampler_.version_token(status->version) + "\"";
+                response.headers["ETag"] = etag;
+                const bool not_modified =
+                    find_http_header(context.request, "If-None-Match") == etag;
+                status_cache_.record(not_modified);
+                if (not_modified) {
+                    response.status_code = 304;
+                    response.status_text = "Not Modified";
+                } else {
+                    response.body = status->json;
+                }
+            }
+            response.headers["Access-Control-Allow-Origin"] = "*";
+            set_content_language(response, context.language);
+        },
+        {RouteKind::kExact, RouteCaching::kNoStore, kJson});
+
+    router_.add("/ws", [this](HttpRouteContext& context) {
+        if (websocket_hub_.accept_upgrade(context.client_socket, context.request)) {
+            // Only recorded in the access log; the hub already answered.
+            context.response.status_code = 101;
+            context.detached = true;
+            return;
+        }
+        context.response.status_code = 400;
+        context.response.status_text = "Bad Request";
+        context.response.body = "Expected a WebSocket upgrade";
+        context.response.headers["Content-Type"] = "text/plain; charset=utf-8";
+    });
+
+    router_.add("/api/system/stream", [this](HttpRouteContext& context) {
+        const std::string last_event_id = find_http_header(context.request, "Last-Event-ID");
+        if (sse_broadcaster_.add_subscriber(
+                context.client_socket, status_sampler_.parse_version_token(last_event_id))) {
+            context.detached = true;
+            return;
+        }
+        context.response.status_code = 503;
+        context.response.status_text = "Service Unavailable";
+        context.response.body = "Too many stream subscribers";
+        context.response.headers["Content-Type"] = "text/plain; charset=utf-8";
+        context.response.headers["Retry-After"] = "30";
+    });
+
+    router_.add(
+        "/api/system/processes",
+        [this](HttpRouteContext& context) {
+            constexpr std::size_t kDefaultProcessLimit = 10;
+            constexpr std::size_t kMaxProcessLimit = 50;
+            std::size_t limit = kDefaultProcessLimit;
+            auto limit_it = context.query.find("limit");
+            if (limit_it != context.query.end()) {
+                try {
+                    const unsigned long parsed = std::stoul(limit_it->second);
+                    limit = std::min<std::size_t>(parsed, kMaxProcessLimit);
+                } catch (const std::exception&) {
+                    limit = kDefaultProcessLimit;
+                }
+            }
+            context.response.body = process_table_to_json(process_scanner_.scan(limit));
+            context.response.headers["Access-Control-Allow-Origin"] = "*";
+        },
+        {RouteKind::kExact, RouteCaching::kNoStore, kJson});
+
+    router_.add(
+        "/css",
+        [this](HttpRouteContext& context) {
+            serve_public_asset(context, "css", "CSS file not found");
+        },
+        {RouteKind::kPrefix, RouteCaching::kRevalidate, "text/css; charset=utf-8"});
+
+    router_.add(
+        "/icons",
+        [this](HttpRouteContext& context) {
+            serve_public_asset(context, "icons", "Icon not found");
+        },
+        {RouteKind::kPrefix, RouteCaching::kPublic, "image/svg+xml"});
+    router_.add(
+        "/contact",
+        [this](HttpRouteContext& context) {
+            serve_public_asset(context, "contact", "Contact asset not found");
+        },
+        {RouteKind::kPrefix, RouteCaching::kPublic, "image/svg+xml"});
+
+    router_.add(
+        "/metrics",
+        [](HttpRouteContext& context) { metrics().write_openmetrics(context.response.body); },
+        {RouteKind::kExact, RouteCaching::kNoStore, kOpenMetricsContentType});
+
+    // Captures hold the CPU and expose internals, so they are opt-in.
+    if (debug_endpoints_enabled()) {
+        register_debug_routes();
+    }
+
+    for (const auto& route : router_.routes()) {
+        route_metrics_.push_back(RouteMetrics{route.pattern});
+    }
+    route_metrics_.push_back(RouteMetrics{"unmatched"});
+}
+
+void HttpServerApp::register_debug_routes() {
+    router_.add("/debug/trace", [](HttpRouteContext& context) {
+        // Records for ?seconds=N (default 5, at most 60), then answers with the
+        // Chrome trace JSON from a helper thread so other requests keep flowing.
+        constexpr int kDefaultSeconds = 5;
+        constexpr int kMaxSeconds = 60;
+        int seconds = kDefaultSeconds;
+        if (const auto it = context.query.find("seconds"); it != context.query.end()) {
+            try {
+                seconds = std::clamp(std::stoi(it->second), 1, kMaxSeconds);
+            } catch (const std::exception&) {
+                seconds = kDefaultSeconds;
+            }
+        }
+        if (g_trace_capture_running.exchange(true)) {
+            context.response.status_code = 409;
+            context.response.status_text = "Conflict";
+            context.response.body = "A trace capture is already running";
+            context.response.headers["Content-Type"] = "text/plain; charset=utf-8";
+            return;
+        }
+
+        start_tracing();
+        const auto since = std::chrono::steady_clock::now();
+        const int client_socket = context.client_socket;
+        std::thread([client_socket, seconds, since] {
+            std::this_thread::sleep_for(std::chrono::seconds(seconds));
+            HttpResponse response;
+            response.body = trace_events_json(since);
+            stop_tracing();
+            g_trace_capture_running.store(false);
+            response.headers["Content-Type"] = "application/json; charset=utf-8";
+            response.headers["Cache-Control"] = route_cache_control(RouteCaching::kNoStore);
+            const std::string text = build_http_response(response);
+            send(client_socket, text.data(), text.size(), MSG_NOSIGNAL);
+            close(client_socket);
+        }).detach();
+        context.detached = true;
+    });
+
+    router_.add("/debug/profile", [](HttpRouteContext& context) {
+        // Samples CPU stacks for ?seconds=N (default 10, at most 60) at ?hz=N
+        // (default 100), then answers with folded stacks from a helper thread.
+        constexpr int kDefaultSeconds = 10;
+        constexpr int kMaxSeconds = 60;
+        int seconds = kDefaultSeconds;
+        int frequency_hz = 100;
+        try {
+            if (const auto it = context.query.find("seconds"); it != context.query.end()) {
+                seconds = std::clamp(std::stoi(it->second), 1, kMaxSeconds);
+            }
+            if (const auto it = context.query.find("hz"); it != context.query.end()) {
+                frequency_hz = std::stoi(it->second);
+            }
+        } catch (const std::exception&) {
+            seconds = kDefaultSeconds;
+            frequency_hz = 100;
+        }
+        if (!start_profiling(frequency_hz)) {
+            context.response.status_code = 409;
+            context.response.status_text = "Conflict";
+            context.response.body = "A profile is already running";
+            context.response.headers["Content-Type"] = "text/plain; charset=utf-8";
+            return;
+        }
+
+        const int client_socket = context.client_socket;
+        std::thread([client_socket, seconds] {
+            std::this_thread::sleep_for(std::chrono::seconds(seconds));
+            HttpResponse response;
+            response.body = stop_profiling();
+            response.headers["Content-Type"] = "text/plain; charset=utf-8";
+            response.headers["Cache-Control"] = route_cache_control(RouteCaching::kNoStore);
+            const std::string text = build_http_response(response);
+            send(client_socket, text.data(), text.size(), MSG_NOSIGNAL);
+            close(client_socket);
+        }).detach();
+        context.detached = true;
+    });
+}
+
+void HttpServerApp::record_request(const HttpRequest& request, std::size_t route_index,
+                                   int status, std::size_t bytes,
+                                   std::chrono::steady_clock::time_point started,
+                                   const AllocationCounts& allocations) {
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    // The status probe upgrades /ws every second when it checks this server;
+    // it is counted in the route metrics but kept out of the access log.
+    if (find_http_header(request, "User-Agent") != kWebSocketProbeUserAgent) {
+        access_log().log_request(request.method, request.path, status, bytes,
+                                 std::chrono::duration_cast<std::chrono::microseconds>(elapsed));
+    }
+
+    RouteMetrics& route = route_metrics_[route_index];
+    if (route.response_bytes == nullptr) {
+        route.response_bytes = &metrics().counter(
+            "beaver_http_response_bytes", "Bytes sent in HTTP responses, by route.",
+            {{"route", route.route}});
+    }
+    const int code = std::clamp(status, 100, 599);
+    Histogram*& duration = route.duration_by_status[static_cast<std::size_t>(code - 100)];
+    if (duration == nullptr) {
+        duration = &metrics().histogram(
+            "beaver_http_request_duration_seconds",
+            "Time from reading a request to sending its response, by route and status.",
+            {{"route", route.route}, {"status", std::to_string(code)}});
+    }
+    duration->observe(elapsed);
+    route.response_bytes->inc(bytes);
+
+    if (allocation_accounting_enabled()) {
+        if (route.allocations == nullptr) {
+            route.allocations = &metrics().counter(
+                "beaver_http_allocations",
+                "Heap allocations made while handling requests, by route.",
+                {{"route", route.route}});
+            route.allocated_bytes = &metrics().counter(
+                "beaver_http_allocated_bytes",
+                "Bytes allocated while handling requests, by route.", {{"route", route.route}});
+        }
+        route.allocations->inc(allocations.allocations);
+        route.allocated_bytes->inc(allocations.bytes);
+    }
+}
+
+void HttpServerApp::serve_public_asset(HttpRouteContext& context, const std::string& directory,
+                                       const char* not_found_message) const {
+    HttpResponse& response = context.response;
+    const std::string_view relative_path = context.params.rest();
+    if (relative_path.empty() || relative_path.find("..") != std::string_view::npos) {
+        response.status_code = 400;
+        response.status_text = "Bad Request";
+        response.body = "Invalid asset path";
+        response.headers["Content-Type"] = "text/plain; charset=utf-8";
+        return;
+    }
+
+    const std::string asset = directory + "/" + std::string(relative_path);
+    if (const std::string* resource = asset_manifest().resource_for(asset)) {
+        // Overrides the route's policy: this URL always names these bytes.
+        response.headers["Cache-Control"] = route_cache_control(RouteCaching::kImmutable);
+        serve_resource(context, *resource, not_found_message);
+        return;
+    }
+    serve_resource(context, "public/" + asset, not_found_message);
+}
+
+void HttpServerApp::serve_resource(HttpRouteContext& context, const std::string& path,
+                                   const char* not_found_message) const {
+    HttpResponse& response = context.response;
+    const std::shared_ptr<const Resource> resource = find_resource(path);
+    if (!resource) {
+        response.status_code = 404;
+        response.status_text = "Not Found";
+        response.body = not_found_message;
+        response.headers["Content-Type"] = "text/plain; charset=utf-8";
+        return;
+    }
+
+    const bool gzip = !resource->gzip.empty() &&
+                      accepts_gzip(find_http_header(context.request, "Accept-Encoding"));
+    // Each encoding is a representation of its own and needs its own strong tag.
+    const std::string etag = "\"" + std::string(resource->hash) + (gzip ? "-gz\"" : "\"");
+    response.headers["ETag"] = etag;
+    if (!resource->gzip.empty()) {
+        response.headers["Vary"] = "Accept-Encoding";
+    }
+    if (find_http_header(context.request, "If-None-Match") == etag) {
+        response.status_code = 304;
+        response.status_text = "Not Modified";
+        return;
+    }
+    if (gzip) {
+        response.headers["Content-Encoding"] = "gzip";
+        response.body = resource->gzip;
+    } else {
+        response.body = resource->data;
     }
-    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
 }
 
 void HttpServerApp::handle_request(int client_socket) {
@@ -137,10 +605,18 @@ void HttpServerApp::handle_request(int client_socket) {
         return;
     }
 
+    const auto started = std::chrono::steady_clock::now();
+    const AllocationScope allocations;
+    // Declared first so the path the span points at outlives it.
+    HttpRequest request;
+    TraceSpan request_span("http.request");
+    active_requests_.add(1);
     std::string raw_request(buffer, static_cast<std::size_t>(bytes_read));
-    HttpRequest request = parse_http_request(raw_request);
-
-    std::cout << request.method << " " << request.path << std::endl;
+    {
+        TraceSpan span("http.parse");
+        request = parse_http_request(raw_request);
+    }
+    request_span.set_detail(request.path);
 
     HttpResponse response;
 
@@ -170,107 +646,55 @@ void HttpServerApp::handle_request(int client_socket) {
         }
     }
 
-    constexpr const char* kHttpAssetPrefix = "/";
-
-    auto serve_public_asset = [&](const std::string& url_prefix, const char* content_type,
-                                  const char* cache_control, const char* not_found_message) {
-        if (path.rfind(url_prefix, 0) != 0) {
-            return false;
-        }
-
-        std::string relative_path = path.substr(url_prefix.size());
-        if (relative_path.empty() || relative_path.find("..") != std::string::npos) {
-            response.status_code = 400;
-            response.status_text = "Bad Request";
-            response.body = "Invalid asset path";
-            response.headers["Content-Type"] = "text/plain; charset=utf-8";
-            return true;
-        }
-
-        std::string file_path = "public" + path;
-        response.body = read_file(file_path);
-        if (response.body.empty()) {
-            response.status_code = 404;
-            response.status_text = "Not Found";
-            response.body = not_found_message;
-            response.headers["Content-Type"] = "text/plain; charset=utf-8";
-        } else {
-            response.headers["Content-Type"] = content_type;
-            if (cache_control != nullptr && cache_control[0] != '\0') {
-                response.headers["Cache-Control"] = cache_control;
-            }
-        }
-
-        return true;
-    };
-
-    if (path == "/" || path == "/index.html") {
-        response.body =
-            manager_.to_html(language, kHttpAssetPrefix, MenuRouteMode::kHttpServer);
-        response.headers["Content-Type"] = "text/html; charset=utf-8";
-        response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/apps/beavertask") {
-        response.body = manager_.beavertask_page_html(
-            language, kHttpAssetPrefix, BeaverTaskMenuLinkMode::kAbsoluteRoot);
-        response.headers["Content-Type"] = "text/html; charset=utf-8";
-        response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/apps/beaverphone") {
-        response.body = manager_.beaverphone_page_html(
-            language, kHttpAssetPrefix, BeaverphoneMenuLinkMode::kAbsoluteRoot);
-        response.headers["Content-Type"] = "text/html; charset=utf-8";
-        response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/apps/beaveralarm") {
-        response.body = manager_.beaveralarm_page_html(
-            language, kHttpAssetPrefix, BeaverAlarmMenuLinkMode::kAbsoluteRoot);
-        response.headers["Content-Type"] = "text/html; charset=utf-8";
-        response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/apps/beaversystem") {
-        response.body = manager_.beaversystem_page_html(
-            language, kHttpAssetPrefix, BeaverSystemMenuLinkMode::kAbsoluteRoot);
-        response.headers["Content-Type"] = "text/html; charset=utf-8";
-        response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/api/menu") {
-        response.body = manager_.to_json(language);
-        response.headers["Content-Type"] = "application/json; charset=utf-8";
-        response.headers["Access-Control-Allow-Origin"] = "*";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/api/system/status") {
-        SystemStatusSnapshot snapshot = collect_system_status();
-        response.body = system_status_to_json(snapshot);
-        response.headers["Content-Type"] = "application/json; charset=utf-8";
-        response.headers["Access-Control-Allow-Origin"] = "*";
-        response.headers["Cache-Control"] = "no-cache, no-store, must-revalidate";
-        response.headers["Content-Language"] = language == Language::French ? "fr" : "en";
-    } else if (path == "/css/styles.css") {
-        response.body = read_file("public/css/styles.css");
-        if (response.body.empty()) {
-            response.status_code = 404;
-            response.status_text = "Not Found";
-            response.body = "CSS file not found";
-            response.headers["Content-Type"] = "text/plain; charset=utf-8";
-        } else {
-            response.headers["Content-Type"] = "text/css; charset=utf-8";
-            response.headers["Cache-Control"] = "no-cache";
-        }
-    } else if (serve_public_asset("/icons/", "image/svg+xml", "public, max-age=86400",
-                                   "Icon not found")) {
-        // Asset served.
-    } else if (serve_public_asset("/contact/", "image/svg+xml", "public, max-age=86400",
-                                   "Contact asset not found")) {
-        // Asset served.
-    } else {
+    RouteParams params;
+    const auto* route = router_.match(path, params);
+    std::size_t route_index = router_.routes().size();
+    if (route == nullptr) {
         response.status_code = 404;
         response.status_text = "Not Found";
         response.body = "<html><body><h1>404 - Not Found</h1><p>The requested path was not found.</p></body></html>";
         response.headers["Content-Type"] = "text/html; charset=utf-8";
+    } else {
+        HttpRouteContext context{client_socket, request, query_parameters, params, language,
+                                 response};
+        route_index = static_cast<std::size_t>(route - router_.routes().data());
+        TraceSpan handler_span("http.handler", route->pattern);
+        route->handler(context);
+        if (context.detached) {
+            // The socket now belongs to the stream or WebSocket hub.
+            active_requests_.sub(1);
+            record_request(request, route_index, response.status_code, 0, started,
+                           allocations.elapsed());
+            return;
+        }
+        // Error responses set their own headers; successful ones get the route's.
+        if (response.status_code < 400) {
+            if (route->options.content_type != nullptr) {
+                response.headers.emplace("Content-Type", route->options.content_type);
+            }
+            if (const char* cache_control = route_cache_control(route->options.caching)) {
+                response.headers.emplace("Cache-Control", cache_control);
+            }
+        }
     }
 
-    std::string response_str = build_http_response(response);
-    send(client_socket, response_str.c_str(), response_str.length(), 0);
-    close(client_socket);
+    std::string response_str;
+    {
+        TraceSpan span("http.build_response");
+        response_str = build_http_response(response);
+    }
+    ssize_t sent = 0;
+    {
+        TraceSpan span("http.send");
+        sent = send(client_socket, response_str.c_str(), response_str.length(), 0);
+        close(client_socket);
+    }
+    active_requests_.sub(1);
+    const std::size_t bytes_sent = sent > 0 ? static_cast<std::size_t>(sent) : 0;
+    record_request(request, route_index, response.status_code, bytes_sent, started,
+                   allocations.elapsed());
+    if (traffic_capture_.running()) {
+        traffic_capture_.record(started, raw_request, response.status_code, bytes_sent,
+                                std::chrono::steady_clock::now() - started);
+    }
 }
@@ -1,6 +1,7 @@
 #include "ui/http/http_utils.h"
 
 #include <algorithm>
+#include <cctype>
 #include <iomanip>
 #include <sstream>
 
@@ -113,3 +114,16 @@ std::map<std::string, std::string> parse_query_parameters(const std::string& que
 
     return parameters;
 }
+
+std::string find_http_header(const HttpRequest& request, const std::string& name) {
+    for (const auto& header : request.headers) {
+        if (header.first.size() == name.size() &&
+            std::equal(header.first.begin(), header.first.end(), name.begin(),
+                       [](unsigned char a, unsigned char b) {
+                           return std::tolower(a) == std::tolower(b);
+                       })) {
+            return header.second;
+        }
+    }
+    return {};
+}
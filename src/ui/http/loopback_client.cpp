@@ -0,0 +1,65 @@
+#include "ui/http/loopback_client.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
+int connect_loopback(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    timeval timeout{10, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int loopback_get(int port, const std::string& path) {
+    const int fd = connect_loopback(port);
+    if (fd < 0) {
+        return 0;
+    }
+    const std::string request = "GET " + path +
+                                " HTTP/1.1\r\nHost: 127.0.0.1\r\nUser-Agent: beaver-loopback\r\n"
+                                "Connection: close\r\n\r\n";
+    bool ok = send(fd, request.data(), request.size(), MSG_NOSIGNAL) ==
+              static_cast<ssize_t>(request.size());
+    char head[16] = {};
+    std::size_t head_length = 0;
+    char buffer[16384];
+    while (ok) {
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0) {
+            ok = false;
+        }
+        if (received <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < received && head_length < sizeof(head) - 1; ++i) {
+            head[head_length++] = buffer[i];
+        }
+    }
+    close(fd);
+    // "HTTP/1.1 200 ..."
+    if (!ok || head_length < 12) {
+        return 0;
+    }
+    return std::atoi(head + 9);
+}
@@ -0,0 +1,455 @@
+#include "ui/http/self_bench.h"
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "core/hdr_histogram.h"
+#include "core/json_writer.h"
+#include "core/log.h"
+#include "core/system_status.h"
+#include "core/translation_catalog.h"
+#include "ui/html_renderer.h"
+#include "ui/http/http_server.h"
+#include "ui/http/http_utils.h"
+#include "ui/http/loopback_client.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Results are folded in here so the compiler cannot drop the measured calls.
+volatile std::size_t g_sink = 0;
+
+struct CpuInfo {
+    std::string model;
+    std::string architecture;
+    std::string kernel;
+    unsigned cores = 0;
+    double current_mhz = 0.0;
+    double max_mhz = 0.0;
+};
+
+// One round of a subsystem's workload; returns a size for g_sink.
+struct Subsystem {
+    const char* name;
+    const char* workload;
+    // ns per round on the reference machine, which scores 1000: a shared
+    // one-core 2.0 GHz Xeon VM, GCC -O2, median of nine runs. The overall
+    // score there still varies by about 10% from run to run.
+    double reference_ns;
+    std::function<std::size_t()> round;
+};
+
+struct SubsystemResult {
+    std::string name;
+    std::string workload;
+    std::uint64_t rounds = 0;
+    double ns_per_round = 0.0;
+    double score = 0.0;
+};
+
+struct LoopbackResult {
+    std::uint64_t requests = 0;
+    std::uint64_t failures = 0;
+    double requests_per_second = 0.0;
+    std::uint64_t p50_us = 0;
+    std::uint64_t p99_us = 0;
+    double score = 0.0;
+};
+
+// Median loopback GET latency on the reference machine.
+constexpr double kReferenceLoopbackUs = 95.0;
+
+std::string read_first_line(const char* path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+CpuInfo read_cpu_info() {
+    CpuInfo cpu;
+    cpu.cores = std::thread::hardware_concurrency();
+    utsname names{};
+    if (uname(&names) == 0) {
+        cpu.architecture = names.machine;
+        cpu.kernel = names.release;
+    }
+
+    // x86 and most ARM kernels have "model name"; Raspberry Pi kernels put the
+    // board in "Model" and older ARM kernels the SoC in "Hardware".
+    std::string model_name;
+    std::string board;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        const std::size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, colon);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        if (model_name.empty() && (key == "model name" || key == "Processor")) {
+            model_name = value;
+        } else if (board.empty() && (key == "Model" || key == "Hardware")) {
+            board = value;
+        } else if (cpu.current_mhz == 0.0 && key == "cpu MHz") {
+            cpu.current_mhz = std::atof(value.c_str());
+        }
+    }
+    cpu.model = model_name.empty() ? board : board.empty() ? model_name
+                                                           : model_name + " (" + board + ")";
+    if (cpu.model.empty()) {
+        cpu.model = "unknown";
+    }
+
+    // cpufreq reports kHz; without it (VMs) "cpu MHz" is all there is.
+    if (const std::string current =
+            read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq");
+        !current.empty()) {
+        cpu.current_mhz = std::atof(current.c_str()) / 1000.0;
+    }
+    if (const std::string max =
+            read_first_line("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+        !max.empty()) {
+        cpu.max_mhz = std::atof(max.c_str()) / 1000.0;
+    }
+    return cpu;
+}
+
+// A fixed snapshot, so the dashboard and serializer do the same work on every
+// kiosk whatever its processes, sockets and battery.
+SystemStatusSnapshot make_status_fixture() {
+    SystemStatusSnapshot status;
+    status.generated_at_iso = "2026-10-18 09:41:07";
+    status.wifi.available = true;
+    status.wifi.connected = true;
+    status.wifi.interface_name = "wlan0";
+    status.wifi.status_text = "Connecté à \"Beaver-Bureau\"";
+    status.websocket.listening = true;
+    status.websocket.address = "ws://127.0.0.1:5001";
+    status.websocket.reachable = true;
+    status.websocket.connect_ms = 0.412;
+    status.websocket.round_trip_ms = 0.233;
+    status.battery.present = true;
+    status.battery.percentage = 87;
+    status.battery.state = "Discharging";
+    status.debian.uptime_seconds = 1234567.89;
+    status.debian.uptime_human = "14d 06h 56m 07s";
+    status.debian.load_average[0] = 0.42;
+    status.debian.load_average[1] = 0.37;
+    status.debian.load_average[2] = 0.29;
+    for (std::uint16_t port = 5000; port < 5016; ++port) {
+        status.network.listening_ports.push_back(port);
+        ListeningSocket socket;
+        socket.port = port;
+        socket.pid = 1000 + port;
+        socket.command = port % 2 == 0 ? "beaver_kiosk" : "python3 server.py";
+        status.network.listening_sockets.push_back(socket);
+    }
+    return status;
+}
+
+std::vector<Subsystem> make_subsystems(const AppManager& manager,
+                                       const TranslationCatalog& translations,
+                                       const SystemStatusSnapshot& status,
+                                       const std::string& locales) {
+    static const std::string kGetRequest =
+        "GET /apps/beaversystem?lang=fr&mode=kiosk HTTP/1.1\r\n"
+        "Host: 127.0.0.1:5000\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/605.1.15\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Language: fr-CA,fr;q=0.9,en;q=0.8\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+    static const std::string kPostRequest =
+        "POST /api/beaverphone/dial HTTP/1.1\r\n"
+        "Host: 127.0.0.1:5000\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: 35\r\n"
+        "\r\n"
+        "{\"number\":\"+1 819 555 0147\",\"ext\":\"\"}";
+    static const std::string kQuery = "lang=fr&mode=kiosk&q=caf%C3%A9+cr%C3%A8me&page=2&sort=";
+
+    std::vector<Subsystem> subsystems;
+    subsystems.push_back(
+        {"render", "menu, BeaverPhone, BeaverAlarm, BeaverSystem, BeaverTask pages, en + fr",
+         520'000.0, [&manager, &translations, &status] {
+             std::size_t size = 0;
+             for (const Language language : {Language::English, Language::French}) {
+                 size += generate_menu_page_html(manager.get_available_apps(), translations,
+                                                 language, MenuRouteMode::kHttpServer, "/")
+                             .size();
+                 size += generate_beaverphone_dialpad_html(translations, language, "/").size();
+                 size += generate_beaveralarm_console_html(translations, language, "/").size();
+                 size += generate_beaversystem_dashboard_html(
+                             translations, language, "/",
+                             BeaverSystemMenuLinkMode::kAbsoluteRoot, status)
+                             .size();
+                 size += generate_beavertask_board_html(translations, language, "/").size();
+             }
+             return size;
+         }});
+    subsystems.push_back({"status_json", "status snapshot and menu to JSON, pretty + compact",
+                          22'000.0, [&manager, &status] {
+                              return system_status_to_json(status).size() +
+                                     system_status_to_json(status, JsonStyle::kCompact).size() +
+                                     manager.to_json(Language::English).size() +
+                                     manager.to_json(Language::French).size();
+                          }});
+    subsystems.push_back({"http_parse", "GET and POST requests, query string", 8'600.0, [] {
+                              return parse_http_request(kGetRequest).headers.size() +
+                                     parse_http_request(kPostRequest).body.size() +
+                                     parse_query_parameters(kQuery).size();
+                          }});
+    subsystems.push_back({"i18n_load", "load en + fr catalogs, 100 lookups", 86'000.0,
+                          [&locales] {
+                              const TranslationCatalog catalog(locales);
+                              std::size_t size = 0;
+                              for (int i = 0; i < 50; ++i) {
+                                  size += catalog.translate("Language selection",
+                                                            Language::French).size();
+                                  size += catalog.translate("No such label",
+                                                            Language::English).size();
+                              }
+                              return size;
+                          }});
+    return subsystems;
+}
+
+double run_rounds(const Subsystem& subsystem, std::uint64_t count) {
+    std::size_t sink = 0;
+    const auto start = Clock::now();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        sink += subsystem.round();
+    }
+    const auto end = Clock::now();
+    g_sink = g_sink + sink;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Batches of about 5 ms until the time is spent; the median batch keeps a
+// background task on a shared kiosk from skewing the score.
+SubsystemResult measure(const Subsystem& subsystem, std::chrono::milliseconds budget) {
+    constexpr double kTargetBatchNs = 5'000'000.0;
+    std::uint64_t batch = 1;
+    while (batch < (1u << 20) && run_rounds(subsystem, batch) < kTargetBatchNs) {
+        batch *= 2;
+    }
+
+    std::vector<double> per_round;
+    double total_ns = 0.0;
+    const double budget_ns = std::chrono::duration<double, std::nano>(budget).count();
+    while (total_ns < budget_ns || per_round.size() < 5) {
+        const double elapsed = run_rounds(subsystem, batch);
+        total_ns += elapsed;
+        per_round.push_back(elapsed / static_cast<double>(batch));
+    }
+    std::sort(per_round.begin(), per_round.end());
+
+    SubsystemResult result;
+    result.name = subsystem.name;
+    result.workload = subsystem.workload;
+    result.rounds = batch * per_round.size();
+    result.ns_per_round = per_round[per_round.size() / 2];
+    result.score = 1000.0 * subsystem.reference_ns / result.ns_per_round;
+    return result;
+}
+
+// Sequential GETs over fresh connections for `budget`; static pages, the menu
+// API and a stylesheet, but not the BeaverSystem routes, whose cost depends on
+// the kiosk's processes.
+bool run_loopback(AppManager& manager, int port, std::chrono::milliseconds budget,
+                  LoopbackResult& result) {
+    static const char* const kPaths[] = {"/", "/apps/beaverphone?lang=en", "/apps/beavertask",
+                                         "/api/menu?lang=en", "/css/styles.css"};
+
+    HttpServerApp server(manager, port);
+    std::atomic<bool> server_finished{false};
+    std::thread server_thread([&server, &server_finished] {
+        server.run();
+        server_finished.store(true);
+    });
+    const auto ready_deadline = Clock::now() + std::chrono::seconds(5);
+    int fd = -1;
+    while ((fd = connect_loopback(port)) < 0 && !server_finished.load() &&
+           Clock::now() < ready_deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    if (fd < 0) {
+        std::cerr << "Self-bench: the HTTP server did not start on port " << port << std::endl;
+        server.stop();
+        server_thread.join();
+        return false;
+    }
+    close(fd);
+
+    // Warm-up, then the measured run.
+    for (const char* path : kPaths) {
+        loopback_get(port, path);
+    }
+    HdrHistogram latency;
+    const auto start = Clock::now();
+    const auto end = start + budget;
+    for (std::uint64_t i = 0; Clock::now() < end; ++i) {
+        const auto sent = Clock::now();
+        const int status = loopback_get(port, kPaths[i % std::size(kPaths)]);
+        const auto received = Clock::now();
+        ++result.requests;
+        if (status != 200) {
+            ++result.failures;
+            continue;
+        }
+        latency.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(received - sent).count()));
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    server.stop();
+    server_thread.join();
+
+    result.requests_per_second = static_cast<double>(result.requests) / elapsed;
+    result.p50_us = latency.value_at_percentile(50);
+    result.p99_us = latency.value_at_percentile(99);
+    result.score = result.p50_us > 0
+                       ? 1000.0 * kReferenceLoopbackUs / static_cast<double>(result.p50_us)
+                       : 0.0;
+    return result.failures == 0;
+}
+
+std::string host_name() {
+    char name[256] = {};
+    return gethostname(name, sizeof(name) - 1) == 0 ? name : "";
+}
+
+bool write_report(const std::string& path, const CpuInfo& cpu,
+                  const std::vector<SubsystemResult>& results, const LoopbackResult& loopback,
+                  double overall) {
+    std::string out;
+    JsonWriter json(out);
+    json.begin_object();
+    json.key("host").string(host_name());
+    json.key("cpu").begin_object();
+    json.key("model").string(cpu.model);
+    json.key("architecture").string(cpu.architecture);
+    json.key("kernel").string(cpu.kernel);
+    json.key("cores").number(static_cast<unsigned long long>(cpu.cores));
+    json.key("currentMhz").number(cpu.current_mhz, 0);
+    json.key("maxMhz").number(cpu.max_mhz, 0);
+    json.end_object();
+    json.key("score").number(overall, 0);
+    json.key("subsystems").begin_array();
+    for (const SubsystemResult& result : results) {
+        json.begin_object();
+        json.key("name").string(result.name);
+        json.key("workload").string(result.workload);
+        json.key("rounds").number(static_cast<unsigned long long>(result.rounds));
+        json.key("nsPerRound").number(result.ns_per_round, 0);
+        json.key("score").number(result.score, 0);
+        json.end_object();
+    }
+    json.begin_object();
+    json.key("name").string("http_loopback");
+    json.key("requests").number(static_cast<unsigned long long>(loopback.requests));
+    json.key("failedRequests").number(static_cast<unsigned long long>(loopback.failures));
+    json.key("requestsPerSecond").number(loopback.requests_per_second, 0);
+    json.key("p50Us").number(static_cast<unsigned long long>(loopback.p50_us));
+    json.key("p99Us").number(static_cast<unsigned long long>(loopback.p99_us));
+    json.key("score").number(loopback.score, 0);
+    json.end_object();
+    json.end_array();
+    json.end_object();
+    json.finish();
+
+    std::error_code error;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, error);
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << out;
+    return static_cast<bool>(file);
+}
+
+}  // namespace
+
+SelfBenchConfig self_bench_config_from_environment() {
+    SelfBenchConfig config;
+    if (const char* ms = std::getenv("BEAVER_SELF_BENCH_MS"); ms && *ms) {
+        config.time_per_subsystem = std::chrono::milliseconds(std::max(50, std::atoi(ms)));
+    }
+    if (const char* report = std::getenv("BEAVER_SELF_BENCH_REPORT"); report && *report) {
+        config.report_path = report;
+    }
+    return config;
+}
+
+int run_self_bench(AppManager& manager, const SelfBenchConfig& config) {
+    const CpuInfo cpu = read_cpu_info();
+    std::cout << "CPU:    " << cpu.model << " (" << cpu.architecture << ", " << cpu.cores
+              << (cpu.cores == 1 ? " core)" : " cores)") << std::endl;
+    std::cout << "Clock:  " << std::fixed << std::setprecision(0) << cpu.current_mhz << " MHz";
+    if (cpu.max_mhz > 0.0) {
+        std::cout << " (max " << cpu.max_mhz << " MHz)";
+    }
+    std::cout << std::endl << "Kernel: " << cpu.kernel << std::endl << std::endl;
+
+    const std::string locales = "locales";
+    const TranslationCatalog translations(locales);
+    const SystemStatusSnapshot status = make_status_fixture();
+
+    // First, so the server's banner does not land in the middle of the table.
+    LoopbackResult loopback;
+    const bool loopback_ok = run_loopback(manager, config.port, config.time_per_subsystem * 2,
+                                          loopback);
+
+    std::cout << std::left << std::setw(16) << "subsystem" << std::right << std::setw(14)
+              << "us/round" << std::setw(10) << "rounds" << std::setw(8) << "score"
+              << "  workload" << std::endl;
+    std::vector<SubsystemResult> results;
+    // i18n_load builds thousands of catalogs, each of which logs a message.
+    set_log_messages_muted(true);
+    for (const Subsystem& subsystem : make_subsystems(manager, translations, status, locales)) {
+        results.push_back(measure(subsystem, config.time_per_subsystem));
+        const SubsystemResult& result = results.back();
+        std::cout << std::left << std::setw(16) << result.name << std::right << std::setw(14)
+                  << std::setprecision(1) << result.ns_per_round / 1000.0 << std::setw(10)
+                  << result.rounds << std::setw(8) << std::setprecision(0) << result.score
+                  << "  " << result.workload << std::endl;
+    }
+    set_log_messages_muted(false);
+
+    std::cout << std::left << std::setw(16) << "http_loopback" << std::right << std::setw(14)
+              << std::setprecision(1) << static_cast<double>(loopback.p50_us) << std::setw(10)
+              << loopback.requests << std::setw(8) << std::setprecision(0) << loopback.score
+              << "  " << loopback.requests_per_second << " req/s, p99 " << loopback.p99_us
+              << " us, " << loopback.failures << " failed" << std::endl;
+
+    // Geometric mean, so no single subsystem dominates the overall score.
+    double log_sum = std::log(std::max(loopback.score, 1.0));
+    for (const SubsystemResult& result : results) {
+        log_sum += std::log(std::max(result.score, 1.0));
+    }
+    const double overall = std::exp(log_sum / static_cast<double>(results.size() + 1));
+    std::cout << std::endl << "Score: " << overall << " (reference machine: 1000)" << std::endl;
+
+    if (write_report(config.report_path, cpu, results, loopback, overall)) {
+        std::cout << "Report written to " << config.report_path << std::endl;
+    } else {
+        std::cerr << "Could not write " << config.report_path << std::endl;
+    }
+    return loopback_ok ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+#include "ui/http/soak_runner.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "core/json_writer.h"
+#include "ui/http/http_server.h"
+#include "ui/http/loopback_client.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Every kind of route the server answers, in both languages where it matters.
+const std::vector<std::string>& soak_paths() {
+    static const std::vector<std::string> paths = {
+        "/",
+        "/?lang=en",
+        "/apps/beaverphone",
+        "/apps/beaversystem?lang=en",
+        "/apps/beaveralarm",
+        "/apps/beavertask?lang=en",
+        "/api/menu",
+        "/api/menu?lang=en",
+        "/api/system/status",
+        "/css/styles.css",
+        "/icons/phone.svg",
+        "/contact/SPCA.svg",
+        "/metrics",
+        "/does-not-exist",
+    };
+    return paths;
+}
+
+// What the GTK shell does as the user moves around: on_load_changed() matches
+// each loaded URI and records the navigation, load_app_page() renders the app
+// pages, and load_language() re-renders the menu and clears the history.
+// Clearing is rare here so the history cap is exercised too.
+void navigate(AppManager& manager, std::uint64_t step) {
+    const std::vector<AppTile>& apps = manager.get_available_apps();
+    const AppTile& app = apps[step % apps.size()];
+    const std::string uri = app.routes.kiosk.remote ? app.routes.kiosk.uri + "news/" +
+                                                          std::to_string(step % 17)
+                                                    : "file:///" + app.routes.kiosk.uri;
+    const auto match = manager.match_route_for_uri(uri, MenuRouteMode::kKiosk);
+    // Local pages never match a remote route; record them anyway so the
+    // history sees a steady stream of distinct entries.
+    manager.record_navigation(match && match->app != nullptr ? match->app->name : app.name,
+                              MenuRouteMode::kKiosk);
+
+    const Language language = step % 2 == 0 ? Language::French : Language::English;
+    const std::vector<AppPageRoute>& pages = app_page_routes();
+    manager.page_html(pages[step % pages.size()].page, language, MenuRouteMode::kKiosk);
+    if (step % 1000 == 999) {
+        manager.to_html(language, MenuRouteMode::kKiosk);
+        manager.clear_navigation_history();
+    }
+}
+
+std::string format_duration(double seconds) {
+    const auto total = static_cast<long long>(seconds);
+    char text[32];
+    std::snprintf(text, sizeof(text), "%lldh%02lldm%02llds", total / 3600, total / 60 % 60,
+                  total % 60);
+    return text;
+}
+
+bool write_report(const std::string& path, const SoakConfig& config,
+                  const std::vector<ResourceSample>& samples,
+                  const std::vector<ResourceTrend>& trends, std::uint64_t requests,
+                  std::uint64_t failures, bool passed) {
+    std::string out;
+    JsonWriter json(out);
+    json.begin_object();
+    json.key("passed").boolean(passed);
+    json.key("durationSeconds").number(samples.empty() ? 0.0 : samples.back().elapsed_seconds, 1);
+    json.key("requestRate").number(config.request_rate, 1);
+    json.key("requests").number(static_cast<unsigned long long>(requests));
+    json.key("failedRequests").number(static_cast<unsigned long long>(failures));
+    json.key("trends").begin_array();
+    for (const ResourceTrend& trend : trends) {
+        json.begin_object();
+        json.key("resource").string(trend.name);
+        json.key("unit").string(trend.unit);
+        json.key("start").number(trend.start, 1);
+        json.key("end").number(trend.end, 1);
+        json.key("growth").number(trend.growth, 1);
+        json.key("perRequest").number(trend.per_request, 6);
+        json.key("monotonic").boolean(trend.monotonic);
+        json.key("budget").number(trend.budget, 1);
+        json.key("overBudget").boolean(trend.over_budget);
+        json.end_object();
+    }
+    json.end_array();
+    json.key("samples").begin_array();
+    for (const ResourceSample& sample : samples) {
+        json.begin_object();
+        json.key("elapsedSeconds").number(sample.elapsed_seconds, 1);
+        json.key("requests").number(static_cast<unsigned long long>(sample.requests));
+        json.key("rssKb").number(static_cast<unsigned long long>(sample.rss_kb));
+        json.key("heapBytes").number(static_cast<unsigned long long>(sample.heap_in_use_bytes));
+        json.key("openFds").number(static_cast<unsigned long long>(sample.open_fds));
+        json.key("threads").number(static_cast<unsigned long long>(sample.threads));
+        json.end_object();
+    }
+    json.end_array();
+    json.end_object();
+    json.finish();
+
+    std::error_code error;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, error);
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << out;
+    return static_cast<bool>(file);
+}
+
+}  // namespace
+
+SoakConfig soak_config_from_environment() {
+    SoakConfig config;
+    config.budgets = resource_budgets_from_environment();
+    if (const char* rate = std::getenv("BEAVER_SOAK_RATE"); rate && *rate) {
+        config.request_rate = std::max(0.0, std::strtod(rate, nullptr));
+    }
+    if (const char* report = std::getenv("BEAVER_SOAK_REPORT"); report && *report) {
+        config.report_path = report;
+    }
+    return config;
+}
+
+bool parse_soak_duration(std::string_view text, std::chrono::seconds& duration) {
+    if (text.empty()) {
+        return false;
+    }
+    long long multiplier = 1;
+    switch (text.back()) {
+        case 's':
+            text.remove_suffix(1);
+            break;
+        case 'm':
+            multiplier = 60;
+            text.remove_suffix(1);
+            break;
+        case 'h':
+            multiplier = 3600;
+            text.remove_suffix(1);
+            break;
+        default:
+            break;
+    }
+    const std::string digits(text);
+    char* end = nullptr;
+    const long long value = std::strtoll(digits.c_str(), &end, 10);
+    if (digits.empty() || *end != '\0' || value <= 0) {
+        return false;
+    }
+    duration = std::chrono::seconds(value * multiplier);
+    return true;
+}
+
+int run_soak(AppManager& manager, const SoakConfig& config) {
+    HttpServerApp server(manager, config.port);
+    std::atomic<bool> server_finished{false};
+    std::thread server_thread([&server, &server_finished] {
+        server.run();
+        server_finished.store(true);
+    });
+
+    // Wait for the listening socket.
+    const auto ready_deadline = Clock::now() + std::chrono::seconds(5);
+    for (;;) {
+        const int fd = connect_loopback(config.port);
+        if (fd >= 0) {
+            close(fd);
+            break;
+        }
+        if (server_finished.load() || Clock::now() > ready_deadline) {
+            std::cerr << "Soak: the HTTP server did not start on port " << config.port
+                      << std::endl;
+            server.stop();
+            server_thread.join();
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    const auto sample_interval =
+        config.sample_interval.count() > 0
+            ? std::chrono::duration_cast<Clock::duration>(config.sample_interval)
+            : std::max<Clock::duration>(std::chrono::seconds(1), config.duration / 60);
+    const auto request_interval =
+        config.request_rate > 0.0 ? std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(1.0 / config.request_rate))
+                                  : Clock::duration::zero();
+    std::cout << "Soak: " << format_duration(static_cast<double>(config.duration.count()))
+              << " against port " << config.port << ", "
+              << (config.request_rate > 0.0 ? std::to_string(config.request_rate) + " req/s"
+                                            : std::string("back-to-back requests"))
+              << ", sampling every "
+              << std::chrono::duration<double>(sample_interval).count() << " s" << std::endl;
+
+    const auto start = Clock::now();
+    const auto end = start + config.duration;
+    auto next_request = start;
+    auto next_sample = start;
+    std::uint64_t requests = 0;
+    std::uint64_t failures = 0;
+    std::vector<ResourceSample> samples;
+    const auto take_sample = [&] {
+        ResourceSample sample = sample_process_resources();
+        sample.elapsed_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        sample.requests = requests;
+        samples.push_back(sample);
+        std::cout << "Soak " << format_duration(sample.elapsed_seconds) << ": " << requests
+                  << " requests (" << failures << " failed), rss " << sample.rss_kb
+                  << " KiB, heap " << sample.heap_in_use_bytes / 1024 << " KiB, fds "
+                  << sample.open_fds << ", threads " << sample.threads << ", history "
+                  << manager.navigation_history_size() << std::endl;
+    };
+
+    while (!server_finished.load()) {
+        const auto now = Clock::now();
+        if (now >= next_sample) {
+            take_sample();
+            next_sample += sample_interval;
+        }
+        if (now >= end) {
+            break;
+        }
+        if (request_interval > Clock::duration::zero()) {
+            std::this_thread::sleep_until(std::min(next_request, next_sample));
+            if (Clock::now() < next_request) {
+                continue;
+            }
+            next_request += request_interval;
+        }
+        const std::vector<std::string>& paths = soak_paths();
+        if (const int status = loopback_get(config.port, paths[requests % paths.size()]);
+            status == 0 || status >= 500) {
+            ++failures;
+        }
+        navigate(manager, requests);
+        ++requests;
+    }
+
+    server.stop();
+    server_thread.join();
+
+    const std::vector<ResourceTrend> trends = analyze_resource_growth(samples, config.budgets);
+    bool passed = failures == 0;
+    std::cout << std::endl
+              << std::left << std::setw(10) << "resource" << std::right << std::setw(14)
+              << "start" << std::setw(14) << "end" << std::setw(12) << "growth"
+              << std::setw(14) << "per request" << std::setw(11) << "budget"
+              << "  result" << std::endl;
+    for (const ResourceTrend& trend : trends) {
+        passed = passed && !trend.over_budget;
+        std::cout << std::left << std::setw(10) << trend.name << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(10) << trend.start << std::setw(4)
+                  << trend.unit << std::setw(10) << trend.end << std::setw(4) << trend.unit
+                  << std::setw(12) << trend.growth << std::setprecision(4) << std::setw(14)
+                  << trend.per_request << std::setprecision(0) << std::setw(11)
+                  << trend.budget << "  "
+                  << (trend.over_budget ? "OVER BUDGET" : (trend.monotonic ? "growing" : "ok"))
+                  << std::endl;
+    }
+    std::cout << requests << " requests, " << failures << " failed; navigation history "
+              << manager.navigation_history_size() << " records" << std::endl;
+
+    if (write_report(config.report_path, config, samples, trends, requests, failures, passed)) {
+        std::cout << "Soak report written to " << config.report_path << std::endl;
+    } else {
+        std::cerr << "Could not write " << config.report_path << std::endl;
+    }
+    std::cout << (passed ? "Soak passed" : "Soak FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+#include "ui/http/sse_broadcaster.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view kStreamHeaders =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream; charset=utf-8\r\n"
+    "Cache-Control: no-cache, no-store, must-revalidate\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "X-Accel-Buffering: no\r\n"
+    "\r\n"
+    "retry: 5000\n\n";
+
+// How long to wait for a slow subscriber's socket to drain before checking again.
+constexpr std::chrono::milliseconds kFlushRetryInterval{100};
+
+const std::shared_ptr<const std::string>& heartbeat_frame() {
+    static const auto frame = std::make_shared<const std::string>(": heartbeat\n\n");
+    return frame;
+}
+
+}  // namespace
+
+SseBroadcaster::SseBroadcaster(StatusSampler& sampler, std::chrono::seconds heartbeat_interval,
+                               std::size_t max_subscribers)
+    : sampler_(sampler),
+      heartbeat_interval_(heartbeat_interval),
+      max_subscribers_(max_subscribers),
+      subscriber_gauge_(metrics().gauge("beaver_active_connections",
+                                        "Open client connections by kind.", {{"kind", "sse"}})),
+      frame_cache_("sse_frames") {}
+
+SseBroadcaster::~SseBroadcaster() {
+    stop();
+}
+
+void SseBroadcaster::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&SseBroadcaster::run, this);
+}
+
+void SseBroadcaster::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& subscriber : subscribers_) {
+        close(subscriber.socket);
+    }
+    subscribers_.clear();
+    subscriber_gauge_.set(0);
+}
+
+bool SseBroadcaster::add_subscriber(int client_socket, std::uint64_t since) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_ || subscribers_.size() >= max_subscribers_) {
+        return false;
+    }
+
+    const StatusUpdate update = sampler_.update_since(since);
+    std::string initial(kStreamHeaders);
+    if (update.kind != StatusUpdateKind::kUnchanged) {
+        initial += *build_event_frame(update.version, update.payload);
+    }
+
+    Subscriber subscriber;
+    subscriber.socket = client_socket;
+    subscriber.pending = std::make_shared<const std::string>(std::move(initial));
+    subscriber.pending_version = update.version;
+    subscriber.version = since;
+    if (flush(subscriber)) {
+        subscribers_.push_back(std::move(subscriber));
+        subscriber_gauge_.set(static_cast<std::int64_t>(subscribers_.size()));
+    } else {
+        close(client_socket);
+    }
+    return true;
+}
+
+std::size_t SseBroadcaster::subscriber_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.size();
+}
+
+void SseBroadcaster::run() {
+    auto next_heartbeat = std::chrono::steady_clock::now() + heartbeat_interval_;
+    for (;;) {
+        bool has_pending = false;
+        std::uint64_t version = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+            version = latest_version_;
+            has_pending = std::any_of(subscribers_.begin(), subscribers_.end(),
+                                      [](const Subscriber& s) { return s.pending != nullptr; });
+        }
+
+        // The sampler wakes us on a new version. Otherwise wake for the next
+        // heartbeat (checking for stop() at least once a second), or sooner when
+        // a slow subscriber still has bytes queued.
+        const auto now = std::chrono::steady_clock::now();
+        auto deadline = std::min(next_heartbeat, now + std::chrono::seconds(1));
+        if (has_pending) {
+            deadline = std::min(deadline, now + kFlushRetryInterval);
+        }
+        const auto status = sampler_.wait_for_newer(version, deadline);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        bool heartbeat_due = false;
+        if (status && status->version > latest_version_) {
+            latest_version_ = status->version;
+            latest_delta_frame_ = status->delta_update.empty()
+                                      ? nullptr
+                                      : build_event_frame(status->version, status->delta_update);
+            catch_up_frames_.clear();
+            next_heartbeat = std::chrono::steady_clock::now() + heartbeat_interval_;
+        } else if (std::chrono::steady_clock::now() >= next_heartbeat) {
+            heartbeat_due = true;
+            next_heartbeat = std::chrono::steady_clock::now() + heartbeat_interval_;
+        }
+
+        for (auto& subscriber : subscribers_) {
+            if (!queue_latest(subscriber) && !subscriber.pending && heartbeat_due) {
+                subscriber.pending = heartbeat_frame();
+            }
+            bool healthy = !subscriber.pending || flush(subscriber);
+            if (healthy && !subscriber.pending && queue_latest(subscriber)) {
+                // Finished a partially written frame; catch up right away.
+                healthy = flush(subscriber);
+            }
+            if (!healthy) {
+                close(subscriber.socket);
+                subscriber.socket = -1;
+            }
+        }
+        drop_closed_subscribers();
+    }
+}
+
+std::shared_ptr<const std::string> SseBroadcaster::frame_since(std::uint64_t version) {
+    if (latest_delta_frame_ && version + 1 == latest_version_) {
+        frame_cache_.record(true);
+        return latest_delta_frame_;
+    }
+    auto& frame = catch_up_frames_[version];
+    frame_cache_.record(frame != nullptr);
+    if (!frame) {
+        const StatusUpdate update = sampler_.update_since(version);
+        frame = build_event_frame(update.version, update.payload);
+    }
+    return frame;
+}
+
+// Replaces a not-yet-started frame with the update from the version the client
+// actually holds. A partially written frame is completed first.
+bool SseBroadcaster::queue_latest(Subscriber& subscriber) {
+    if (subscriber.offset != 0 || subscriber.version >= latest_version_ ||
+        subscriber.pending_version == latest_version_) {
+        return false;
+    }
+    subscriber.pending = frame_since(subscriber.version);
+    subscriber.pending_version = latest_version_;
+    return true;
+}
+
+std::shared_ptr<const std::string> SseBroadcaster::build_event_frame(
+    std::uint64_t version, std::string_view payload) const {
+    std::string frame;
+    frame.reserve(payload.size() + payload.size() / 8 + 64);
+    frame += "id: ";
+    frame += sampler_.version_token(version);
+    frame += "\nevent: status\n";
+    while (!payload.empty()) {
+        const std::size_t line_end = payload.find('\n');
+        frame += "data: ";
+        frame += payload.substr(0, line_end);
+        frame += '\n';
+        if (line_end == std::string_view::npos) {
+            break;
+        }
+        payload.remove_prefix(line_end + 1);
+    }
+    frame += '\n';
+    return std::make_shared<const std::string>(std::move(frame));
+}
+
+bool SseBroadcaster::flush(Subscriber& subscriber) {
+    const std::string& data = *subscriber.pending;
+    while (subscriber.offset < data.size()) {
+        const ssize_t written = send(subscriber.socket, data.data() + subscriber.offset,
+                                     data.size() - subscriber.offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written > 0) {
+            subscriber.offset += static_cast<std::size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        return written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    if (subscriber.pending_version != 0) {
+        subscriber.version = subscriber.pending_version;
+    }
+    subscriber.pending.reset();
+    subscriber.pending_version = 0;
+    subscriber.offset = 0;
+    return true;
+}
+
+void SseBroadcaster::drop_closed_subscribers() {
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [](const Subscriber& s) { return s.socket < 0; }),
+                       subscribers_.end());
+    subscriber_gauge_.set(static_cast<std::int64_t>(subscribers_.size()));
+}
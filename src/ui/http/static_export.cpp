@@ -0,0 +1,274 @@
+#include "ui/http/static_export.h"
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/content_hash.h"
+#include "core/json_writer.h"
+#include "core/resource_bundle.h"
+#include "ui/http/http_utils.h"
+
+extern char** environ;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr const char* kHtml = "text/html; charset=utf-8";
+constexpr const char* kJson = "application/json; charset=utf-8";
+
+struct ExportedFile {
+    std::string file;  // Relative to the export directory.
+    std::string route;
+    const char* language = nullptr;
+    std::string content_type;
+    std::string hash;
+    std::size_t bytes = 0;
+    std::size_t gzip_bytes = 0;
+};
+
+struct AssetName {
+    std::string plain;  // "css/styles.css"
+    std::string fingerprinted;
+};
+
+struct ExportState {
+    fs::path root;
+    std::vector<ExportedFile> files;
+    std::vector<AssetName> assets;
+    bool gzip_available = true;
+    bool failed = false;
+};
+
+// Pages that render a snapshot of the machine's status stay with the server.
+bool is_live_page(AppPage page) {
+    return page == AppPage::kBeaverSystem;
+}
+
+const char* language_code(Language language) {
+    return language == Language::French ? "fr" : "en";
+}
+
+bool write_file(ExportState& state, const std::string& relative_path, std::string_view data) {
+    const fs::path path = state.root / relative_path;
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        std::cerr << "Export: could not write " << path.string() << std::endl;
+        state.failed = true;
+        return false;
+    }
+    return true;
+}
+
+// Runs `gzip -9 -n -k` on the file and keeps the copy only when it is smaller.
+// Returns its size, or 0 without a copy.
+std::size_t gzip_file(ExportState& state, const std::string& relative_path, std::size_t bytes) {
+    if (!state.gzip_available) {
+        return 0;
+    }
+    const std::string path = (state.root / relative_path).string();
+    const std::string gzip_path = path + ".gz";
+    char* argv[] = {const_cast<char*>("gzip"), const_cast<char*>("-9"),
+                    const_cast<char*>("-n"),   const_cast<char*>("-k"),
+                    const_cast<char*>("-f"),   const_cast<char*>(path.c_str()), nullptr};
+    pid_t pid = 0;
+    int status = 0;
+    if (posix_spawnp(&pid, "gzip", nullptr, nullptr, argv, environ) != 0) {
+        std::cerr << "Export: gzip not found; writing no precompressed copies" << std::endl;
+        state.gzip_available = false;
+        return 0;
+    }
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    std::error_code error;
+    const std::uintmax_t gzip_bytes = fs::file_size(gzip_path, error);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || error || gzip_bytes >= bytes) {
+        fs::remove(gzip_path, error);
+        return 0;
+    }
+    return static_cast<std::size_t>(gzip_bytes);
+}
+
+void export_file(ExportState& state, ExportedFile file, std::string_view data) {
+    if (!write_file(state, file.file, data)) {
+        return;
+    }
+    file.hash = content_hash(data);
+    file.bytes = data.size();
+    file.gzip_bytes = gzip_file(state, file.file, data.size());
+    state.files.push_back(std::move(file));
+}
+
+// Points every quoted reference to a public/ file, as the renderer writes it
+// ("/css/styles.css" in pages, "css/styles.css" in the menu JSON), at its
+// fingerprinted name.
+void rewrite_asset_urls(std::string& text, const std::vector<AssetName>& assets,
+                        std::string_view prefix) {
+    for (const AssetName& asset : assets) {
+        const std::string from = "\"" + std::string(prefix) + asset.plain + "\"";
+        const std::string to = "\"" + std::string(prefix) + asset.fingerprinted + "\"";
+        for (std::size_t at = text.find(from); at != std::string::npos;
+             at = text.find(from, at + to.size())) {
+            text.replace(at, from.size(), to);
+        }
+    }
+}
+
+// "/" -> "index.html", "/apps/beaverphone" -> "apps/beaverphone.html".
+std::string page_file_name(std::string_view route) {
+    while (!route.empty() && route.front() == '/') {
+        route.remove_prefix(1);
+    }
+    if (route.empty()) {
+        return "index.html";
+    }
+    if (route.size() >= 5 && route.substr(route.size() - 5) == ".html") {
+        return std::string(route);
+    }
+    return std::string(route) + ".html";
+}
+
+void export_assets(ExportState& state) {
+    constexpr std::string_view kPublic = "public/";
+    for (const auto& resource : list_resources(kPublic)) {
+        AssetName name;
+        name.plain = std::string(resource->path.substr(kPublic.size()));
+        name.fingerprinted = fingerprinted_path(name.plain, resource->hash);
+        const std::string content_type = get_mime_type(name.plain);
+        for (const std::string* file_name : {&name.plain, &name.fingerprinted}) {
+            if (!write_file(state, *file_name, resource->data)) {
+                continue;
+            }
+            ExportedFile file;
+            file.file = *file_name;
+            file.route = "/" + *file_name;
+            file.content_type = content_type;
+            file.hash = std::string(resource->hash);
+            file.bytes = resource->data.size();
+            // The build already compressed embedded resources.
+            if (resource->gzip.empty()) {
+                file.gzip_bytes = gzip_file(state, *file_name, resource->data.size());
+            } else if (write_file(state, *file_name + ".gz", resource->gzip)) {
+                file.gzip_bytes = resource->gzip.size();
+            }
+            state.files.push_back(std::move(file));
+        }
+        state.assets.push_back(std::move(name));
+    }
+}
+
+bool write_manifest(ExportState& state, Language default_language,
+                    const std::vector<std::string>& live_routes) {
+    std::string out;
+    JsonWriter json(out);
+    json.begin_object();
+    json.key("defaultLanguage").string(language_code(default_language));
+    json.key("assets").begin_object();
+    for (const AssetName& asset : state.assets) {
+        json.key(asset.plain).string(asset.fingerprinted);
+    }
+    json.end_object();
+    json.key("files").begin_array();
+    for (const ExportedFile& file : state.files) {
+        json.begin_object();
+        json.key("file").string(file.file);
+        json.key("route").string(file.route);
+        if (file.language != nullptr) {
+            json.key("language").string(file.language);
+        }
+        json.key("contentType").string(file.content_type);
+        json.key("bytes").number(static_cast<unsigned long long>(file.bytes));
+        json.key("gzipBytes").number(static_cast<unsigned long long>(file.gzip_bytes));
+        json.key("hash").string(file.hash);
+        json.end_object();
+    }
+    json.end_array();
+    json.key("live").begin_array();
+    for (const std::string& route : live_routes) {
+        json.string(route);
+    }
+    json.end_array();
+    json.end_object();
+    json.finish();
+    return write_file(state, "manifest.json", out);
+}
+
+}  // namespace
+
+int run_static_export(const AppManager& manager, const std::string& directory) {
+    ExportState state;
+    state.root = directory;
+    export_assets(state);
+
+    std::vector<std::string> live_routes;
+    for (const AppPageRoute& route : app_page_routes()) {
+        if (is_live_page(route.page)) {
+            live_routes.emplace_back(route.path);
+        }
+    }
+
+    for (const Language language : {Language::French, Language::English}) {
+        const char* code = language_code(language);
+        const std::string base = std::string("http/") + code + "/";
+        std::vector<std::string> written;
+        for (const AppPageRoute& route : app_page_routes()) {
+            if (is_live_page(route.page)) {
+                continue;
+            }
+            ExportedFile file;
+            file.file = base + page_file_name(route.path);
+            // "/" and "/index.html" are the same page.
+            if (std::find(written.begin(), written.end(), file.file) != written.end()) {
+                continue;
+            }
+            written.push_back(file.file);
+            file.route = route.path;
+            file.language = code;
+            file.content_type = kHtml;
+            std::string html =
+                manager.page_html(route.page, language, MenuRouteMode::kHttpServer);
+            rewrite_asset_urls(html, state.assets, "/");
+            export_file(state, std::move(file), html);
+        }
+
+        ExportedFile menu;
+        menu.file = std::string("http/") + code + "/api/menu.json";
+        menu.route = "/api/menu";
+        menu.language = code;
+        menu.content_type = kJson;
+        std::string json = manager.to_json(language);
+        rewrite_asset_urls(json, state.assets, "");
+        export_file(state, std::move(menu), json);
+    }
+
+    const bool manifest_written =
+        write_manifest(state, manager.get_default_language(), live_routes);
+    if (state.failed || !manifest_written) {
+        std::cerr << "Export to " << directory << " failed" << std::endl;
+        return 1;
+    }
+
+    std::size_t bytes = 0;
+    std::size_t gzip_bytes = 0;
+    for (const ExportedFile& file : state.files) {
+        bytes += file.bytes;
+        gzip_bytes += file.gzip_bytes;
+    }
+    std::cout << "Exported " << state.files.size() << " files (" << bytes << " bytes, "
+              << gzip_bytes << " more gzipped) and manifest.json to " << directory
+              << std::endl;
+    return 0;
+}
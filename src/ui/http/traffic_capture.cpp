@@ -0,0 +1,201 @@
+#include "ui/http/traffic_capture.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr char kMagic[8] = {'B', 'V', 'R', 'C', 'A', 'P', '0', '1'};
+constexpr std::size_t kRecordHeaderSize = 8 + 4 + 4 + 2 + 2 + 4;
+constexpr std::size_t kFlushBytes = 64 * 1024;
+constexpr std::size_t kMaxPendingBytes = 16 * 1024 * 1024;
+// Far above what the server reads per request; anything larger is corruption.
+constexpr std::uint32_t kMaxRequestBytes = 1024 * 1024;
+
+template <typename Integer>
+void append_le(std::string& out, Integer value) {
+    for (std::size_t i = 0; i < sizeof(Integer); ++i) {
+        out.push_back(static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF));
+    }
+}
+
+template <typename Integer>
+Integer read_le(const char* data) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < sizeof(Integer); ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return static_cast<Integer>(value);
+}
+
+std::uint32_t clamp_u32(std::uint64_t value) {
+    return static_cast<std::uint32_t>(std::min<std::uint64_t>(value, UINT32_MAX));
+}
+
+std::uint64_t to_microseconds(std::chrono::steady_clock::duration duration) {
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(
+        0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+}
+
+bool write_all(int fd, const std::string& data) {
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        const ssize_t written = write(fd, data.data() + offset, data.size() - offset);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        offset += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+}  // namespace
+
+std::string traffic_capture_path_from_environment() {
+    const char* path = std::getenv("BEAVER_CAPTURE");
+    return path != nullptr ? path : "";
+}
+
+TrafficCapture::~TrafficCapture() {
+    stop();
+}
+
+bool TrafficCapture::start(const std::string& path) {
+    if (running()) {
+        return true;
+    }
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    std::string header(kMagic, sizeof(kMagic));
+    append_le<std::uint64_t>(header,
+                             std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count());
+    if (!write_all(fd_, header)) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    started_ = std::chrono::steady_clock::now();
+    recorded_.store(0);
+    dropped_.store(0);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(true);
+    }
+    thread_ = std::thread(&TrafficCapture::run, this);
+    return true;
+}
+
+void TrafficCapture::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load()) {
+            return;
+        }
+        running_.store(false);
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(fd_);
+    fd_ = -1;
+}
+
+void TrafficCapture::record(std::chrono::steady_clock::time_point received,
+                            std::string_view raw_request, int status,
+                            std::size_t response_bytes,
+                            std::chrono::steady_clock::duration latency) {
+    if (!running()) {
+        return;
+    }
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() + kRecordHeaderSize + raw_request.size() > kMaxPendingBytes) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        append_le<std::uint64_t>(pending_, to_microseconds(received - started_));
+        append_le<std::uint32_t>(pending_, clamp_u32(to_microseconds(latency)));
+        append_le<std::uint32_t>(pending_, clamp_u32(response_bytes));
+        append_le<std::uint16_t>(pending_,
+                                 static_cast<std::uint16_t>(std::clamp(status, 0, 999)));
+        append_le<std::uint16_t>(pending_, 0);
+        append_le<std::uint32_t>(pending_, clamp_u32(raw_request.size()));
+        pending_.append(raw_request.data(), raw_request.size());
+        ++pending_records_;
+        wake = pending_.size() >= kFlushBytes;
+    }
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void TrafficCapture::run() {
+    std::string batch;
+    for (;;) {
+        std::uint64_t batch_records = 0;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(500), [this] {
+                return !running_.load() || pending_.size() >= kFlushBytes;
+            });
+            batch.swap(pending_);
+            batch_records = std::exchange(pending_records_, 0);
+            stopping = !running_.load();
+        }
+        if (!batch.empty() && !write_all(fd_, batch)) {
+            // Records lost to a failed write count as dropped too.
+            dropped_.fetch_add(batch_records, std::memory_order_relaxed);
+        }
+        batch.clear();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+bool CaptureReader::open(const std::string& path) {
+    file_.open(path, std::ios::binary);
+    char header[sizeof(kMagic) + 8];
+    if (!file_.read(header, sizeof(header)) ||
+        std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    start_unix_us_ = read_le<std::uint64_t>(header + sizeof(kMagic));
+    return true;
+}
+
+bool CaptureReader::next(CapturedRequest& request) {
+    char header[kRecordHeaderSize];
+    if (!file_.read(header, sizeof(header))) {
+        return false;
+    }
+    request.offset_us = read_le<std::uint64_t>(header);
+    request.latency_us = read_le<std::uint32_t>(header + 8);
+    request.response_bytes = read_le<std::uint32_t>(header + 12);
+    request.status = read_le<std::uint16_t>(header + 16);
+    const auto length = read_le<std::uint32_t>(header + 20);
+    if (length > kMaxRequestBytes) {
+        return false;
+    }
+    request.request.resize(length);
+    return static_cast<bool>(file_.read(request.request.data(), length));
+}
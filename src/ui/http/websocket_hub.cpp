@@ -0,0 +1,788 @@
+#include "ui/http/websocket_hub.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <iostream>
+#include <utility>
+
+#include "core/json_writer.h"
+#include "core/websocket_protocol.h"
+
+namespace {
+
+constexpr std::size_t kMaxMessageBytes = 64 * 1024;
+constexpr std::size_t kMaxControlPayloadBytes = 125;
+constexpr std::size_t kReadChunkBytes = 16 * 1024;
+constexpr std::chrono::seconds kPingInterval{30};
+constexpr std::chrono::seconds kIdleTimeout{75};
+// Dials waiting for the handler beyond this are answered "busy" right away.
+constexpr std::size_t kMaxPendingDials = 8;
+
+constexpr std::uint16_t kCloseNormal = 1000;
+constexpr std::uint16_t kCloseProtocolError = 1002;
+constexpr std::uint16_t kCloseTooBig = 1009;
+
+std::string lowercase(std::string_view text) {
+    std::string lowered(text);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return lowered;
+}
+
+bool header_has_token(const std::string& value, std::string_view token) {
+    return lowercase(value).find(token) != std::string::npos;
+}
+
+std::size_t skip_json_whitespace(std::string_view json, std::size_t position) {
+    while (position < json.size() && (json[position] == ' ' || json[position] == '\t' ||
+                                      json[position] == '\r' || json[position] == '\n')) {
+        ++position;
+    }
+    return position;
+}
+
+int hex_digit_value(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    return -1;
+}
+
+// Reads the four hex digits of a \uXXXX escape starting at json[position].
+bool parse_hex4(std::string_view json, std::size_t position, std::uint32_t& value) {
+    if (position + 4 > json.size()) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = position; i < position + 4; ++i) {
+        const int digit = hex_digit_value(json[i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | static_cast<std::uint32_t>(digit);
+    }
+    return true;
+}
+
+void append_utf8(std::string& out, std::uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+// Decodes the JSON string whose opening quote is at json[position] into
+// `value` (when not null) and moves `position` past the closing quote.
+// Surrogate pairs in \uXXXX escapes are combined; a lone surrogate, an unknown
+// escape or a raw control character makes the string invalid.
+bool parse_json_string(std::string_view json, std::size_t& position, std::string* value) {
+    for (++position; position < json.size(); ++position) {
+        const char ch = json[position];
+        if (ch == '"') {
+            ++position;
+            return true;
+        }
+        if (static_cast<unsigned char>(ch) < 0x20) {
+            return false;
+        }
+        if (ch != '\\') {
+            if (value != nullptr) {
+                *value += ch;
+            }
+            continue;
+        }
+        if (++position >= json.size()) {
+            return false;
+        }
+        char decoded = 0;
+        switch (json[position]) {
+            case '"': decoded = '"'; break;
+            case '\\': decoded = '\\'; break;
+            case '/': decoded = '/'; break;
+            case 'b': decoded = '\b'; break;
+            case 'f': decoded = '\f'; break;
+            case 'n': decoded = '\n'; break;
+            case 'r': decoded = '\r'; break;
+            case 't': decoded = '\t'; break;
+            case 'u': {
+                std::uint32_t code_point = 0;
+                if (!parse_hex4(json, position + 1, code_point)) {
+                    return false;
+                }
+                position += 4;
+                if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+                    return false;
+                }
+                if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+                    std::uint32_t low = 0;
+                    if (position + 2 >= json.size() || json[position + 1] != '\\' ||
+                        json[position + 2] != 'u' || !parse_hex4(json, position + 3, low) ||
+                        low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    position += 6;
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (value != nullptr) {
+                    append_utf8(*value, code_point);
+                }
+                continue;
+            }
+            default:
+                return false;
+        }
+        if (value != nullptr) {
+            *value += decoded;
+        }
+    }
+    return false;
+}
+
+// Moves `position` past the JSON value starting there. Nested objects and
+// arrays are skipped by bracket depth; their strings are still decoded so a
+// bracket inside one is not counted.
+bool skip_json_value(std::string_view json, std::size_t& position) {
+    int depth = 0;
+    do {
+        position = skip_json_whitespace(json, position);
+        if (position >= json.size()) {
+            return false;
+        }
+        const char ch = json[position];
+        if (ch == '"') {
+            if (!parse_json_string(json, position, nullptr)) {
+                return false;
+            }
+        } else if (ch == '{' || ch == '[') {
+            ++depth;
+            ++position;
+        } else if (ch == '}' || ch == ']') {
+            if (depth == 0) {
+                return false;
+            }
+            --depth;
+            ++position;
+        } else if (ch == ',' || ch == ':') {
+            if (depth == 0) {
+                return false;
+            }
+            ++position;
+        } else {
+            const std::size_t start = position;
+            while (position < json.size() && json[position] != ',' && json[position] != '}' &&
+                   json[position] != ']' && json[position] != ':' && json[position] != ' ' &&
+                   json[position] != '\t' && json[position] != '\r' && json[position] != '\n' &&
+                   json[position] != '"') {
+                ++position;
+            }
+            if (position == start) {
+                return false;
+            }
+        }
+    } while (depth > 0);
+    return true;
+}
+
+// Returns the top-level string member `name` of a JSON object, e.g. the
+// "type" of {"type":"dial","number":"123"}, with escapes decoded. Members are
+// walked pair by pair, so a key or value that merely contains `name` never
+// matches. Empty when the member is missing, not a string, or the object is
+// malformed.
+std::string json_string_member(std::string_view json, std::string_view name) {
+    std::size_t position = skip_json_whitespace(json, 0);
+    if (position >= json.size() || json[position] != '{') {
+        return {};
+    }
+    position = skip_json_whitespace(json, position + 1);
+    if (position < json.size() && json[position] == '}') {
+        return {};
+    }
+    for (;;) {
+        std::string key;
+        if (position >= json.size() || json[position] != '"' ||
+            !parse_json_string(json, position, &key)) {
+            return {};
+        }
+        position = skip_json_whitespace(json, position);
+        if (position >= json.size() || json[position] != ':') {
+            return {};
+        }
+        position = skip_json_whitespace(json, position + 1);
+        if (key == name) {
+            std::string value;
+            if (position >= json.size() || json[position] != '"' ||
+                !parse_json_string(json, position, &value)) {
+                return {};
+            }
+            return value;
+        }
+        if (!skip_json_value(json, position)) {
+            return {};
+        }
+        position = skip_json_whitespace(json, position);
+        if (position >= json.size() || json[position] != ',') {
+            return {};
+        }
+        position = skip_json_whitespace(json, position + 1);
+    }
+}
+
+std::string dial_result_message(const std::string& number, const DialResult& result) {
+    std::string reply;
+    JsonWriter json(reply, JsonStyle::kCompact);
+    json.begin_object();
+    json.key("type").string("dial-result");
+    json.key("number").string(number);
+    json.key("accepted").boolean(result.accepted);
+    json.key("message").string(result.message);
+    json.end_object();
+    json.finish();
+    return reply;
+}
+
+std::shared_ptr<const std::string> make_frame(WebSocketOpcode opcode, std::string_view payload) {
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    append_websocket_frame(frame, opcode, payload);
+    return std::make_shared<const std::string>(std::move(frame));
+}
+
+}  // namespace
+
+WebSocketHub::WebSocketHub(StatusSampler& sampler, std::size_t max_connections,
+                           std::size_t max_queued_bytes)
+    : sampler_(sampler),
+      max_connections_(max_connections),
+      max_queued_bytes_(max_queued_bytes),
+      connection_gauge_(metrics().gauge("beaver_active_connections",
+                                        "Open client connections by kind.",
+                                        {{"kind", "websocket"}})),
+      frame_cache_("websocket_frames") {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    sampler_.add_listener([this](std::uint64_t /*version*/) { wake(); });
+}
+
+WebSocketHub::~WebSocketHub() {
+    stop();
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+}
+
+void WebSocketHub::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_ || wake_fd_ < 0) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&WebSocketHub::run, this);
+    if (dial_handler_) {
+        dial_thread_ = std::thread(&WebSocketHub::run_dials, this);
+    }
+}
+
+void WebSocketHub::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake();
+    dial_ready_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (dial_thread_.joinable()) {
+        dial_thread_.join();
+    }
+    for (auto& connection : connections_) {
+        close_connection(*connection);
+    }
+    connections_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int socket : incoming_) {
+        close(socket);
+    }
+    incoming_.clear();
+    pending_dials_.clear();
+    dial_results_.clear();
+    connection_count_ = 0;
+    connection_gauge_.set(0);
+}
+
+void WebSocketHub::set_dial_handler(DialHandler handler) {
+    dial_handler_ = std::move(handler);
+}
+
+bool WebSocketHub::accept_upgrade(int client_socket, const HttpRequest& request) {
+    const std::string key = find_http_header(request, "sec-websocket-key");
+    if (request.method != "GET" || key.empty() ||
+        !header_has_token(find_http_header(request, "upgrade"), "websocket") ||
+        !header_has_token(find_http_header(request, "connection"), "upgrade") ||
+        find_http_header(request, "sec-websocket-version") != "13") {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || connection_count_ >= max_connections_) {
+            return false;
+        }
+        ++connection_count_;
+        connection_gauge_.set(static_cast<std::int64_t>(connection_count_));
+    }
+
+    const std::string response =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " + websocket_accept_key(key) + "\r\n\r\n";
+    if (send(client_socket, response.data(), response.size(), MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(response.size())) {
+        close(client_socket);
+        std::lock_guard<std::mutex> lock(mutex_);
+        --connection_count_;
+        connection_gauge_.set(static_cast<std::int64_t>(connection_count_));
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        incoming_.push_back(client_socket);
+    }
+    wake();
+    return true;
+}
+
+void WebSocketHub::wake() {
+    if (wake_fd_ >= 0) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+void WebSocketHub::run() {
+    std::vector<pollfd> descriptors;
+    auto next_ping_check = std::chrono::steady_clock::now() + kPingInterval;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+        }
+
+        descriptors.clear();
+        descriptors.push_back({wake_fd_, POLLIN, 0});
+        for (const auto& connection : connections_) {
+            short events = POLLIN;
+            if (!connection->output.empty() || connection->pending_status) {
+                events |= POLLOUT;
+            }
+            descriptors.push_back({connection->socket, events, 0});
+        }
+
+        const int ready = poll(descriptors.data(), descriptors.size(), 1000);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "WebSocket poll failed" << std::endl;
+            return;
+        }
+
+        if (descriptors[0].revents & POLLIN) {
+            std::uint64_t counter = 0;
+            [[maybe_unused]] const ssize_t drained = read(wake_fd_, &counter, sizeof(counter));
+        }
+        const std::size_t polled = descriptors.size() - 1;
+        adopt_incoming();
+        deliver_dial_results();
+        broadcast_status();
+
+        for (std::size_t i = 0; i < polled; ++i) {
+            Connection& connection = *connections_[i];
+            const short revents = descriptors[i + 1].revents;
+            if (connection.socket < 0) {
+                continue;
+            }
+            if (revents & (POLLERR | POLLNVAL)) {
+                close_connection(connection);
+                continue;
+            }
+            if (revents & (POLLIN | POLLHUP)) {
+                read_from(connection);
+            }
+            if (connection.socket >= 0 && (revents & POLLOUT)) {
+                flush(connection);
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_ping_check) {
+            next_ping_check = now + kPingInterval;
+            for (auto& connection : connections_) {
+                if (connection->socket < 0) {
+                    continue;
+                }
+                if (now - connection->last_activity >= kIdleTimeout) {
+                    close_connection(*connection);
+                } else if (now - connection->last_activity >= kPingInterval &&
+                           !connection->ping_outstanding) {
+                    static const auto ping = make_frame(WebSocketOpcode::kPing, {});
+                    connection->ping_outstanding = true;
+                    queue(*connection, ping);
+                }
+            }
+        }
+
+        const auto removed = std::remove_if(connections_.begin(), connections_.end(),
+                                            [](const auto& c) { return c->socket < 0; });
+        const std::size_t closed = static_cast<std::size_t>(connections_.end() - removed);
+        connections_.erase(removed, connections_.end());
+        if (closed > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            connection_count_ -= closed;
+            connection_gauge_.set(static_cast<std::int64_t>(connection_count_));
+        }
+    }
+}
+
+void WebSocketHub::adopt_incoming() {
+    std::vector<int> incoming;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        incoming.swap(incoming_);
+    }
+    for (int socket : incoming) {
+        auto connection = std::make_unique<Connection>();
+        connection->id = ++next_connection_id_;
+        connection->socket = socket;
+        connection->last_activity = std::chrono::steady_clock::now();
+        connections_.push_back(std::move(connection));
+    }
+}
+
+void WebSocketHub::run_dials() {
+    for (;;) {
+        PendingDial dial;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            dial_ready_.wait(lock, [this] { return !running_ || !pending_dials_.empty(); });
+            if (!running_) {
+                return;
+            }
+            dial = std::move(pending_dials_.front());
+            pending_dials_.pop_front();
+        }
+        const DialResult result = dial_handler_(dial.request);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dial_results_.emplace_back(dial.connection_id,
+                                       dial_result_message(dial.request.number, result));
+        }
+        wake();
+    }
+}
+
+void WebSocketHub::deliver_dial_results() {
+    std::vector<std::pair<std::uint64_t, std::string>> results;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results.swap(dial_results_);
+    }
+    for (const auto& [connection_id, message] : results) {
+        const auto it = std::find_if(connections_.begin(), connections_.end(),
+                                     [id = connection_id](const auto& c) { return c->id == id; });
+        if (it != connections_.end() && (*it)->socket >= 0 && !(*it)->closing) {
+            queue_text(**it, message);
+        }
+    }
+}
+
+void WebSocketHub::broadcast_status() {
+    const auto status = sampler_.latest();
+    if (!status || status->version == status_version_) {
+        return;
+    }
+    status_version_ = status->version;
+    status_delta_frame_ = status->delta_update.empty()
+                              ? nullptr
+                              : make_frame(WebSocketOpcode::kText, status->delta_update);
+    catch_up_frames_.clear();
+
+    for (auto& connection : connections_) {
+        if (connection->socket >= 0 && connection->status_subscriber) {
+            queue_status_since(*connection, connection->status_version);
+        }
+    }
+}
+
+void WebSocketHub::queue_status_since(Connection& connection, std::uint64_t version) {
+    if (status_version_ == 0 || version == status_version_) {
+        return;
+    }
+    std::shared_ptr<const std::string> frame;
+    if (status_delta_frame_ && version + 1 == status_version_) {
+        frame_cache_.record(true);
+        frame = status_delta_frame_;
+    } else {
+        auto& cached = catch_up_frames_[version];
+        frame_cache_.record(cached != nullptr);
+        if (!cached) {
+            const StatusUpdate update = sampler_.update_since(version);
+            if (update.kind == StatusUpdateKind::kUnchanged) {
+                return;
+            }
+            cached = make_frame(WebSocketOpcode::kText, update.payload);
+        }
+        frame = cached;
+    }
+    connection.pending_status = std::move(frame);
+    connection.pending_status_version = status_version_;
+    flush(connection);
+}
+
+void WebSocketHub::read_from(Connection& connection) {
+    for (;;) {
+        const std::size_t previous_size = connection.input.size();
+        connection.input.resize(previous_size + kReadChunkBytes);
+        const ssize_t received =
+            recv(connection.socket, connection.input.data() + previous_size, kReadChunkBytes,
+                 MSG_DONTWAIT);
+        if (received > 0) {
+            connection.input.resize(previous_size + static_cast<std::size_t>(received));
+            connection.last_activity = std::chrono::steady_clock::now();
+            connection.ping_outstanding = false;
+            if (static_cast<std::size_t>(received) < kReadChunkBytes) {
+                break;
+            }
+            continue;
+        }
+        connection.input.resize(previous_size);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            close_connection(connection);
+            return;
+        }
+        break;
+    }
+    process_frames(connection);
+}
+
+void WebSocketHub::process_frames(Connection& connection) {
+    std::size_t consumed = 0;
+    while (connection.socket >= 0 && !connection.closing) {
+        char* data = connection.input.data() + consumed;
+        const std::size_t available = connection.input.size() - consumed;
+        const auto header = parse_websocket_frame_header(data, available);
+        if (!header) {
+            break;
+        }
+        // Control frames (close, ping, pong) may not be fragmented and carry
+        // at most 125 bytes (RFC 6455 section 5.5).
+        const bool control = static_cast<std::uint8_t>(header->opcode) >= 0x8;
+        if (!header->masked ||
+            (control && (!header->fin || header->payload_length > kMaxControlPayloadBytes))) {
+            queue_close(connection, kCloseProtocolError);
+            break;
+        }
+        if (header->payload_length > kMaxMessageBytes) {
+            queue_close(connection, kCloseTooBig);
+            break;
+        }
+        const std::size_t payload_length = static_cast<std::size_t>(header->payload_length);
+        if (available < header->header_length + payload_length) {
+            break;
+        }
+
+        char* payload = data + header->header_length;
+        unmask_websocket_payload(payload, payload_length, header->mask);
+        const std::string_view view(payload, payload_length);
+        consumed += header->header_length + payload_length;
+
+        switch (header->opcode) {
+            case WebSocketOpcode::kText:
+            case WebSocketOpcode::kBinary:
+                // A new message may not start inside a fragmented one.
+                if (connection.fragmented) {
+                    queue_close(connection, kCloseProtocolError);
+                } else if (header->fin) {
+                    handle_message(connection, view);
+                } else {
+                    connection.fragments.assign(view);
+                    connection.fragmented = true;
+                }
+                break;
+            case WebSocketOpcode::kContinuation:
+                if (!connection.fragmented ||
+                    connection.fragments.size() + view.size() > kMaxMessageBytes) {
+                    queue_close(connection, connection.fragmented ? kCloseTooBig
+                                                                  : kCloseProtocolError);
+                    break;
+                }
+                connection.fragments.append(view);
+                if (header->fin) {
+                    connection.fragmented = false;
+                    handle_message(connection, connection.fragments);
+                    connection.fragments.clear();
+                }
+                break;
+            case WebSocketOpcode::kPing:
+                queue(connection, make_frame(WebSocketOpcode::kPong, view));
+                break;
+            case WebSocketOpcode::kPong:
+                break;
+            case WebSocketOpcode::kClose:
+                queue_close(connection, kCloseNormal);
+                break;
+            default:
+                queue_close(connection, kCloseProtocolError);
+                break;
+        }
+    }
+    if (connection.socket >= 0) {
+        connection.input.erase(0, consumed);
+    }
+}
+
+void WebSocketHub::handle_message(Connection& connection, std::string_view message) {
+    const std::string type = json_string_member(message, "type");
+    if (type == "dial") {
+        handle_dial(connection, message);
+    } else if (type == "subscribe" || type == "unsubscribe") {
+        if (json_string_member(message, "topic") != "status") {
+            queue_text(connection, "{\"type\":\"error\",\"message\":\"Unknown topic\"}");
+            return;
+        }
+        connection.status_subscriber = type == "subscribe";
+        connection.pending_status.reset();
+        if (connection.status_subscriber) {
+            connection.status_version =
+                sampler_.parse_version_token(json_string_member(message, "since"));
+            queue_status_since(connection, connection.status_version);
+        }
+    } else {
+        queue_text(connection, "{\"type\":\"error\",\"message\":\"Unknown message type\"}");
+    }
+}
+
+void WebSocketHub::handle_dial(Connection& connection, std::string_view message) {
+    DialRequest request;
+    request.number = json_string_member(message, "number");
+    request.source = json_string_member(message, "source");
+
+    DialResult result;
+    const bool valid_number =
+        !request.number.empty() &&
+        std::all_of(request.number.begin(), request.number.end(), [](unsigned char ch) {
+            return std::isdigit(ch) != 0 || ch == '+' || ch == '*' || ch == '#';
+        });
+    if (!valid_number) {
+        result.message = "Invalid number";
+    } else if (!dial_handler_) {
+        result.message = "Dialing is not available";
+    } else {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_dials_.size() < kMaxPendingDials) {
+            pending_dials_.push_back({connection.id, std::move(request)});
+            dial_ready_.notify_one();
+            return;
+        }
+        result.message = "Dialer busy";
+    }
+    queue_text(connection, dial_result_message(request.number, result));
+}
+
+void WebSocketHub::queue(Connection& connection, std::shared_ptr<const std::string> frame) {
+    connection.queued_bytes += frame->size();
+    connection.output.push_back(std::move(frame));
+    if (connection.queued_bytes > max_queued_bytes_) {
+        // The client is not reading; dropping it keeps memory bounded.
+        close_connection(connection);
+        return;
+    }
+    flush(connection);
+}
+
+void WebSocketHub::queue_text(Connection& connection, std::string_view text) {
+    queue(connection, make_frame(WebSocketOpcode::kText, text));
+}
+
+void WebSocketHub::queue_close(Connection& connection, std::uint16_t code) {
+    const char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xFF)};
+    connection.closing = true;
+    connection.pending_status.reset();
+    queue(connection, make_frame(WebSocketOpcode::kClose, std::string_view(payload, 2)));
+}
+
+void WebSocketHub::flush(Connection& connection) {
+    while (connection.socket >= 0) {
+        if (connection.output.empty()) {
+            if (!connection.pending_status) {
+                break;
+            }
+            connection.queued_bytes += connection.pending_status->size();
+            connection.output.push_back(std::move(connection.pending_status));
+            connection.pending_status.reset();
+            connection.status_version = connection.pending_status_version;
+        }
+
+        const std::string& frame = *connection.output.front();
+        const ssize_t written =
+            send(connection.socket, frame.data() + connection.output_offset,
+                 frame.size() - connection.output_offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                close_connection(connection);
+            }
+            return;
+        }
+        connection.output_offset += static_cast<std::size_t>(written);
+        if (connection.output_offset < frame.size()) {
+            return;
+        }
+        connection.queued_bytes -= frame.size();
+        connection.output_offset = 0;
+        connection.output.pop_front();
+    }
+
+    if (connection.socket >= 0 && connection.closing && connection.output.empty()) {
+        close_connection(connection);
+    }
+}
+
+void WebSocketHub::close_connection(Connection& connection) {
+    if (connection.socket >= 0) {
+        close(connection.socket);
+        connection.socket = -1;
+    }
+    connection.output.clear();
+    connection.pending_status.reset();
+    connection.queued_bytes = 0;
+}
@@ -0,0 +1,89 @@
+// AlertEngine state transitions: durations, hysteresis and metrics that stop
+// being reported.
+//
+// Usage: alert_engine_test   (exit status 1 when a check fails)
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "core/alert_engine.h"
+#include "check.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using SteadyTime = std::chrono::steady_clock::time_point;
+
+const std::chrono::system_clock::time_point kWallNow = std::chrono::system_clock::now();
+
+AlertRule rule(const char* name, const char* metric, AlertComparator comparator, double threshold,
+               std::chrono::seconds duration = 0s, double hysteresis = 0.0) {
+    AlertRule result;
+    result.name = name;
+    result.metric = metric;
+    result.comparator = comparator;
+    result.threshold = threshold;
+    result.duration = duration;
+    result.hysteresis = hysteresis;
+    return result;
+}
+
+std::string describe(const std::vector<AlertTransition>& transitions) {
+    std::string text;
+    for (const auto& transition : transitions) {
+        text += transition.name + (transition.firing ? "+" : "-");
+        if (transition.metric_missing) {
+            text += "?";
+        }
+        text += ' ';
+    }
+    return text;
+}
+
+void test_duration_and_hysteresis() {
+    std::cout << "duration and hysteresis" << std::endl;
+    AlertEngine engine({rule("hot", "load.1m", AlertComparator::kGreater, 2.0, 10s, 0.5)});
+    const SteadyTime start{};
+    check(engine.evaluate({{"load.1m", 3.0}}, start, kWallNow).empty(), "pending, not firing");
+    check(describe(engine.evaluate({{"load.1m", 3.0}}, start + 10s, kWallNow)) == "hot+ ",
+          "fires once the duration elapsed");
+    check(engine.active_alerts().size() == 1, "listed as active");
+    check(engine.evaluate({{"load.1m", 1.8}}, start + 11s, kWallNow).empty(),
+          "within hysteresis: still firing");
+    check(describe(engine.evaluate({{"load.1m", 1.5}}, start + 12s, kWallNow)) == "hot- ",
+          "resolves past the hysteresis band");
+    check(engine.active_alerts().empty(), "no active alerts");
+
+    engine.evaluate({{"load.1m", 3.0}}, start + 20s, kWallNow);
+    engine.evaluate({{"load.1m", 1.0}}, start + 25s, kWallNow);
+    check(engine.evaluate({{"load.1m", 1.0}}, start + 40s, kWallNow).empty(),
+          "pending rule cancelled when the condition stops holding");
+}
+
+void test_missing_metric() {
+    std::cout << "metric no longer reported" << std::endl;
+    AlertEngine engine({rule("battery", "battery.percent", AlertComparator::kLess, 20.0),
+                        rule("slow", "wifi.connected", AlertComparator::kEqual, 0.0, 30s)});
+    const SteadyTime start{};
+    check(describe(engine.evaluate({{"battery.percent", 10.0}, {"wifi.connected", 0.0}}, start,
+                                   kWallNow)) == "battery+ ",
+          "battery fires, wifi pending");
+
+    const auto missing = engine.evaluate({}, start + 1s, kWallNow);
+    check(describe(missing) == "battery-? " && missing[0].value == 10.0,
+          "missing metric resolves with its last value");
+    check(engine.evaluate({}, start + 60s, kWallNow).empty(),
+          "pending deadline of a missing metric is cancelled");
+    check(describe(engine.evaluate({{"battery.percent", 10.0}}, start + 61s, kWallNow)) ==
+              "battery+ ",
+          "reported again: evaluated from scratch");
+}
+
+}  // namespace
+
+int main() {
+    test_duration_and_hysteresis();
+    test_missing_metric();
+    return check_summary();
+}
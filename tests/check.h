@@ -0,0 +1,26 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// Minimal assertion helpers shared by the tests: each check prints one line,
+// and check_summary() turns the failure count into the exit status.
+
+inline int& check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void check(bool condition, const std::string& what) {
+    std::cout << (condition ? "  ok    " : "  FAIL  ") << what << std::endl;
+    if (!condition) {
+        ++check_failures();
+    }
+}
+
+inline int check_summary() {
+    const int failures = check_failures();
+    std::cout << (failures == 0 ? "All checks passed" : std::to_string(failures) + " failed")
+              << std::endl;
+    return failures == 0 ? 0 : 1;
+}
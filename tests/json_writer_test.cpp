@@ -0,0 +1,184 @@
+// JsonWriter output: string escaping, nesting, compact versus pretty layout,
+// number formatting, and the nesting checks that hold in release builds.
+//
+// Usage: json_writer_test   (exit status 1 when a check fails)
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "core/json_writer.h"
+#include "check.h"
+
+namespace {
+
+// Runs `body` on a fresh writer and returns the finished document.
+template <typename Body>
+std::string write_json(JsonStyle style, Body body) {
+    std::string out;
+    JsonWriter json(out, style);
+    body(json);
+    json.finish();
+    return out;
+}
+
+template <typename Body>
+bool throws_logic_error(Body body) {
+    try {
+        body();
+    } catch (const std::logic_error&) {
+        return true;
+    }
+    return false;
+}
+
+void test_escaping() {
+    std::cout << "string escaping" << std::endl;
+    check(json_escape("say \"hi\"") == "say \\\"hi\\\"", "double quotes");
+    check(json_escape("C:\\tmp") == "C:\\\\tmp", "backslash");
+    check(json_escape("a\nb\tc\rd") == "a\\nb\\tc\\rd", "newline, tab, carriage return");
+    check(json_escape("\b\f") == "\\b\\f", "backspace and form feed");
+    check(json_escape(std::string("\x01\x1f", 2)) == "\\u0001\\u001f",
+          "other control characters as \\u00XX");
+    check(json_escape(std::string("a\0b", 3)) == "a\\u0000b", "embedded NUL");
+    check(json_escape("café ✓ </script>") == "café ✓ </script>",
+          "UTF-8, slash and angle brackets pass through");
+    check(json_escape("") == "", "empty string");
+
+    std::string out = "prefix:";
+    append_json_string(out, "x\"y");
+    check(out == "prefix:\"x\\\"y\"", "append_json_string quotes and appends");
+
+    const std::string long_text(100, 'a');
+    check(json_escape(long_text + "\"") == long_text + "\\\"",
+          "special character after a long clean run");
+    check(write_json(JsonStyle::kCompact, [](JsonWriter& json) {
+              json.begin_object().key("k\"ey").string("v\\al").end_object();
+          }) == "{\"k\\\"ey\":\"v\\\\al\"}",
+          "keys and values are both escaped");
+}
+
+void test_compact_and_pretty() {
+    std::cout << "compact and pretty layout" << std::endl;
+    const auto document = [](JsonWriter& json) {
+        json.begin_object();
+        json.key("name").string("beaver");
+        json.key("tags").begin_array().string("a").string("b").end_array();
+        json.key("empty").begin_object().end_object();
+        json.key("none").begin_array().end_array();
+        json.key("nested").begin_object().key("ok").boolean(true).end_object();
+        json.end_object();
+    };
+    check(write_json(JsonStyle::kCompact, document) ==
+              "{\"name\":\"beaver\",\"tags\":[\"a\",\"b\"],\"empty\":{},\"none\":[],"
+              "\"nested\":{\"ok\":true}}",
+          "compact output has no whitespace and no trailing newline");
+    check(write_json(JsonStyle::kPretty, document) ==
+              "{\n"
+              "  \"name\": \"beaver\",\n"
+              "  \"tags\": [\n"
+              "    \"a\",\n"
+              "    \"b\"\n"
+              "  ],\n"
+              "  \"empty\": {},\n"
+              "  \"none\": [],\n"
+              "  \"nested\": {\n"
+              "    \"ok\": true\n"
+              "  }\n"
+              "}\n",
+          "pretty output indents by two and ends with a newline");
+    check(write_json(JsonStyle::kPretty, [](JsonWriter& json) { json.string("x"); }) == "\"x\"\n",
+          "top-level scalar");
+}
+
+void test_nesting() {
+    std::cout << "nesting" << std::endl;
+    check(write_json(JsonStyle::kCompact, [](JsonWriter& json) {
+              json.begin_array();
+              json.begin_object().key("a").begin_array().number(1).begin_array().end_array();
+              json.end_array().end_object();
+              json.begin_object().key("b").null().end_object();
+              json.end_array();
+          }) == "[{\"a\":[1,[]]},{\"b\":null}]",
+          "objects in arrays in objects");
+    check(write_json(JsonStyle::kCompact, [](JsonWriter& json) {
+              json.begin_object().key("raw").raw("{\"x\":[1,2]}").key("y").number(3);
+              json.end_object();
+          }) == "{\"raw\":{\"x\":[1,2]},\"y\":3}",
+          "raw values take a member slot");
+
+    const std::size_t deepest = JsonWriter::kMaxDepth - 1;
+    std::string expected(deepest, '[');
+    expected.append(deepest, ']');
+    check(write_json(JsonStyle::kCompact,
+                     [&](JsonWriter& json) {
+                         for (std::size_t i = 0; i < deepest; ++i) {
+                             json.begin_array();
+                         }
+                         for (std::size_t i = 0; i < deepest; ++i) {
+                             json.end_array();
+                         }
+                     }) == expected,
+          "kMaxDepth - 1 levels are accepted");
+    check(throws_logic_error([&] {
+              std::string out;
+              JsonWriter json(out, JsonStyle::kCompact);
+              for (std::size_t i = 0; i <= deepest; ++i) {
+                  json.begin_array();
+              }
+          }),
+          "one level more throws");
+    check(throws_logic_error([] {
+              std::string out;
+              JsonWriter json(out, JsonStyle::kCompact);
+              json.begin_array().end_array().end_array();
+          }),
+          "closing an unopened container throws");
+}
+
+void test_numbers() {
+    std::cout << "number formatting" << std::endl;
+    const auto compact = [](auto body) { return write_json(JsonStyle::kCompact, body); };
+    check(compact([](JsonWriter& json) {
+              json.begin_array().number(0).number(-42).number(7u).number(123456789012LL);
+              json.end_array();
+          }) == "[0,-42,7,123456789012]",
+          "integers");
+    check(compact([](JsonWriter& json) {
+              json.begin_array();
+              json.number(std::numeric_limits<long long>::min());
+              json.number(std::numeric_limits<unsigned long long>::max());
+              json.end_array();
+          }) == "[-9223372036854775808,18446744073709551615]",
+          "integer limits");
+    check(compact([](JsonWriter& json) {
+              json.begin_array().number(3.14159, 2).number(2.5, 0).number(-0.125, 3);
+              json.number(1.0, 3).number(0.1, 1).end_array();
+          }) == "[3.14,2,-0.125,1.000,0.1]",
+          "fixed-point doubles at the requested precision");
+    check(compact([](JsonWriter& json) {
+              json.begin_array().number(std::nan(""), 2);
+              json.number(std::numeric_limits<double>::infinity(), 2);
+              json.number(-std::numeric_limits<double>::infinity(), 2).end_array();
+          }) == "[null,null,null]",
+          "NaN and infinities become null");
+    check(compact([](JsonWriter& json) {
+              json.begin_array().optional_number(-1.0, 2).optional_number(0.0, 2);
+              json.optional_number(12.345, 1).end_array();
+          }) == "[null,0.00,12.3]",
+          "optional_number writes negatives as null");
+    const std::string huge = compact([](JsonWriter& json) { json.number(1e300, 2); });
+    check(huge == "1e+300", "magnitudes too wide for fixed-point use exponent form");
+}
+
+}  // namespace
+
+int main() {
+    test_escaping();
+    test_compact_and_pretty();
+    test_nesting();
+    test_numbers();
+    return check_summary();
+}
@@ -0,0 +1,137 @@
+// RouteTrie matching precedence, path normalisation, prefix remainders and the
+// patterns insert() must reject.
+//
+// Usage: router_test   (exit status 1 when a check fails)
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "core/router.h"
+#include "check.h"
+
+namespace {
+
+constexpr RouteOptions kPrefix{RouteKind::kPrefix};
+
+// Pattern of the route matching `path`, or "none".
+std::string match(const Router<int>& router, std::string_view path, RouteParams& params) {
+    const auto* route = router.match(path, params);
+    return route == nullptr ? "none" : route->pattern;
+}
+
+std::string match(const Router<int>& router, std::string_view path) {
+    RouteParams params;
+    return match(router, path, params);
+}
+
+void test_literal_over_parameter() {
+    std::cout << "literal segments win over :param" << std::endl;
+    Router<int> router;
+    router.add("/apps/:name", 0);
+    router.add("/apps/beaverphone", 1);
+    RouteParams params;
+    check(match(router, "/apps/beaverphone", params) == "/apps/beaverphone" &&
+              params.get("name").empty(),
+          "literal route, nothing captured");
+    check(match(router, "/apps/beaversystem", params) == "/apps/:name" &&
+              params.get("name") == "beaversystem",
+          "other values go to the parameter");
+    check(match(router, "/apps") == "none", "missing segment does not match");
+    check(match(router, "/apps/beaverphone/extra") == "none", "extra segment does not match");
+}
+
+void test_exact_over_prefix() {
+    std::cout << "exact wins over prefix at the same node" << std::endl;
+    Router<int> router;
+    check(router.add("/static", 0, kPrefix), "prefix route added");
+    check(router.add("/static", 1), "exact route on the same pattern added");
+    RouteParams params;
+    check(router.match("/static", params)->options.kind == RouteKind::kExact,
+          "the pattern itself is the exact route");
+    check(router.match("/static/css/a.css", params)->options.kind == RouteKind::kPrefix &&
+              params.rest() == "css/a.css",
+          "deeper paths go to the prefix route");
+}
+
+void test_deepest_prefix() {
+    std::cout << "deepest prefix and rest()" << std::endl;
+    Router<int> router;
+    router.add("/", 0, kPrefix);
+    router.add("/api", 1, kPrefix);
+    router.add("/api/v1", 2, kPrefix);
+    router.add("/u/:id/raw", 3, kPrefix);
+    router.add("/u/:id/x/:y", 4);
+    RouteParams params;
+    check(match(router, "/api/v1/users/7", params) == "/api/v1" && params.rest() == "users/7",
+          "deepest prefix, rest without leading '/'");
+    check(match(router, "/api/v2", params) == "/api" && params.rest() == "v2",
+          "falls back to the shorter prefix");
+    check(match(router, "/api", params) == "/api" && params.rest().empty(),
+          "prefix route matches its own path with an empty rest");
+    check(match(router, "/elsewhere/deep", params) == "/" && params.rest() == "elsewhere/deep",
+          "root prefix catches everything else");
+    check(match(router, "/u/5/raw/a/b", params) == "/u/:id/raw" && params.get("id") == "5" &&
+              params.rest() == "a/b",
+          "parameters before the prefix are kept");
+    check(match(router, "/u/5/x", params) == "/" && params.get("id").empty() &&
+              params.rest() == "u/5/x",
+          "parameters captured past the matching prefix are dropped");
+    check(match(router, "/u/5/x/9", params) == "/u/:id/x/:y" && params.get("id") == "5" &&
+              params.get("y") == "9",
+          "exact route with two parameters");
+}
+
+void test_empty_segments() {
+    std::cout << "empty and trailing segments" << std::endl;
+    Router<int> router;
+    router.add("/", 0);
+    router.add("/apps/beaverphone", 1);
+    router.add("/static", 2, kPrefix);
+    RouteParams params;
+    check(match(router, "") == "/" && match(router, "/") == "/" && match(router, "//") == "/",
+          "empty path and bare slashes are the root");
+    check(match(router, "//apps///beaverphone/") == "/apps/beaverphone",
+          "repeated and trailing slashes are ignored");
+    check(match(router, "/static//css/a.css", params) == "/static" &&
+              params.rest() == "css/a.css",
+          "slashes before the rest are skipped");
+    check(match(router, "/static/css/", params) == "/static" && params.rest() == "css/",
+          "a trailing slash stays in the rest");
+    check(router.add("apps//beaverphone/", 3) == false,
+          "a pattern differing only in slashes is the same route");
+}
+
+void test_rejected_patterns() {
+    std::cout << "rejected patterns" << std::endl;
+    Router<int> router;
+    check(router.add("/m/:a/:b/:c/:d", 0), "kMaxParams parameters accepted");
+    check(!router.add("/n/:a/:b/:c/:d/:e", 1), "one parameter more is rejected");
+    check(router.add("/n/:other", 2), "the rejected pattern left no parameter node behind");
+    check(match(router, "/n/1/2/3/4/5") == "none", "and cannot match");
+
+    check(router.add("/users/:id", 3), "parameter route added");
+    check(!router.add("/users/:name/posts", 4), "another name at the same position is rejected");
+    check(router.add("/users/:id/posts", 5), "the same name extends the route");
+    check(!router.add("/p/:a/:a", 6), "a name repeated within a pattern is rejected");
+    check(!router.add("/q/:", 7), "an empty parameter name is rejected");
+    check(!router.add("/users/:id", 8), "a duplicate exact route is rejected");
+    check(router.add("/users/:id", 9, kPrefix), "a prefix route on the same pattern is not");
+    check(router.routes().size() == 5, "rejected routes are not added to the table");
+
+    RouteParams params;
+    check(match(router, "/users/42/posts", params) == "/users/:id/posts" &&
+              params.get("id") == "42",
+          "existing routes still match");
+}
+
+}  // namespace
+
+int main() {
+    test_literal_over_parameter();
+    test_exact_over_prefix();
+    test_deepest_prefix();
+    test_empty_segments();
+    test_rejected_patterns();
+    return check_summary();
+}
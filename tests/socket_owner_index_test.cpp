@@ -0,0 +1,83 @@
+// SocketOwnerIndex against a synthetic /proc tree under the temp directory.
+//
+// Usage: socket_owner_index_test   (exit status 1 when a check fails)
+
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+#include "core/socket_owner_index.h"
+#include "check.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void set_fd(const fs::path& root, int pid, int fd, const std::string& target) {
+    const fs::path link = root / std::to_string(pid) / "fd" / std::to_string(fd);
+    fs::create_directories(link.parent_path());
+    fs::remove(link);
+    fs::create_symlink(target, link);
+}
+
+fs::path make_root() {
+    const fs::path root =
+        fs::temp_directory_path() / ("socket_owner_index_test." + std::to_string(getpid()));
+    fs::remove_all(root);
+    return root;
+}
+
+void test_resolves_owners() {
+    std::cout << "owners" << std::endl;
+    const fs::path root = make_root();
+    set_fd(root, 100, 3, "socket:[111]");
+    set_fd(root, 100, 4, "/dev/null");
+    set_fd(root, 200, 3, "socket:[111]");
+    set_fd(root, 200, 5, "socket:[222]");
+    SocketOwnerIndex index(root.string());
+    const auto owners = index.resolve({111, 222, 333});
+    check(owners.count(111) == 1 && owners.at(111).pid == 100, "shared socket: lowest pid");
+    check(owners.count(222) == 1 && owners.at(222).pid == 200, "socket of one process");
+    check(owners.count(333) == 0, "unknown inode stays unresolved");
+
+    fs::remove_all(root / "100");
+    const auto after_exit = index.resolve({111});
+    check(after_exit.count(111) == 1 && after_exit.at(111).pid == 200,
+          "exited process is forgotten");
+    fs::remove_all(root);
+}
+
+// A process that swaps one descriptor for a socket keeps its descriptor count,
+// so only the fallback rescan finds it. That rescan is not repeated for the
+// same unresolved set (an unreadable owner would otherwise force one on every
+// call) until the interval passes.
+void test_fallback_rescan() {
+    std::cout << "fallback rescan of unchanged processes" << std::endl;
+    for (const int interval : {60, 0}) {
+        const fs::path root = make_root();
+        set_fd(root, 100, 3, "socket:[111]");
+        SocketOwnerIndex index(root.string(), std::chrono::seconds(interval));
+        index.resolve({111});
+        index.resolve({999, 222});
+        set_fd(root, 100, 3, "socket:[222]");
+        const auto same_set = index.resolve({999, 222});
+        if (interval == 0) {
+            check(same_set.count(222) == 1, "interval elapsed: unchanged processes rescanned");
+        } else {
+            check(same_set.count(222) == 0, "same unresolved set: no rescan within the interval");
+            const auto new_set = index.resolve({999, 222, 333});
+            check(new_set.count(222) == 1, "unresolved set changed: rescanned");
+        }
+        fs::remove_all(root);
+    }
+}
+
+}  // namespace
+
+int main() {
+    test_resolves_owners();
+    test_fallback_rescan();
+    return check_summary();
+}
@@ -0,0 +1,270 @@
+// Differential test of the HTML/JSON escaping kernels. The kernel is chosen
+// once per process from BEAVER_ESCAPE_KERNEL, so the test runs itself once per
+// kernel (scalar, sse2, avx2) and compares what each one produced for the same
+// inputs with the scalar output. The inputs put every special character at the
+// edges of the 16- and 32-byte lanes, in strings of lengths around 16 and 32,
+// and add seeded random strings, including high and control bytes, read from
+// unaligned offsets.
+//
+// Usage: text_escape_test   (exit status 1 when a check fails)
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/text_escape.h"
+#include "check.h"
+
+extern char** environ;
+
+namespace {
+
+struct Input {
+    std::string description;
+    std::string text;
+};
+
+std::string describe_byte(unsigned char ch) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    return std::string("0x") + kHex[ch >> 4] + kHex[ch & 0x0f];
+}
+
+// Identical in every process: the generator is seeded with a constant.
+std::vector<Input> make_inputs() {
+    std::vector<Input> inputs;
+    const std::string specials = std::string("&<>\"'\\\n\t\x1f\x7f\x80\xff", 12) + '\0';
+    const std::size_t lengths[] = {0, 1, 15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65};
+    for (const std::size_t length : lengths) {
+        inputs.push_back({"clean length " + std::to_string(length), std::string(length, 'a')});
+        if (length == 0) {
+            continue;
+        }
+        // Both edges of the first two 16-byte lanes, and the last byte.
+        std::vector<std::size_t> positions = {0, 14, 15, 16, 17, 30, 31, 32, 33, length - 1};
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+        for (const char special : specials) {
+            for (const std::size_t position : positions) {
+                if (position >= length) {
+                    continue;
+                }
+                std::string text(length, 'a');
+                text[position] = special;
+                inputs.push_back({describe_byte(static_cast<unsigned char>(special)) + " at " +
+                                      std::to_string(position) + " of " + std::to_string(length),
+                                  std::move(text)});
+            }
+        }
+        std::string all(length, '"');
+        inputs.push_back({"all quotes, length " + std::to_string(length), std::move(all)});
+    }
+
+    std::mt19937 generator(20240601u);
+    std::uniform_int_distribution<int> length_distribution(0, 130);
+    std::uniform_int_distribution<int> byte_distribution(0, 255);
+    std::uniform_int_distribution<int> kind_distribution(0, 9);
+    std::uniform_int_distribution<int> special_distribution(
+        0, static_cast<int>(specials.size()) - 1);
+    for (int i = 0; i < 3000; ++i) {
+        const std::size_t length = static_cast<std::size_t>(length_distribution(generator));
+        const std::size_t offset = static_cast<std::size_t>(i % 4);
+        std::string buffer(offset, 'x');
+        for (std::size_t j = 0; j < length; ++j) {
+            const int kind = kind_distribution(generator);
+            if (kind == 0) {
+                buffer += specials[static_cast<std::size_t>(special_distribution(generator))];
+            } else if (kind == 1) {
+                buffer += static_cast<char>(byte_distribution(generator));
+            } else {
+                buffer += static_cast<char>('a' + j % 26);
+            }
+        }
+        inputs.push_back({"random #" + std::to_string(i) + " (length " +
+                              std::to_string(length) + ", offset " + std::to_string(offset) + ")",
+                          buffer.substr(offset)});
+    }
+    return inputs;
+}
+
+// Child mode: escapes every input with this process's kernel and writes the
+// kernel name, then each HTML and JSON result, length-prefixed, to stdout.
+int dump_escaped() {
+    std::string out = text_escape_kernel_name();
+    out += '\n';
+    for (const Input& input : make_inputs()) {
+        std::string html;
+        append_html_escaped(html, input.text);
+        std::string json;
+        append_json_escaped(json, input.text);
+        for (const std::string* escaped : {&html, &json}) {
+            out += std::to_string(escaped->size());
+            out += '\n';
+            out += *escaped;
+        }
+    }
+    std::size_t written = 0;
+    while (written < out.size()) {
+        const ssize_t n = write(STDOUT_FILENO, out.data() + written, out.size() - written);
+        if (n <= 0 && errno != EINTR) {
+            return 1;
+        }
+        written += n > 0 ? static_cast<std::size_t>(n) : 0;
+    }
+    return 0;
+}
+
+struct KernelOutput {
+    bool ok = false;
+    std::string kernel;
+    std::vector<std::string> escaped;  // HTML then JSON for each input.
+};
+
+KernelOutput run_kernel(const char* kernel) {
+    KernelOutput result;
+    int pipe_fds[2];
+    if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        return result;
+    }
+    setenv("BEAVER_ESCAPE_KERNEL", kernel, 1);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDOUT_FILENO);
+    char* argv[] = {const_cast<char*>("text_escape_test"), const_cast<char*>("--dump"), nullptr};
+    pid_t pid = 0;
+    const int spawn_error =
+        posix_spawn(&pid, "/proc/self/exe", &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    unsetenv("BEAVER_ESCAPE_KERNEL");
+    close(pipe_fds[1]);
+    if (spawn_error != 0) {
+        close(pipe_fds[0]);
+        return result;
+    }
+
+    std::string data;
+    char chunk[65536];
+    for (;;) {
+        const ssize_t n = read(pipe_fds[0], chunk, sizeof(chunk));
+        if (n > 0) {
+            data.append(chunk, static_cast<std::size_t>(n));
+        } else if (n == 0 || errno != EINTR) {
+            break;
+        }
+    }
+    close(pipe_fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return result;
+    }
+
+    std::size_t position = data.find('\n');
+    if (position == std::string::npos) {
+        return result;
+    }
+    result.kernel = data.substr(0, position);
+    ++position;
+    while (position < data.size()) {
+        const std::size_t newline = data.find('\n', position);
+        if (newline == std::string::npos) {
+            return result;
+        }
+        const std::size_t length = std::strtoull(data.c_str() + position, nullptr, 10);
+        if (newline + 1 + length > data.size()) {
+            return result;
+        }
+        result.escaped.push_back(data.substr(newline + 1, length));
+        position = newline + 1 + length;
+    }
+    result.ok = true;
+    return result;
+}
+
+std::string printable(std::string_view text) {
+    std::string out;
+    for (const char ch : text) {
+        const auto byte = static_cast<unsigned char>(ch);
+        out += byte >= 0x20 && byte < 0x7f ? std::string(1, ch) : "\\" + describe_byte(byte);
+    }
+    return out;
+}
+
+void compare_with_scalar(const KernelOutput& scalar, const char* kernel,
+                         const std::vector<Input>& inputs) {
+    std::cout << kernel << " kernel" << std::endl;
+    const KernelOutput output = run_kernel(kernel);
+    if (!output.ok) {
+        check(false, std::string(kernel) + " run produced its output");
+        return;
+    }
+    if (output.kernel != kernel) {
+        std::cout << "  skip  this CPU has no " << kernel << " (got " << output.kernel << ")"
+                  << std::endl;
+        return;
+    }
+    check(output.escaped.size() == scalar.escaped.size(), "one result per input");
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < output.escaped.size() && i < scalar.escaped.size(); ++i) {
+        if (output.escaped[i] == scalar.escaped[i]) {
+            continue;
+        }
+        if (++mismatches <= 5) {
+            const Input& input = inputs[i / 2];
+            std::cout << "  " << (i % 2 == 0 ? "HTML" : "JSON") << " differs for "
+                      << input.description << ": \"" << printable(input.text) << "\"\n    "
+                      << kernel << ": \"" << printable(output.escaped[i]) << "\"\n    scalar: \""
+                      << printable(scalar.escaped[i]) << "\"" << std::endl;
+        }
+    }
+    check(mismatches == 0, std::to_string(inputs.size()) + " inputs escape as with scalar");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && std::strcmp(argv[1], "--dump") == 0) {
+        return dump_escaped();
+    }
+
+    const std::vector<Input> inputs = make_inputs();
+    std::cout << "scalar kernel" << std::endl;
+    const KernelOutput scalar = run_kernel("scalar");
+    check(scalar.ok && scalar.kernel == "scalar", "scalar run produced its output");
+    check(scalar.escaped.size() == inputs.size() * 2, "one HTML and one JSON result per input");
+    if (!scalar.ok || scalar.escaped.size() != inputs.size() * 2) {
+        return check_summary();
+    }
+    const auto scalar_result = [&](std::string_view description, bool json) {
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            if (inputs[i].description == description) {
+                return scalar.escaped[i * 2 + (json ? 1 : 0)];
+            }
+        }
+        return std::string("(no such input)");
+    };
+    check(scalar_result("clean length 16", false) == std::string(16, 'a'),
+          "scalar leaves clean text alone");
+    check(scalar_result("0x26 at 15 of 16", false) == std::string(15, 'a') + "&amp;" &&
+              scalar_result("0x27 at 0 of 1", false) == "&#39;",
+          "scalar HTML escapes");
+    check(scalar_result("0x00 at 31 of 32", true) == std::string(31, 'a') + "\\u0000" &&
+              scalar_result("0x5c at 0 of 1", true) == "\\\\" &&
+              scalar_result("0x80 at 0 of 1", true) == "\x80",
+          "scalar JSON escapes, high bytes untouched");
+
+    compare_with_scalar(scalar, "sse2", inputs);
+    compare_with_scalar(scalar, "avx2", inputs);
+    return check_summary();
+}
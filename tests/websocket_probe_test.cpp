@@ -0,0 +1,304 @@
+// WebSocket probe tests against a local stand-in server: a loopback listener
+// that completes the RFC 6455 handshake, optionally greets with a text frame,
+// and answers pings with pongs.
+//
+// Usage: websocket_probe_test   (exit status 1 when a check fails)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "core/websocket_probe.h"
+#include "core/websocket_protocol.h"
+#include "check.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct StandInOptions {
+    bool corrupt_accept_key = false;
+    std::string greeting;  // Sent as a text frame right after the handshake.
+};
+
+// Serves one connection at a time on 127.0.0.1:`port` (0 picks a free port).
+class StandInServer {
+public:
+    explicit StandInServer(StandInOptions options, std::uint16_t port = 0)
+        : options_(std::move(options)) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const int reuse = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd_, 8) != 0) {
+            std::cerr << "stand-in server: cannot listen on port " << port << std::endl;
+            close(listen_fd_);
+            listen_fd_ = -1;
+            return;
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+        port_ = ntohs(address.sin_port);
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~StandInServer() {
+        stopping_ = true;
+        if (listen_fd_ >= 0) {
+            shutdown(listen_fd_, SHUT_RDWR);
+            close(listen_fd_);
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    std::uint16_t port() const { return port_; }
+    std::string address() const { return "ws://127.0.0.1:" + std::to_string(port_) + "/"; }
+
+private:
+    void serve() {
+        while (!stopping_) {
+            const int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                return;
+            }
+            handle(client);
+            close(client);
+        }
+    }
+
+    static bool read_more(int fd, std::string& buffer) {
+        char chunk[2048];
+        const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+        return true;
+    }
+
+    void handle(int fd) {
+        std::string buffer;
+        std::size_t header_end = std::string::npos;
+        while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!read_more(fd, buffer)) {
+                return;
+            }
+        }
+        const std::string_view request(buffer.data(), header_end);
+        const std::string_view key_header = "Sec-WebSocket-Key: ";
+        const std::size_t key_start = request.find(key_header) + key_header.size();
+        const std::size_t key_end = request.find("\r\n", key_start);
+        const std::string key(request.substr(key_start, key_end - key_start));
+        std::string accept = websocket_accept_key(key);
+        if (options_.corrupt_accept_key) {
+            accept[0] = accept[0] == 'A' ? 'B' : 'A';
+        }
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                               "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                               "Sec-WebSocket-Accept: " + accept + "\r\n\r\n";
+        if (!options_.greeting.empty()) {
+            append_websocket_frame(response, WebSocketOpcode::kText, options_.greeting);
+        }
+        send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+        buffer.erase(0, header_end + 4);
+
+        for (;;) {
+            const auto header = parse_websocket_frame_header(buffer.data(), buffer.size());
+            if (!header || buffer.size() < header->header_length + header->payload_length) {
+                if (!read_more(fd, buffer)) {
+                    return;
+                }
+                continue;
+            }
+            char* payload = buffer.data() + header->header_length;
+            const std::size_t payload_length = static_cast<std::size_t>(header->payload_length);
+            if (header->masked) {
+                unmask_websocket_payload(payload, payload_length, header->mask);
+            }
+            std::string reply;
+            if (header->opcode == WebSocketOpcode::kPing) {
+                append_websocket_frame(reply, WebSocketOpcode::kPong,
+                                       std::string_view(payload, payload_length));
+            } else if (header->opcode == WebSocketOpcode::kClose) {
+                append_websocket_frame(reply, WebSocketOpcode::kClose,
+                                       std::string_view(payload, payload_length));
+                send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+                return;
+            }
+            send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+            buffer.erase(0, header->header_length + payload_length);
+        }
+    }
+
+    StandInOptions options_;
+    int listen_fd_ = -1;
+    std::uint16_t port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
+
+WebSocketEndpoint loopback_endpoint(std::uint16_t port) {
+    WebSocketEndpoint endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = port;
+    return endpoint;
+}
+
+// Calls update() until `done` holds or two seconds pass.
+template <typename Predicate>
+WebSocketStatus poll_probe(WebSocketProbe& probe, const std::string& address, Predicate done) {
+    WebSocketStatus status;
+    const auto deadline = Clock::now() + std::chrono::seconds(2);
+    do {
+        probe.update(address, status);
+        if (done(status)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } while (Clock::now() < deadline);
+    return status;
+}
+
+void test_accept_key() {
+    std::cout << "handshake accept key" << std::endl;
+    // RFC 6455 section 1.3.
+    check(websocket_accept_key("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=",
+          "RFC 6455 sample key");
+
+    StandInServer good({});
+    const WebSocketProbeResult ok =
+        probe_websocket_endpoint(loopback_endpoint(good.port()), std::chrono::seconds(1));
+    check(ok.connected && ok.handshake_ok && ok.pong_received && ok.error.empty(),
+          "handshake and ping/pong against the stand-in");
+    check(ok.connect_ms >= 0.0 && ok.round_trip_ms >= 0.0, "connect and round-trip timed");
+
+    StandInOptions corrupt;
+    corrupt.corrupt_accept_key = true;
+    StandInServer bad(corrupt);
+    const WebSocketProbeResult rejected =
+        probe_websocket_endpoint(loopback_endpoint(bad.port()), std::chrono::seconds(1));
+    check(rejected.connected && !rejected.handshake_ok &&
+              rejected.error == "Invalid Sec-WebSocket-Accept",
+          "wrong Sec-WebSocket-Accept is rejected");
+}
+
+void test_round_trip_percentiles() {
+    std::cout << "round-trip percentiles" << std::endl;
+    WebSocketProbeHistory history(100);
+    const auto now = Clock::now();
+    for (int i = 100; i >= 1; --i) {
+        WebSocketProbeResult result;
+        result.handshake_ok = true;
+        result.connect_ms = 1.0;
+        result.round_trip_ms = i;
+        history.record(result, now);
+    }
+    WebSocketStatus status;
+    history.fill(status, now);
+    check(status.round_trip_latency.samples == 100, "100 samples kept");
+    check(status.round_trip_latency.p50_ms == 50.0, "p50 is 50 ms");
+    check(status.round_trip_latency.p90_ms == 90.0, "p90 is 90 ms");
+    check(status.round_trip_latency.p99_ms == 99.0, "p99 is 99 ms");
+
+    WebSocketProbeHistory small(4);
+    for (int i = 1; i <= 10; ++i) {
+        WebSocketProbeResult result;
+        result.round_trip_ms = i;
+        small.record(result, now);
+    }
+    small.fill(status, now);
+    check(status.round_trip_latency.samples == 4 && status.round_trip_latency.p99_ms == 10.0 &&
+              status.round_trip_latency.p50_ms == 8.0,
+          "history keeps only the most recent samples");
+}
+
+void test_last_message() {
+    std::cout << "last message" << std::endl;
+    StandInOptions greeting;
+    greeting.greeting = "call-state: idle";
+    StandInServer server(greeting);
+    const WebSocketProbeResult result =
+        probe_websocket_endpoint(loopback_endpoint(server.port()), std::chrono::seconds(1));
+    check(result.pong_received && result.message == "call-state: idle",
+          "text frame before the pong is reported");
+
+    WebSocketProbeHistory history;
+    const auto now = Clock::now();
+    history.record(result, now);
+    WebSocketProbeResult quiet;
+    quiet.handshake_ok = true;
+    history.record(quiet, now);
+    WebSocketStatus status;
+    history.fill(status, now);
+    check(status.last_message == "call-state: idle", "kept across a probe without messages");
+}
+
+void test_uptime_across_restart() {
+    std::cout << "uptime across a server restart" << std::endl;
+    WebSocketProbe probe(16, std::chrono::milliseconds(20), std::chrono::milliseconds(200));
+    std::uint16_t port = 0;
+    std::string address;
+    double uptime_before_restart = -1.0;
+    {
+        StandInServer server({});
+        port = server.port();
+        address = server.address();
+        WebSocketStatus status =
+            poll_probe(probe, address, [](const WebSocketStatus& s) { return s.reachable; });
+        check(status.reachable && status.uptime_seconds >= 0.0, "reachable once probed");
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        status = poll_probe(probe, address,
+                            [](const WebSocketStatus& s) { return s.uptime_seconds >= 0.1; });
+        uptime_before_restart = status.uptime_seconds;
+        check(uptime_before_restart >= 0.1, "uptime grows while reachable");
+    }
+
+    WebSocketStatus status =
+        poll_probe(probe, address, [](const WebSocketStatus& s) { return !s.reachable; });
+    check(!status.reachable && status.uptime_seconds < 0.0 && status.probe_failures > 0,
+          "server down: unreachable, uptime reset");
+
+    StandInServer restarted({}, port);
+    status = poll_probe(probe, address, [](const WebSocketStatus& s) { return s.reachable; });
+    check(status.reachable && status.uptime_seconds >= 0.0 &&
+              status.uptime_seconds < uptime_before_restart,
+          "restarted: uptime counts from the restart");
+}
+
+void test_update_does_not_block() {
+    std::cout << "update() never waits on the network" << std::endl;
+    // 192.0.2.0/24 is TEST-NET-1; connects to it hang until the timeout.
+    WebSocketProbe probe(16, std::chrono::milliseconds(20), std::chrono::seconds(2));
+    WebSocketStatus status;
+    probe.update("ws://192.0.2.1:5001/", status);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto start = Clock::now();
+    probe.update("ws://192.0.2.1:5001/", status);
+    const auto elapsed = Clock::now() - start;
+    check(elapsed < std::chrono::milliseconds(50), "update() returns while a probe is in flight");
+}
+
+}  // namespace
+
+int main() {
+    test_accept_key();
+    test_round_trip_percentiles();
+    test_last_message();
+    test_uptime_across_restart();
+    test_update_does_not_block();
+    return check_summary();
+}
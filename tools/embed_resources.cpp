@@ -0,0 +1,121 @@
+// Writes the C++ source behind kEmbeddedResources (core/resource_bundle.h):
+// every FILE as a string literal, its gzip copy from GZIP_DIR/FILE.gz (made
+// by `gzip -9 -n` in the Makefile) when that is smaller, and its content hash.
+// Entries are sorted by path so find_resource() can binary search them.
+//
+// Usage: embed_resources OUTPUT GZIP_DIR FILE...
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "core/content_hash.h"
+
+namespace {
+
+struct Entry {
+    std::string path;
+    std::string data;
+    std::string gzip;
+};
+
+bool read_file(const std::filesystem::path& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// Every byte as \xHH, 32 to a line. A hex escape would swallow a following
+// hex digit, so nothing is ever emitted verbatim.
+void write_literal(std::ostream& out, const std::string& bytes) {
+    if (bytes.empty()) {
+        out << "\"\"";
+        return;
+    }
+    char escaped[8];
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        if (i % 32 == 0) {
+            out << (i == 0 ? "\"" : "\"\n    \"");
+        }
+        std::snprintf(escaped, sizeof(escaped), "\\x%02x",
+                      static_cast<unsigned char>(bytes[i]));
+        out << escaped;
+    }
+    out << '"';
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: embed_resources OUTPUT GZIP_DIR FILE..." << std::endl;
+        return 2;
+    }
+    const std::filesystem::path gzip_directory = argv[2];
+
+    std::vector<Entry> entries;
+    for (int i = 3; i < argc; ++i) {
+        Entry entry;
+        entry.path = argv[i];
+        if (!read_file(entry.path, entry.data)) {
+            std::cerr << "embed_resources: cannot read " << entry.path << std::endl;
+            return 1;
+        }
+        std::string gzip;
+        if (read_file(gzip_directory / (entry.path + ".gz"), gzip) &&
+            gzip.size() < entry.data.size()) {
+            entry.gzip = std::move(gzip);
+        }
+        entries.push_back(std::move(entry));
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& left, const Entry& right) { return left.path < right.path; });
+
+    std::ofstream out(argv[1], std::ios::binary | std::ios::trunc);
+    out << "// Generated by tools/embed_resources. Do not edit.\n\n"
+        << "#include \"core/resource_bundle.h\"\n\n"
+        << "namespace {\n\n";
+    std::size_t data_bytes = 0;
+    std::size_t gzip_bytes = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        out << "// " << entries[i].path << "\n"
+            << "constexpr char kData" << i << "[] =\n    ";
+        write_literal(out, entries[i].data);
+        out << ";\n"
+            << "constexpr char kGzip" << i << "[] =\n    ";
+        write_literal(out, entries[i].gzip);
+        out << ";\n\n";
+        data_bytes += entries[i].data.size();
+        gzip_bytes += entries[i].gzip.size();
+    }
+    out << "}  // namespace\n\n"
+        << "extern const Resource kEmbeddedResources[] = {\n";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        out << "    {\"" << entry.path << "\", {kData" << i << ", " << entry.data.size()
+            << "}, {kGzip" << i << ", " << entry.gzip.size() << "}, \""
+            << content_hash(entry.data) << "\"},\n";
+    }
+    if (entries.empty()) {
+        out << "    {},\n";
+    }
+    out << "};\n\n"
+        << "extern const std::size_t kEmbeddedResourceCount = " << entries.size() << ";\n";
+    out.close();
+    if (!out) {
+        std::cerr << "embed_resources: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Embedded " << entries.size() << " resources, " << data_bytes << " bytes ("
+              << gzip_bytes << " more gzipped)" << std::endl;
+    return 0;
+}